@@ -0,0 +1,207 @@
+#include "EAD_ApproxDistance.hxx"
+
+#include <cfloat>
+
+#include "EAD_CpuDispatch.hxx"
+#include "EAD_PathSoA.hxx"
+#include "EAD_Stats.hxx"
+
+#if defined(EAD_SIMD_AVX2)
+#include <immintrin.h>
+#endif
+
+const char* distanceAccuracyName(DistanceAccuracy accuracy) {
+    switch (accuracy) {
+    case kDistanceExact:
+        return "exact";
+    case kDistanceSquared:
+        return "squared";
+    case kDistanceRsqrt:
+        return "rsqrt";
+    case kDistanceLevel:
+        return "level";
+    }
+    return "unknown";
+}
+
+// Scalar kernels
+// -------------------------------------------------------------
+// Same math as approxDistance(), one leg at a time, with the mode
+// hoisted out of the loop.
+// -------------------------------------------------------------
+template <typename T>
+static void squaredLengthsScalar(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        double dx = double(x[i + 1]) - double(x[i]);
+        double dy = double(y[i + 1]) - double(y[i]);
+        double dz = double(z[i + 1]) - double(z[i]);
+        out[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+template <typename T>
+static void rsqrtLengthsScalar(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        double dx = double(x[i + 1]) - double(x[i]);
+        double dy = double(y[i + 1]) - double(y[i]);
+        double dz = double(z[i + 1]) - double(z[i]);
+        double s = dx * dx + dy * dy + dz * dz;
+        out[i] = s * fastInverseSqrt(s);
+    }
+}
+
+template <typename T>
+static void levelLengthsScalar(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+    const double slope2 = kLevelSlope * kLevelSlope;
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        double dx = double(x[i + 1]) - double(x[i]);
+        double dy = double(y[i + 1]) - double(y[i]);
+        double dz = double(z[i + 1]) - double(z[i]);
+        double h2 = dx * dx + dy * dy;
+        double dz2 = dz * dz;
+        // level = 1 on near-level legs; an arithmetic select, so the
+        // loop vectorizes (with -fno-trapping-math, see CMakeLists.txt)
+        double level = static_cast<double>(dz2 <= slope2 * h2);
+        double t = h2 + (1.0 - level) * dz2;
+        double numerator = h2 + (1.0 - 0.5 * level) * dz2;
+        out[i] = numerator * fastInverseSqrt(t);
+    }
+}
+
+#if defined(EAD_SIMD_AVX2)
+
+// AVX2 kernels: 4 legs per iteration
+// -------------------------------------------------------------
+//   y0 = rsqrtps(float(s))            ~12 bits
+//   y  = y0 (1.5 - 0.5 s y0^2)        one Newton step in double
+//   length = s * y, masked to 0 where s is not a normal float
+// AVX-512 hosts run these too (see EAD_CpuDispatch.hxx).
+// -------------------------------------------------------------
+EAD_TARGET_AVX2 static inline __m256d load4(const double* p) { return _mm256_loadu_pd(p); }
+EAD_TARGET_AVX2 static inline __m256d load4(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+
+EAD_TARGET_AVX2 static inline __m256d inverseSqrt4(__m256d s) {
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d threeHalves = _mm256_set1_pd(1.5);
+    __m256d y = _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(s)));
+    __m256d syy = _mm256_mul_pd(_mm256_mul_pd(s, y), y);
+    return _mm256_mul_pd(y, _mm256_sub_pd(threeHalves, _mm256_mul_pd(half, syy)));
+}
+
+// Lanes whose s rounds to a normal float
+EAD_TARGET_AVX2 static inline __m256d inRange4(__m256d s) {
+    __m256d low = _mm256_cmp_pd(s, _mm256_set1_pd(FLT_MIN), _CMP_GE_OQ);
+    __m256d high = _mm256_cmp_pd(s, _mm256_set1_pd(FLT_MAX), _CMP_LE_OQ);
+    return _mm256_and_pd(low, high);
+}
+
+template <typename T, DistanceAccuracy Mode>
+EAD_TARGET_AVX2 static inline __m256d lengths4(const T* x, const T* y, const T* z, std::size_t i) {
+    __m256d dx = _mm256_sub_pd(load4(x + i + 1), load4(x + i));
+    __m256d dy = _mm256_sub_pd(load4(y + i + 1), load4(y + i));
+    __m256d dz = _mm256_sub_pd(load4(z + i + 1), load4(z + i));
+    __m256d h2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+    __m256d dz2 = _mm256_mul_pd(dz, dz);
+    __m256d s = _mm256_add_pd(h2, dz2);
+    if (Mode == kDistanceSquared) {
+        return s;
+    }
+    __m256d t = s;
+    __m256d numerator = s;
+    if (Mode == kDistanceLevel) {
+        __m256d slope2 = _mm256_set1_pd(kLevelSlope * kLevelSlope);
+        __m256d level = _mm256_cmp_pd(dz2, _mm256_mul_pd(slope2, h2), _CMP_LE_OQ);
+        t = _mm256_blendv_pd(s, h2, level);
+        numerator = _mm256_blendv_pd(s, _mm256_add_pd(h2, _mm256_mul_pd(_mm256_set1_pd(0.5), dz2)), level);
+    }
+    return _mm256_and_pd(_mm256_mul_pd(numerator, inverseSqrt4(t)), inRange4(t));
+}
+
+template <DistanceAccuracy Mode, typename T>
+EAD_TARGET_AVX2 static void approxLengthsAvx2(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+    if (n < 2) {
+        return;
+    }
+    std::size_t segments = n - 1;
+    std::size_t i = 0;
+    for (; i + 4 <= segments; i += 4) {
+        _mm256_storeu_pd(out + i, lengths4<T, Mode>(x, y, z, i));
+    }
+    // Tail legs: the scalar estimate is tighter, so the bound still holds
+    if (Mode == kDistanceSquared) {
+        squaredLengthsScalar(x + i, y + i, z + i, n - i, out + i);
+    } else if (Mode == kDistanceRsqrt) {
+        rsqrtLengthsScalar(x + i, y + i, z + i, n - i, out + i);
+    } else {
+        levelLengthsScalar(x + i, y + i, z + i, n - i, out + i);
+    }
+}
+
+#endif
+
+template <DistanceAccuracy Mode, typename T>
+static void approxLengths(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+#if defined(EAD_SIMD_AVX2)
+    if (simdLevel() >= kSimdAvx2) {
+        approxLengthsAvx2<Mode>(x, y, z, n, out);
+        return;
+    }
+#endif
+    if (Mode == kDistanceSquared) {
+        squaredLengthsScalar(x, y, z, n, out);
+    } else if (Mode == kDistanceRsqrt) {
+        rsqrtLengthsScalar(x, y, z, n, out);
+    } else {
+        levelLengthsScalar(x, y, z, n, out);
+    }
+}
+
+template <typename T>
+static void segmentLengthsImpl(const T* x, const T* y, const T* z, std::size_t n, double* out,
+                               DistanceAccuracy accuracy) {
+    switch (accuracy) {
+    case kDistanceExact:
+        segmentLengths(x, y, z, n, out);
+        break;
+    case kDistanceSquared:
+        approxLengths<kDistanceSquared>(x, y, z, n, out);
+        break;
+    case kDistanceRsqrt:
+        approxLengths<kDistanceRsqrt>(x, y, z, n, out);
+        break;
+    case kDistanceLevel:
+        approxLengths<kDistanceLevel>(x, y, z, n, out);
+        break;
+    }
+}
+
+void segmentLengths(const double* x, const double* y, const double* z, std::size_t n, double* out,
+                    DistanceAccuracy accuracy) {
+    segmentLengthsImpl(x, y, z, n, out, accuracy);
+}
+
+void segmentLengths(const float* x, const float* y, const float* z, std::size_t n, double* out,
+                    DistanceAccuracy accuracy) {
+    segmentLengthsImpl(x, y, z, n, out, accuracy);
+}
+
+double totalPathLength(const double* x, const double* y, const double* z, std::size_t n,
+                       DistanceAccuracy accuracy) {
+    if (accuracy == kDistanceExact || accuracy == kDistanceSquared) {
+        return totalPathLength(x, y, z, n);
+    }
+    EAD_STATS_TIMER("path_length_approx");
+    EAD_STATS_COUNT("path_length_waypoints", n);
+    const std::size_t kBlock = 1024;
+    double lengths[kBlock];
+    double total = 0.0;
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    for (std::size_t begin = 0; begin < segments; begin += kBlock) {
+        std::size_t count = segments - begin < kBlock ? segments - begin : kBlock;
+        segmentLengthsImpl(x + begin, y + begin, z + begin, count + 1, lengths, accuracy);
+        for (std::size_t k = 0; k < count; ++k) {
+            total += lengths[k];
+        }
+    }
+    return total;
+}
@@ -0,0 +1,124 @@
+#ifndef EAD_APPROX_DISTANCE_HXX
+#define EAD_APPROX_DISTANCE_HXX
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "EAD_Core.hxx"
+
+// Approximate Distance Kernels
+// =========================================================
+// distance() and segmentLengths() are exact to the last ulp.
+// Pre-screening, heuristics and sweeps can trade accuracy for
+// throughput, per call site (the overloads below) or per evaluator
+// (SegmentEnergyParams::distanceAccuracy):
+//
+//   mode              leg value              relative error
+//   ----------------  ---------------------  ------------------------
+//   kDistanceExact    sqrt(s)                correctly rounded
+//   kDistanceSquared  s                      none; comparisons only
+//   kDistanceRsqrt    s * rsqrt(s)           <= 5e-6
+//   kDistanceLevel    (h2 + dz^2 / 2)        <= 2e-5 on legs with
+//                     * rsqrt(h2)            |dz| <= 0.1 horizontal,
+//                                            else as kDistanceRsqrt
+//
+//   s = dx^2 + dy^2 + dz^2,   h2 = dx^2 + dy^2
+//
+// rsqrt estimate, per kernel
+// -------------------------------------------------------------
+//   scalar  magic-constant bit estimate (< 3.5e-2), two Newton steps
+//           y' = y (1.5 - 0.5 s y^2)  -->  < 4.7e-6
+//   avx2    vrsqrtps on s rounded to float (< 3.7e-4), one Newton
+//           step in double  -->  < 2.1e-7. s must fit a normal
+//           float: lengths outside 1e-19 .. 1.8e19 m come out as 0.
+//
+// Level legs
+// -------------------------------------------------------------
+// sqrt(h2 + dz^2) = h sqrt(1 + r),  r = dz^2 / h2. The first-order
+// term h (1 + r / 2) is off by at most h r^2 / 8, 1.25e-5 relative at
+// the 0.1 slope limit, and needs no sqrt of its own: 1 / h is the
+// same rsqrt. Steeper legs fall back to the 3D estimate in the same
+// pass (a per-lane select, no branch), so every leg stays within the
+// table's bound.
+//
+// Throughput
+// -------------------------------------------------------------
+// On an AVX2 desktop core with a cache-resident route, squared runs
+// ~2.7x and rsqrt ~1.3x the exact kernel; level only matches exact
+// (the select costs what the sqrt saves), so it pays off only where
+// sqrt is slow. Past the caches every mode is bound by loading x, y, z.
+// ead_bench's BM_SegmentLengthsAccuracy and
+// BM_EvaluateSegmentTotalsAccuracy report speed and measured error
+// for the current machine.
+//
+// Totals and evaluators need lengths, so they treat kDistanceSquared
+// as kDistanceExact. NEON builds use the scalar approximate kernels.
+// =========================================================
+
+enum DistanceAccuracy { kDistanceExact, kDistanceSquared, kDistanceRsqrt, kDistanceLevel };
+
+// Slope |dz| / horizontal up to which kDistanceLevel uses the
+// first-order formula
+static const double kLevelSlope = 0.1;
+
+// Scalar estimate of 1 / sqrt(s) (see above); s == 0 gives a large
+// finite value, so s * fastInverseSqrt(s) == 0
+inline double fastInverseSqrt(double s) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &s, sizeof(bits));
+    bits = 0x5fe6eb50c7b537a9ull - (bits >> 1);
+    double y;
+    std::memcpy(&y, &bits, sizeof(y));
+    y = y * (1.5 - 0.5 * s * y * y);
+    y = y * (1.5 - 0.5 * s * y * y);
+    return y;
+}
+
+// One leg in the given mode (scalar reference for the batched kernels)
+inline double approxDistance(const Waypoint& wp1, const Waypoint& wp2, DistanceAccuracy accuracy) {
+    double dx = wp2.x - wp1.x;
+    double dy = wp2.y - wp1.y;
+    double dz = wp2.z - wp1.z;
+    double h2 = dx * dx + dy * dy;
+    double s = h2 + dz * dz;
+    switch (accuracy) {
+    case kDistanceSquared:
+        return s;
+    case kDistanceRsqrt:
+        return s * fastInverseSqrt(s);
+    case kDistanceLevel:
+        if (dz * dz <= kLevelSlope * kLevelSlope * h2) {
+            return (h2 + 0.5 * dz * dz) * fastInverseSqrt(h2);
+        }
+        return s * fastInverseSqrt(s);
+    case kDistanceExact:
+        break;
+    }
+    return std::sqrt(s);
+}
+
+// Mode for code that needs real lengths (evaluators, totals)
+inline DistanceAccuracy lengthAccuracy(DistanceAccuracy accuracy) {
+    return accuracy == kDistanceSquared ? kDistanceExact : accuracy;
+}
+
+// Short name for labels and logs ("exact", "squared", "rsqrt", "level")
+const char* distanceAccuracyName(DistanceAccuracy accuracy);
+
+// Batched lengths in the given mode
+// -------------------------------------------------------------
+// Same contract as segmentLengths() in EAD_PathSoA.hxx (out has room
+// for n - 1 values); kDistanceExact calls it directly.
+// -------------------------------------------------------------
+void segmentLengths(const double* x, const double* y, const double* z, std::size_t n, double* out,
+                    DistanceAccuracy accuracy);
+void segmentLengths(const float* x, const float* y, const float* z, std::size_t n, double* out,
+                    DistanceAccuracy accuracy);
+
+// Sum of the approximate lengths (kDistanceSquared: exact lengths)
+double totalPathLength(const double* x, const double* y, const double* z, std::size_t n,
+                       DistanceAccuracy accuracy);
+
+#endif // EAD_APPROX_DISTANCE_HXX
@@ -0,0 +1,82 @@
+#include "EAD_Arena.hxx"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+// Process-wide counterpart of ArenaResource::upstreamAllocations_
+static std::atomic<std::size_t> allUpstreamAllocations(0);
+
+ArenaResource::ArenaResource(std::size_t initialBytes)
+    : current_(0), offset_(0), finishedBytes_(0), upstreamAllocations_(0) {
+    addBlock(initialBytes > 0 ? initialBytes : 1);
+}
+
+ArenaResource::~ArenaResource() {
+    for (const Block& block : blocks_) {
+        ::operator delete(block.data);
+    }
+}
+
+std::size_t ArenaResource::capacity() const {
+    std::size_t total = 0;
+    for (const Block& block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+std::size_t ArenaResource::totalUpstreamAllocations() {
+    return allUpstreamAllocations.load(std::memory_order_relaxed);
+}
+
+void ArenaResource::addBlock(std::size_t size) {
+    Block block = {static_cast<unsigned char*>(::operator new(size)), size};
+    blocks_.push_back(block);
+    ++upstreamAllocations_;
+    allUpstreamAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ArenaResource::reset() {
+    if (current_ > 0) {
+        // The last run spilled over: merge into one block that holds it all
+        std::size_t total = capacity();
+        for (const Block& block : blocks_) {
+            ::operator delete(block.data);
+        }
+        blocks_.clear();
+        addBlock(total);
+    }
+    current_ = 0;
+    offset_ = 0;
+    finishedBytes_ = 0;
+}
+
+void* ArenaResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    for (;;) {
+        Block& block = blocks_[current_];
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data);
+        std::uintptr_t aligned = (base + offset_ + alignment - 1) & ~std::uintptr_t(alignment - 1);
+        std::size_t end = static_cast<std::size_t>(aligned - base) + bytes;
+        if (end <= block.size) {
+            offset_ = end;
+            return reinterpret_cast<void*>(aligned);
+        }
+        // Move on to the next retained block, or grow geometrically
+        finishedBytes_ += offset_;
+        offset_ = 0;
+        ++current_;
+        if (current_ == blocks_.size()) {
+            std::size_t size = 2 * block.size;
+            if (size < bytes + alignment) {
+                size = bytes + alignment;
+            }
+            addBlock(size);
+        }
+    }
+}
+
+ArenaResource& threadArena() {
+    static thread_local ArenaResource arena;
+    return arena;
+}
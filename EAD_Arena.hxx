@@ -0,0 +1,75 @@
+#ifndef EAD_ARENA_HXX
+#define EAD_ARENA_HXX
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Per-Worker Scratch Arena
+// =========================================================
+// A monotonic bump allocator exposed as a std::pmr::memory_resource,
+// for scratch data that lives exactly as long as one mission:
+//
+//   block 0 [##########......]   allocate(): bump 'offset' in the
+//   block 1 [####............]   current block, move on to the next
+//                 ^ offset       retained block when it is full
+//
+// deallocate() is a no-op; reset() rewinds to the start of block 0 and
+// keeps every block. If a mission spilled into more than one block, the
+// blocks are merged into one block of the combined size at reset, so
+// the next mission of that size fits in a single run. After the first
+// few missions a worker reaches its high-water mark and stops calling
+// the upstream allocator altogether; upstreamAllocations() counts the
+// calls so callers can check that.
+//
+// Containers draw from it through std::pmr:
+//
+//   std::pmr::vector<double> x(&arena);
+//
+// Not thread-safe: one arena per thread (threadArena()).
+// =========================================================
+class ArenaResource : public std::pmr::memory_resource {
+public:
+    explicit ArenaResource(std::size_t initialBytes = 64 * 1024);
+    ~ArenaResource() override;
+
+    ArenaResource(const ArenaResource&) = delete;
+    ArenaResource& operator=(const ArenaResource&) = delete;
+
+    // Release everything allocated since the last reset; keeps the memory
+    void reset();
+
+    std::size_t bytesInUse() const { return finishedBytes_ + offset_; }
+    std::size_t capacity() const;
+
+    // Blocks obtained from operator new over this arena's lifetime
+    std::size_t upstreamAllocations() const { return upstreamAllocations_; }
+
+    // Sum of upstreamAllocations() over every arena in the process
+    static std::size_t totalUpstreamAllocations();
+
+private:
+    struct Block {
+        unsigned char* data;
+        std::size_t size;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    void addBlock(std::size_t size);
+
+    std::vector<Block> blocks_;
+    std::size_t current_;       // Block being bumped
+    std::size_t offset_;        // Bytes used in blocks_[current_]
+    std::size_t finishedBytes_; // Bytes used in the blocks before it
+    std::size_t upstreamAllocations_;
+};
+
+// The calling thread's arena, created on first use and kept for the
+// thread's lifetime. Whoever starts a unit of work owns it (runBatch
+// resets it before each mission), so helpers must not reset it.
+ArenaResource& threadArena();
+
+#endif // EAD_ARENA_HXX
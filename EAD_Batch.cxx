@@ -0,0 +1,266 @@
+#include "EAD_Batch.hxx"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+#include "EAD_PathSoA.hxx"
+#include "EAD_ResultWriter.hxx"
+#include "EAD_RouteCache.hxx"
+#include "EAD_SegmentEnergy.hxx"
+#include "EAD_Stats.hxx"
+#include "EAD_ThreadPool.hxx"
+
+namespace {
+
+bool isSpace(char ch) { return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n'; }
+
+const char* skipSpaces(const char* p) {
+    while (*p && isSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// One in-flight mission in the submission window
+struct Slot {
+    Mission mission;
+    MissionResult result;
+    std::string error;
+    bool failed;
+    bool done;
+    WaypointSoA path;             // Only with segment output; keeps its
+    SegmentEnergyProfile profile; // capacity like the mission buffers
+};
+
+// Per-leg lengths and energies for segment output (same params as the
+// mission totals)
+void evaluateMissionSegments(Slot& slot, const MissionResult& result, const BatchOptions& options) {
+    slot.path.clear();
+    slot.path.reserve(slot.mission.waypoints.size());
+    for (const Waypoint& wp : slot.mission.waypoints) {
+        slot.path.push_back(wp);
+    }
+    SegmentEnergyParams params = {slot.mission.coeffs, result.optimalVelocity, options.climbCoefficient,
+                                  options.descentCoefficient};
+    evaluateSegments(slot.path, params, slot.profile);
+}
+
+// What every mission task needs; tasks capture only this and their
+// slot, two pointers, which std::function stores without allocating
+struct WindowState {
+    const BatchOptions* options;
+    bool segments;
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+
+// The submission window shared by both runBatch() overloads: parse on
+// the caller, evaluate on the pool, emit(slot) in submission order
+template <class Emit>
+std::size_t runBatchWindow(std::istream& in, const BatchOptions& options, bool segments, Emit emit) {
+    std::unique_ptr<ThreadPool> ownPool;
+    if (options.threads != 0) {
+        ownPool.reset(new ThreadPool(options.threads));
+    }
+    ThreadPool& pool = ownPool ? *ownPool : defaultThreadPool();
+
+    const size_t window = options.window ? options.window : 1;
+    std::vector<Slot> slots(window);
+    WindowState state;
+    state.options = &options;
+    state.segments = segments;
+    size_t submitted = 0;
+    size_t written = 0;
+    size_t failures = 0;
+
+    // Write the oldest mission, waiting for it if it is still running
+    auto writeNext = [&]() {
+        Slot& slot = slots[written % window];
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.finished.wait(lock, [&slot] { return slot.done; });
+        }
+        if (slot.failed) {
+            ++failures;
+        }
+        emit(slot);
+        ++written;
+    };
+    auto oldestDone = [&]() {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return slots[written % window].done;
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        const char* first = skipSpaces(line.c_str());
+        if (!*first || *first == '#') {
+            continue;
+        }
+        if (submitted - written == window) {
+            writeNext();
+        }
+
+        Slot& slot = slots[submitted % window];
+        slot.done = false;
+        slot.failed = !parseMissionLine(line, slot.mission, slot.error);
+        if (slot.failed) {
+            slot.done = true;
+        } else {
+            WindowState* shared = &state;
+            Slot* task = &slot;
+            pool.submit([shared, task] {
+                ArenaResource& scratch = threadArena();
+                scratch.reset();
+                MissionResult result = evaluateMission(task->mission, *shared->options, scratch);
+                if (shared->segments) {
+                    evaluateMissionSegments(*task, result, *shared->options);
+                }
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                task->result = result;
+                task->done = true;
+                shared->finished.notify_all();
+            });
+        }
+        ++submitted;
+
+        // Stream out whatever has already finished, in order
+        while (written < submitted && oldestDone()) {
+            writeNext();
+        }
+    }
+    while (written < submitted) {
+        writeNext();
+    }
+    return failures;
+}
+
+} // namespace
+
+bool parseMissionLine(const std::string& line, Mission& mission, std::string& error) {
+    EAD_STATS_TIMER("batch_parse");
+    const char* p = skipSpaces(line.c_str());
+    const char* idEnd = p;
+    while (*idEnd && !isSpace(*idEnd)) {
+        ++idEnd;
+    }
+    mission.id.assign(p, idEnd);
+    mission.waypoints.clear();
+    if (mission.id.empty()) {
+        error = "missing mission id";
+        return false;
+    }
+
+    // Coefficients a, b, c followed by x y z triples, parsed in place
+    double values[3];
+    p = idEnd;
+    for (int k = 0; k < 3; ++k) {
+        char* end = nullptr;
+        values[k] = std::strtod(p, &end);
+        if (end == p) {
+            error = "expected coefficients a b c";
+            return false;
+        }
+        p = end;
+    }
+    mission.coeffs.a = values[0];
+    mission.coeffs.b = values[1];
+    mission.coeffs.c = values[2];
+
+    for (;;) {
+        p = skipSpaces(p);
+        if (!*p) {
+            break;
+        }
+        Waypoint wp;
+        double* coords[3] = {&wp.x, &wp.y, &wp.z};
+        for (int k = 0; k < 3; ++k) {
+            char* end = nullptr;
+            *coords[k] = std::strtod(p, &end);
+            if (end == p) {
+                error = "waypoint " + std::to_string(mission.waypoints.size()) + " is not an x y z triple";
+                return false;
+            }
+            p = end;
+        }
+        mission.waypoints.push_back(wp);
+    }
+    if (mission.waypoints.empty()) {
+        error = "mission has no waypoints";
+        return false;
+    }
+    return true;
+}
+
+MissionResult evaluateMission(const Mission& mission, const BatchOptions& options) {
+    ArenaResource scratch(3 * mission.waypoints.size() * sizeof(double) + 64);
+    return evaluateMission(mission, options, scratch);
+}
+
+MissionResult evaluateMission(const Mission& mission, const BatchOptions& options, ArenaResource& scratch) {
+    EAD_STATS_TIMER("batch_mission");
+    double optimalVelocity, optimalAltitude;
+    std::tie(optimalVelocity, optimalAltitude) = findOptimalSpeedAndAltitude(mission.coeffs.a, mission.coeffs.b);
+
+    SegmentEnergyParams params = {mission.coeffs, optimalVelocity,
+                                  options.climbCoefficient, options.descentCoefficient};
+
+    // SoA planes for the batched kernels; the streaming totals give the
+    // same sums as a full SegmentEnergyProfile without per-leg storage
+    size_t n = mission.waypoints.size();
+    std::pmr::vector<double> x(n, &scratch), y(n, &scratch), z(n, &scratch);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = mission.waypoints[i].x;
+        y[i] = mission.waypoints[i].y;
+        z[i] = mission.waypoints[i].z;
+    }
+    SegmentEnergyTotals totals;
+    if (options.cache) {
+        std::shared_ptr<const CachedRoute> cached = options.cache->evaluate(x.data(), y.data(), z.data(), n, params);
+        totals.distance = cached->profile.totalDistance();
+        totals.energy = cached->profile.totalEnergy();
+    } else {
+        totals = evaluateSegmentTotals(x.data(), y.data(), z.data(), n, params);
+    }
+
+    MissionResult result;
+    result.totalDistance = totals.distance;
+    result.optimalVelocity = optimalVelocity;
+    result.totalEnergy = totals.energy;
+    return result;
+}
+
+std::size_t runBatch(std::istream& in, std::ostream& out, const BatchOptions& options) {
+    std::streamsize oldPrecision = out.precision(10);
+    std::size_t failures = runBatchWindow(in, options, false, [&out](const Slot& slot) {
+        if (slot.failed) {
+            out << slot.mission.id << " error " << slot.error << '\n';
+        } else {
+            out << slot.mission.id << ' ' << slot.result.totalDistance << ' ' << slot.result.optimalVelocity << ' '
+                << slot.result.totalEnergy << '\n';
+        }
+    });
+    out.flush();
+    out.precision(oldPrecision);
+    return failures;
+}
+
+std::size_t runBatch(std::istream& in, ResultWriter& writer, const BatchOptions& options) {
+    bool segments = writer.options().segments;
+    return runBatchWindow(in, options, segments, [&writer, segments](const Slot& slot) {
+        if (slot.failed) {
+            writer.writeError(slot.mission.id, slot.error);
+            return;
+        }
+        writer.writeMission(slot.mission.id, slot.result);
+        if (segments) {
+            for (std::size_t leg = 0; leg < slot.profile.segmentCount(); ++leg) {
+                writer.writeSegment(slot.mission.id, leg, slot.profile.length[leg], slot.profile.energy[leg]);
+            }
+        }
+    });
+}
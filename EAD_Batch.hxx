@@ -0,0 +1,102 @@
+#ifndef EAD_BATCH_HXX
+#define EAD_BATCH_HXX
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "EAD_Arena.hxx"
+#include "EAD_Core.hxx"
+
+class ResultWriter;
+class RouteCache;
+
+// Fleet Batch Mode
+// =========================================================
+// Evaluates many missions in one process. Input is plain text, one
+// mission per line:
+//
+//   <id> <a> <b> <c> <x1> <y1> <z1> <x2> <y2> <z2> ...
+//
+// Blank lines and lines starting with '#' are skipped. Output is one
+// line per mission, in submission order:
+//
+//   <id> <total_distance> <optimal_velocity> <total_energy>
+//   <id> error <message>                      (malformed input line)
+//
+// or the same records as CSV, JSON Lines or binary, optionally with
+// per-leg records, through a ResultWriter (EAD_ResultWriter.hxx).
+//
+//   reader (caller) --> [ window of in-flight missions ] --> writer (caller)
+//                              |    |    |
+//                           thread pool workers
+//
+// The caller parses and submits missions to the pool and writes the
+// oldest result as soon as it is done, so at most 'window' missions
+// are held in memory no matter how long the input is.
+//
+// Memory
+// -------------------------------------------------------------
+// Slots are recycled within a run, so a mission's id, waypoints and
+// segment output keep their capacity for the next mission in the same
+// slot (the first 'window' missions of a run allocate them). These
+// stay ordinary heap buffers rather than arena ones: the caller parses
+// into them and writes from them, after the worker's arena has moved
+// on to its next mission. Workers build the SoA route in their
+// threadArena(), which is reset before each mission and stops taking
+// blocks from the heap once every worker has seen its largest mission.
+// Tasks capture two pointers, so std::function stores them in place,
+// and the pool's ring buffers keep their capacity.
+//
+// Once the window is full the mission loop therefore makes no heap
+// allocations; ead_bench's BM_RunBatch checks that by counting every
+// operator new (steady_allocs, per mission) next to the arena blocks
+// (arena_allocs). A RouteCache and a ResultWriter's blocks have their
+// own buffers.
+// =========================================================
+
+struct Mission {
+    std::string id;
+    EnergyCoefficients coeffs;
+    std::vector<Waypoint> waypoints;
+};
+
+struct MissionResult {
+    double totalDistance;
+    double optimalVelocity;
+    double totalEnergy;
+};
+
+struct BatchOptions {
+    unsigned threads;          // 0 = defaultThreadPool()
+    std::size_t window;        // Maximum missions in flight
+    double climbCoefficient;   // Per-segment model climb term
+    double descentCoefficient; // Per-segment model descent term
+    RouteCache* cache;         // Memoized profiles (EAD_RouteCache.hxx); nullptr = none
+
+    BatchOptions() : threads(0), window(4096), climbCoefficient(0.5), descentCoefficient(0.0), cache(nullptr) {}
+};
+
+// Parse one input line; returns false (and sets 'error') if malformed
+bool parseMissionLine(const std::string& line, Mission& mission, std::string& error);
+
+// Same evaluation as the single-mission simulator: optimal velocity
+// from findOptimalSpeedAndAltitude(), then the per-segment model
+MissionResult evaluateMission(const Mission& mission, const BatchOptions& options);
+
+// Same, with the route's SoA copy allocated from 'scratch'; the caller
+// resets the arena between missions. With options.cache set, totals
+// come from the cache (identical results; repeated routes and shared
+// prefixes are not re-evaluated).
+MissionResult evaluateMission(const Mission& mission, const BatchOptions& options, ArenaResource& scratch);
+
+// Run a whole batch; returns the number of missions that failed to parse
+std::size_t runBatch(std::istream& in, std::ostream& out, const BatchOptions& options);
+
+// Same, with records going to a ResultWriter (EAD_ResultWriter.hxx) in
+// its format, plus per-leg records if writer.options().segments; the
+// caller close()s the writer
+std::size_t runBatch(std::istream& in, ResultWriter& writer, const BatchOptions& options);
+
+#endif // EAD_BATCH_HXX
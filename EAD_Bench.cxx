@@ -0,0 +1,1017 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "EAD_ApproxDistance.hxx"
+#include "EAD_Arena.hxx"
+#include "EAD_Batch.hxx"
+#include "EAD_Core.hxx"
+#include "EAD_EditableRoute.hxx"
+#include "EAD_EnergyBatch.hxx"
+#include "EAD_EnergyModel.hxx"
+#include "EAD_Feasibility.hxx"
+#include "EAD_FleetSim.hxx"
+#include "EAD_GridPlanner.hxx"
+#include "EAD_MonteCarlo.hxx"
+#include "EAD_ParallelReduce.hxx"
+#include "EAD_Pareto.hxx"
+#include "EAD_PathSoA.hxx"
+#include "EAD_ResultWriter.hxx"
+#include "EAD_RouteBatch.hxx"
+#include "EAD_RouteCache.hxx"
+#include "EAD_Scheduler.hxx"
+#include "EAD_Precision.hxx"
+#include "EAD_SegmentEnergy.hxx"
+#include "EAD_SpatialIndex.hxx"
+#include "EAD_SpeedAltitudeOptimizer.hxx"
+#include "EAD_Sweep.hxx"
+#include "EAD_ThreadPool.hxx"
+#include "EAD_WindField.hxx"
+
+// Throughput Benchmarks (ead_bench)
+// =========================================================
+// One benchmark per hot function, swept over 10 .. 10M waypoints:
+//
+//   items/s  = waypoints (or samples, missions) processed per second
+//   bytes/s  = input bytes streamed per second (3 doubles per waypoint)
+//
+// Machine-readable output for dashboards:
+//
+//   ead_bench --benchmark_out=ead_bench.json --benchmark_out_format=json
+//
+// or "cmake --build <dir> --target ead_bench_json". Build with
+// CMAKE_BUILD_TYPE=Release (and EAD_NATIVE_ARCH=ON for the SIMD path);
+// the JSON context records the build type and the kernel names.
+// =========================================================
+
+// Every operator new in the process (array and nothrow forms go
+// through this one), for the batch allocation counters
+static std::atomic<std::size_t> heapAllocations(0);
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+const double kA = 0.1;
+const double kB = 0.05;
+const double kC = 10.0;
+
+// Random walk with 1-10 m steps, the shape of a real survey route
+std::vector<Waypoint> makeRoute(std::size_t n) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> step(-10.0, 10.0);
+    std::vector<Waypoint> route(n);
+    Waypoint p = {0.0, 0.0, 100.0};
+    for (std::size_t i = 0; i < n; ++i) {
+        p.x += step(rng);
+        p.y += step(rng);
+        p.z = std::max(10.0, p.z + 0.1 * step(rng));
+        route[i] = p;
+    }
+    return route;
+}
+
+// Routes are expensive to build at 10M, so each size is made once
+const std::vector<Waypoint>& cachedRoute(std::size_t n) {
+    static std::vector<std::vector<Waypoint>> routes;
+    for (const std::vector<Waypoint>& route : routes) {
+        if (route.size() == n) {
+            return route;
+        }
+    }
+    routes.push_back(makeRoute(n));
+    return routes.back();
+}
+
+const WaypointSoA& cachedRouteSoA(std::size_t n) {
+    static std::vector<WaypointSoA> routes;
+    for (const WaypointSoA& route : routes) {
+        if (route.size() == n) {
+            return route;
+        }
+    }
+    routes.push_back(toSoA(cachedRoute(n)));
+    return routes.back();
+}
+
+SegmentEnergyParams demoParams() {
+    SegmentEnergyParams params;
+    params.coeffs.a = kA;
+    params.coeffs.b = kB;
+    params.coeffs.c = kC;
+    params.velocity = std::get<0>(findOptimalSpeedAndAltitude(kA, kB));
+    params.climbCoefficient = 0.5;
+    params.descentCoefficient = 0.0;
+    return params;
+}
+
+void setWaypointCounters(benchmark::State& state, std::size_t n) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n * 3 * sizeof(double)));
+}
+
+void waypointSizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(10, 10000000);
+}
+
+// ---------------------------------------------------------------
+// distance() and the original main() path-length loop
+// ---------------------------------------------------------------
+
+void BM_Distance(benchmark::State& state) {
+    const std::vector<Waypoint>& route = cachedRoute(2);
+    Waypoint a = route[0];
+    Waypoint b = route[1];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        benchmark::DoNotOptimize(distance(a, b));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Distance);
+
+void BM_PathLengthLoop(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::vector<Waypoint>& waypoints = cachedRoute(n);
+    for (auto _ : state) {
+        double totalDistance = 0.0;
+        for (size_t i = 1; i < waypoints.size(); ++i) {
+            totalDistance += distance(waypoints[i - 1], waypoints[i]);
+        }
+        benchmark::DoNotOptimize(totalDistance);
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_PathLengthLoop)->Apply(waypointSizes);
+
+void BM_PathLengthSoAScalar(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(totalPathLengthScalar(path.x.data(), path.y.data(), path.z.data(), n));
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_PathLengthSoAScalar)->Apply(waypointSizes);
+
+void BM_PathLengthSoA(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(totalPathLength(path));
+    }
+    setWaypointCounters(state, n);
+    state.SetLabel(pathKernelName());
+}
+BENCHMARK(BM_PathLengthSoA)->Apply(waypointSizes);
+
+void BM_PathLengthSoAFloat(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    std::vector<float> x(path.x.begin(), path.x.end());
+    std::vector<float> y(path.y.begin(), path.y.end());
+    std::vector<float> z(path.z.begin(), path.z.end());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(totalPathLength(x.data(), y.data(), z.data(), n));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n * 3 * sizeof(float)));
+    state.SetLabel(pathKernelName());
+}
+BENCHMARK(BM_PathLengthSoAFloat)->Apply(waypointSizes);
+
+// Chunked over the thread pool; shows where the fork/join cost pays off
+// (serialThreshold = 0 forces the pool even for tiny routes)
+void BM_PathLengthParallel(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    ParallelReduceOptions options;
+    options.serialThreshold = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(totalPathLengthParallel(path, options));
+    }
+    setWaypointCounters(state, n);
+    state.counters["threads"] = static_cast<double>(defaultThreadPool().threadCount());
+}
+BENCHMARK(BM_PathLengthParallel)->Apply(waypointSizes)->UseRealTime();
+
+// ---------------------------------------------------------------
+// Distance accuracy modes (EAD_ApproxDistance.hxx)
+// ---------------------------------------------------------------
+
+// Label: worst relative error of any leg against segmentLengths()
+// (kDistanceSquared is compared against the squared exact lengths)
+template <DistanceAccuracy Accuracy>
+void BM_SegmentLengthsAccuracy(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    std::vector<double> lengths(n - 1);
+    for (auto _ : state) {
+        segmentLengths(path.x.data(), path.y.data(), path.z.data(), n, lengths.data(), Accuracy);
+        benchmark::DoNotOptimize(lengths.data());
+    }
+    std::vector<double> exact = segmentLengths(path);
+    double worst = 0.0;
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        double reference = Accuracy == kDistanceSquared ? exact[i] * exact[i] : exact[i];
+        if (reference > 0.0) {
+            worst = std::max(worst, std::fabs(lengths[i] - reference) / reference);
+        }
+    }
+    char label[64];
+    std::snprintf(label, sizeof(label), "%s %s max_rel_err=%.2e", pathKernelName(), distanceAccuracyName(Accuracy),
+                  worst);
+    state.SetLabel(label);
+    setWaypointCounters(state, n);
+}
+BENCHMARK_TEMPLATE(BM_SegmentLengthsAccuracy, kDistanceExact)->Apply(waypointSizes);
+BENCHMARK_TEMPLATE(BM_SegmentLengthsAccuracy, kDistanceSquared)->Apply(waypointSizes);
+BENCHMARK_TEMPLATE(BM_SegmentLengthsAccuracy, kDistanceRsqrt)->Apply(waypointSizes);
+BENCHMARK_TEMPLATE(BM_SegmentLengthsAccuracy, kDistanceLevel)->Apply(waypointSizes);
+
+// Per-evaluator selection; label: relative energy error of the route
+template <DistanceAccuracy Accuracy>
+void BM_EvaluateSegmentTotalsAccuracy(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    SegmentEnergyParams params = demoParams();
+    params.distanceAccuracy = Accuracy;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluateSegmentTotals(path.x.data(), path.y.data(), path.z.data(), n, params));
+    }
+    double energy = evaluateSegmentTotals(path.x.data(), path.y.data(), path.z.data(), n, params).energy;
+    double reference = evaluateSegmentTotals(path.x.data(), path.y.data(), path.z.data(), n, demoParams()).energy;
+    char label[64];
+    std::snprintf(label, sizeof(label), "%s rel_err=%.2e", distanceAccuracyName(Accuracy), energy / reference - 1.0);
+    state.SetLabel(label);
+    setWaypointCounters(state, n);
+}
+BENCHMARK_TEMPLATE(BM_EvaluateSegmentTotalsAccuracy, kDistanceExact)->Apply(waypointSizes);
+BENCHMARK_TEMPLATE(BM_EvaluateSegmentTotalsAccuracy, kDistanceRsqrt)->Apply(waypointSizes);
+BENCHMARK_TEMPLATE(BM_EvaluateSegmentTotalsAccuracy, kDistanceLevel)->Apply(waypointSizes);
+
+// ---------------------------------------------------------------
+// energyConsumption() and the batch kernels
+// ---------------------------------------------------------------
+
+void BM_EnergyConsumption(benchmark::State& state) {
+    double v = 0.5;
+    double h = 100.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(h);
+        benchmark::DoNotOptimize(energyConsumption(v, h, kA, kB, kC));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_EnergyConsumption);
+
+void makeSamples(std::size_t n, std::vector<double>& v, std::vector<double>& h) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> speed(0.0, 30.0);
+    std::uniform_real_distribution<double> altitude(0.0, 500.0);
+    v.resize(n);
+    h.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v[i] = speed(rng);
+        h[i] = altitude(rng);
+    }
+}
+
+void setSampleCounters(benchmark::State& state, std::size_t n) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n * 2 * sizeof(double)));
+}
+
+void BM_EnergyBatchScalar(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<double> v, h, out(n);
+    makeSamples(n, v, h);
+    EnergyCoefficients coeffs = {kA, kB, kC};
+    for (auto _ : state) {
+        energyConsumptionBatchScalar(v.data(), h.data(), n, coeffs, out.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, n);
+}
+BENCHMARK(BM_EnergyBatchScalar)->Apply(waypointSizes);
+
+void BM_EnergyBatch(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<double> v, h, out(n);
+    makeSamples(n, v, h);
+    EnergyCoefficients coeffs = {kA, kB, kC};
+    for (auto _ : state) {
+        energyConsumptionBatch(v.data(), h.data(), n, coeffs, out.data());
+        benchmark::ClobberMemory();
+    }
+    setSampleCounters(state, n);
+    state.SetLabel(energyKernelName());
+}
+BENCHMARK(BM_EnergyBatch)->Apply(waypointSizes);
+
+void BM_EnergyArgmin(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<double> v, h;
+    makeSamples(n, v, h);
+    EnergyCoefficients coeffs = {kA, kB, kC};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(energyArgminBatch(v.data(), h.data(), n, coeffs));
+    }
+    setSampleCounters(state, n);
+    state.SetLabel(energyKernelName());
+}
+BENCHMARK(BM_EnergyArgmin)->Apply(waypointSizes);
+
+// ---------------------------------------------------------------
+// findOptimalSpeedAndAltitude() and the constrained optimizer
+// ---------------------------------------------------------------
+
+void BM_FindOptimalSpeedAndAltitude(benchmark::State& state) {
+    double a = kA;
+    double b = kB;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        benchmark::DoNotOptimize(findOptimalSpeedAndAltitude(a, b));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_FindOptimalSpeedAndAltitude);
+
+// Warm-started per-segment plan; iterations/segment is reported as a counter
+void BM_PlanSegments(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    DensityCorrectedModel<QuadraticEnergyModel> model = {{kA, kB, kC}, 8500.0};
+    SpeedAltitudeBounds limits = {1.0, 30.0, 0.0, 5000.0};
+    SpeedAltitudeSettings settings;
+    settings.hoverPower = 50.0;
+    SegmentPlan plan;
+    for (auto _ : state) {
+        planSegments(path, model, limits, settings, 0.5, 0.0, true, plan);
+        benchmark::DoNotOptimize(plan.totalEnergy);
+    }
+    setWaypointCounters(state, n);
+    state.counters["iterations/segment"] =
+        n > 1 ? static_cast<double>(plan.totalIterations) / static_cast<double>(n - 1) : 0.0;
+}
+BENCHMARK(BM_PlanSegments)->RangeMultiplier(10)->Range(10, 1000000);
+
+// ---------------------------------------------------------------
+// Spatial index: build cost and nearest-segment queries at
+// telemetry rates (items = queries)
+// ---------------------------------------------------------------
+
+void BM_SpatialIndexBuild(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::vector<Waypoint>& route = cachedRoute(n);
+    for (auto _ : state) {
+        RouteSpatialIndex index;
+        index.build(route);
+        benchmark::DoNotOptimize(index.cellCount());
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_SpatialIndexBuild)->RangeMultiplier(10)->Range(10, 1000000);
+
+void BM_NearestSegment(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::vector<Waypoint>& route = cachedRoute(n);
+    RouteSpatialIndex index;
+    index.build(route);
+    std::mt19937_64 rng(11);
+    std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+    std::uniform_real_distribution<double> offset(-20.0, 20.0);
+    std::vector<Waypoint> queries(1024);
+    for (Waypoint& q : queries) {
+        q = route[pick(rng)];
+        q.x += offset(rng);
+        q.y += offset(rng);
+    }
+    std::size_t next = 0;
+    for (auto _ : state) {
+        SegmentHit hit;
+        benchmark::DoNotOptimize(index.nearestSegment(queries[next++ & 1023], hit));
+        benchmark::DoNotOptimize(hit.distance);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_NearestSegment)->RangeMultiplier(10)->Range(10, 1000000);
+
+// ---------------------------------------------------------------
+// Voxel planner: 1000 x 1000 x 50 grid of 10 m voxels, corner to
+// corner near the ground; range(0) = obstacle boxes, range(1) = 1 for
+// bidirectional search (items = nodes expanded)
+// ---------------------------------------------------------------
+
+void BM_GridPlanner(benchmark::State& state) {
+    std::size_t obstacles = static_cast<std::size_t>(state.range(0));
+    Waypoint origin = {0.0, 0.0, 0.0};
+    AirspaceGrid grid(1000, 1000, 50, 10.0, origin);
+    std::mt19937_64 rng(5);
+    for (std::size_t k = 0; k < obstacles; ++k) {
+        std::size_t x = rng() % 950, y = rng() % 950;
+        grid.blockBox(x, y, 0, x + rng() % 40, y + rng() % 40, rng() % 45);
+    }
+    GridPlanner planner(grid, demoParams());
+    PlannerOptions options;
+    options.bidirectional = state.range(1) != 0;
+    Waypoint start = {15.0, 15.0, 5.0};
+    Waypoint goal = {9985.0, 9975.0, 25.0};
+    PlannedPath path;
+    std::string error;
+    std::size_t expansions = 0;
+    for (auto _ : state) {
+        if (!planner.plan(start, goal, path, error, options)) {
+            state.SkipWithError(error.c_str());
+            break;
+        }
+        expansions += path.expansions;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(expansions));
+    state.counters["expansions"] = static_cast<double>(path.expansions);
+}
+BENCHMARK(BM_GridPlanner)->ArgsProduct({{0, 50}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------
+// Wind / terrain sampling: 200 x 200 x 10 field of 50 m nodes around
+// the random-walk routes, 100 samples per leg at 12 m/s airspeed
+// (items = waypoints)
+// ---------------------------------------------------------------
+
+const WindField& benchWindField() {
+    static WindField field;
+    static bool ready = false;
+    if (!ready) {
+        WindFieldGrid grid = {200, 200, 10, -5000.0, -5000.0, 0.0, 50.0, 50.0, 50.0};
+        std::vector<float> terrain(grid.nx * grid.ny);
+        std::vector<float> wind(grid.nx * grid.ny * grid.nz * 3);
+        for (std::size_t iy = 0; iy < grid.ny; ++iy) {
+            for (std::size_t ix = 0; ix < grid.nx; ++ix) {
+                terrain[iy * grid.nx + ix] = static_cast<float>(5.0 + 5.0 * std::sin(0.1 * ix) * std::cos(0.1 * iy));
+            }
+        }
+        for (std::size_t node = 0; node < grid.nx * grid.ny * grid.nz; ++node) {
+            wind[3 * node + 0] = static_cast<float>(3.0 * std::sin(0.01 * node));
+            wind[3 * node + 1] = static_cast<float>(2.0 * std::cos(0.013 * node));
+            wind[3 * node + 2] = 0.0f;
+        }
+        // The mapping outlives the unlinked file
+        const std::string path = "ead_bench_wind.eadf";
+        std::string error;
+        ready = writeWindFieldFile(path, grid, terrain, wind, error) && field.open(path, error);
+        std::remove(path.c_str());
+    }
+    return field;
+}
+
+void BM_EvaluateRouteInWind(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    const WindField& field = benchWindField();
+    WindLegParams params;
+    params.energy = demoParams();
+    params.energy.velocity = 12.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluateRouteInWind(path, field, params));
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_EvaluateRouteInWind)->RangeMultiplier(10)->Range(10, 100000);
+
+// ---------------------------------------------------------------
+// Battery feasibility: range(1) = budget as a percentage of the route
+// total (items = waypoints of the route, walked or not), and a fleet
+// screen of 1000 candidate routes against 32 battery states
+// ---------------------------------------------------------------
+
+void BM_CheckFeasibility(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    SegmentEnergyParams params = demoParams();
+    double budget = 0.01 * double(state.range(1)) * evaluateSegments(path, params).totalEnergy();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(checkFeasibility(path, params, budget));
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_CheckFeasibility)->ArgsProduct({{1000, 100000, 10000000}, {10, 50, 101}});
+
+void BM_ScreenRoutes(benchmark::State& state) {
+    std::vector<WaypointSoA> routes;
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> step(-10.0, 10.0);
+    for (std::size_t r = 0; r < 1000; ++r) {
+        WaypointSoA route;
+        Waypoint p = {0.0, 0.0, 100.0};
+        for (std::size_t i = 0; i < 1000; ++i) {
+            p.x += step(rng);
+            p.y += step(rng);
+            p.z = std::max(10.0, p.z + 0.1 * step(rng));
+            route.push_back(p);
+        }
+        routes.push_back(route);
+    }
+    SegmentEnergyParams params = demoParams();
+    double typical = evaluateSegments(routes[0], params).totalEnergy();
+    std::vector<double> budgets;
+    for (std::size_t d = 0; d < 32; ++d) {
+        budgets.push_back(typical * (0.2 + 0.03 * double(d)));
+    }
+    FleetScreen screen;
+    for (auto _ : state) {
+        screenRoutes(routes, params, budgets, screen);
+        benchmark::DoNotOptimize(screen.firstUnreachable.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(routes.size()));
+}
+BENCHMARK(BM_ScreenRoutes)->UseRealTime();
+
+// ---------------------------------------------------------------
+// Coefficient sweeps: the one-off aggregate pass (items = waypoints)
+// and scoring 10000 (a, b, c) sets from the aggregates (items = sets)
+// ---------------------------------------------------------------
+
+void BM_RouteAggregates(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(computeRouteAggregates(path));
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_RouteAggregates)->Apply(waypointSizes);
+
+void BM_SweepCoefficients(benchmark::State& state) {
+    RouteAggregates route = computeRouteAggregates(cachedRouteSoA(100000));
+    std::mt19937_64 rng(13);
+    std::uniform_real_distribution<double> unit(0.5, 1.5);
+    std::vector<EnergyCoefficients> sets(10000);
+    for (EnergyCoefficients& coeffs : sets) {
+        coeffs.a = kA * unit(rng);
+        coeffs.b = kB * unit(rng);
+        coeffs.c = kC * unit(rng);
+    }
+    std::vector<SweepResult> results;
+    for (auto _ : state) {
+        sweepCoefficients(route, sets, results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(sets.size()));
+}
+BENCHMARK(BM_SweepCoefficients);
+
+// ---------------------------------------------------------------
+// Scalar-type templates: double reference vs float vs Q16.16
+// ---------------------------------------------------------------
+
+// Capped at 1M waypoints: the random walk stays inside the Q16.16 range
+void precisionSizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(10)->Range(10, 1000000);
+}
+
+// Label: relative energy error against evaluateSegmentTotals()
+template <typename T>
+void BM_EvaluateRouteScalar(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::vector<Waypoint>& route = cachedRoute(n);
+    std::vector<BasicWaypoint<T>> converted = convertWaypoints<T>(route);
+    SegmentEnergyParams params = demoParams();
+    for (auto _ : state) {
+        BasicRouteTotals<T> totals = evaluateRoute(converted, params);
+        benchmark::DoNotOptimize(totals);
+    }
+    const WaypointSoA& path = cachedRouteSoA(n);
+    double reference = evaluateSegmentTotals(path.x.data(), path.y.data(), path.z.data(), n, params).energy;
+    double energy = evaluateRoute(converted, params).energy.toDouble();
+    char label[64];
+    std::snprintf(label, sizeof(label), "%s rel_err=%.2e", ScalarTraits<T>::name(), energy / reference - 1.0);
+    state.SetLabel(label);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n * sizeof(BasicWaypoint<T>)));
+}
+BENCHMARK_TEMPLATE(BM_EvaluateRouteScalar, double)->Apply(precisionSizes);
+BENCHMARK_TEMPLATE(BM_EvaluateRouteScalar, float)->Apply(precisionSizes);
+BENCHMARK_TEMPLATE(BM_EvaluateRouteScalar, Fixed16)->Apply(precisionSizes);
+
+// ---------------------------------------------------------------
+// Time-stepped fleet simulation
+// ---------------------------------------------------------------
+
+// One 1 s tick of N drones on 64 routes cut from one 1000-waypoint
+// walk at different starting waypoints, so leg changes are spread out
+// like a real fleet; items/s = drone updates per second
+void BM_FleetStep(benchmark::State& state) {
+    std::size_t drones = static_cast<std::size_t>(state.range(0));
+    const std::size_t kWaypoints = 1000;
+    const WaypointSoA& route = cachedRouteSoA(kWaypoints);
+    std::vector<WaypointSoA> routes(64);
+    for (std::size_t r = 0; r < routes.size(); ++r) {
+        for (std::size_t i = r * 7; i < kWaypoints; ++i) {
+            routes[r].push_back(route[i]);
+        }
+    }
+    std::vector<FleetDroneSpec> specs(drones);
+    for (std::size_t i = 0; i < drones; ++i) {
+        specs[i].route = i % routes.size();
+        specs[i].coeffs.a = kA;
+        specs[i].coeffs.b = kB;
+        specs[i].coeffs.c = kC;
+        specs[i].velocity = 5.0;
+        specs[i].battery = 1e12;
+        specs[i].departureTime = 0.0;
+    }
+    // Restarted whenever the whole fleet has arrived, so every timed
+    // tick moves drones
+    std::unique_ptr<FleetSimulator> fleet(new FleetSimulator(routes, specs));
+    for (auto _ : state) {
+        if (fleet->finished()) {
+            state.PauseTiming();
+            fleet.reset(new FleetSimulator(routes, specs));
+            state.ResumeTiming();
+        }
+        fleet->step(1.0);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(drones));
+}
+BENCHMARK(BM_FleetStep)->RangeMultiplier(10)->Range(1000, 1000000)->UseRealTime();
+
+// ---------------------------------------------------------------
+// Route cache: whole-route hits and prefix reuse
+// ---------------------------------------------------------------
+
+// Same route every time: one hash pass plus the verifying compare
+// (compare with BM_EvaluateSegments at the same size)
+void BM_RouteCacheHit(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    SegmentEnergyParams params = demoParams();
+    RouteCacheOptions options;
+    options.shards = 1;
+    options.maxBytes = 2 * n * 64; // A shard must hold the whole route
+    RouteCache cache(options);
+    cache.evaluate(path, params);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.evaluate(path, params));
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_RouteCacheHit)->RangeMultiplier(10)->Range(1000, 1000000);
+
+// Cached route plus a fresh 1% suffix each iteration: the prefix legs
+// are copied and only the suffix is evaluated
+void BM_RouteCachePrefix(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    SegmentEnergyParams params = demoParams();
+    RouteCacheOptions options;
+    options.shards = 1;
+    options.maxBytes = 4 * n * 64; // Room for the base route and a few extensions
+    RouteCache cache(options);
+    cache.evaluate(path, params);
+    WaypointSoA extended = path;
+    std::size_t suffix = n / 100;
+    for (std::size_t i = 0; i < suffix; ++i) {
+        extended.push_back(path[n - 1 - i]);
+    }
+    double offset = 0.0;
+    for (auto _ : state) {
+        // A new last waypoint every time, so the extension never hits whole
+        extended.x.back() = (offset += 1.0);
+        benchmark::DoNotOptimize(cache.evaluate(extended, params));
+    }
+    setWaypointCounters(state, n + suffix);
+    state.counters["legs_reused"] = static_cast<double>(cache.stats().legsReused) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_RouteCachePrefix)->RangeMultiplier(10)->Range(1000, 1000000);
+
+// ---------------------------------------------------------------
+// Editable route: one edit plus the re-scored totals
+// ---------------------------------------------------------------
+
+// Move, insert and erase at random positions; each iteration is one
+// edit followed by a read of the new total (compare with a full
+// BM_EvaluateSegments pass at the same size)
+void BM_EditableRouteEdit(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    EditableRoute route(cachedRoute(n), demoParams());
+    std::mt19937_64 rng(7);
+    std::size_t edit = 0;
+    for (auto _ : state) {
+        std::size_t i = rng() % route.size();
+        Waypoint wp = route.waypoint(i);
+        wp.x += 1.0;
+        switch (edit++ % 3) {
+        case 0: route.move(i, wp); break;
+        case 1: route.insert(i, wp); break;
+        case 2: route.erase(i); break;
+        }
+        benchmark::DoNotOptimize(route.totalEnergy());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_EditableRouteEdit)->RangeMultiplier(10)->Range(1000, 1000000);
+
+// Time / energy front with the default 8 speeds, at the route's
+// altitude (levels = 1) or with offsets -20 / 0 / +20 m (levels = 3);
+// the label reports the plans on the front
+void BM_ParetoFront(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    EnergyCoefficients coeffs = {kA, kB, kC};
+    ParetoOptions options;
+    if (state.range(1) == 3) {
+        options.altitudeOffsets = {-20.0, 0.0, 20.0};
+    }
+    std::size_t plans = 0;
+    for (auto _ : state) {
+        std::vector<ParetoPoint> front = paretoFront(path, coeffs, options);
+        plans = front.size();
+        benchmark::DoNotOptimize(front.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(n));
+    state.SetLabel("plans: " + std::to_string(plans));
+}
+BENCHMARK(BM_ParetoFront)->ArgsProduct({{1000, 10000}, {1, 3}})->Args({100000, 1})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Energy samples per second over a 10k-waypoint route, in still air
+// (wind = 0, O(1) per sample) and with a random wind (wind = 1, one
+// pass per heading bin); the aggregates are built once
+void BM_MonteCarlo(benchmark::State& state) {
+    std::size_t samples = static_cast<std::size_t>(state.range(0));
+    MonteCarloRoute route = makeMonteCarloRoute(cachedRouteSoA(10000));
+    MonteCarloOptions options;
+    options.a = UncertainValue(kUncertainNormal, kA, 0.1 * kA);
+    options.b = UncertainValue(kUncertainNormal, kB, 0.1 * kB);
+    options.c = UncertainValue(kUncertainNormal, kC, 0.1 * kC);
+    if (state.range(1)) {
+        options.windSpeed = UncertainValue(kUncertainUniform, 0.0, 0.2);
+    }
+    options.samples = samples;
+    std::vector<double> energies;
+    for (auto _ : state) {
+        MonteCarloResult result = runMonteCarlo(route, options, &energies);
+        benchmark::DoNotOptimize(result.p99);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(samples));
+}
+BENCHMARK(BM_MonteCarlo)->ArgsProduct({{10000, 1000000}, {0, 1}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// CPU reference of the GPU scorer: 'routes' routes of 'waypoints'
+// waypoints each in one packed batch (compare with
+// EAD_EnergyAwareDrone_gpu on the same sizes)
+void BM_ScoreRouteBatch(benchmark::State& state) {
+    std::size_t routes = static_cast<std::size_t>(state.range(0));
+    std::size_t waypoints = static_cast<std::size_t>(state.range(1));
+    const WaypointSoA& path = cachedRouteSoA(routes * waypoints);
+    EnergyCoefficients coeffs = {kA, kB, kC};
+    double velocity = std::get<0>(findOptimalSpeedAndAltitude(kA, kB));
+    PackedRouteBatch batch;
+    for (std::size_t r = 0; r < routes; ++r) {
+        std::size_t first = r * waypoints;
+        batch.append(path.x.data() + first, path.y.data() + first, path.z.data() + first, waypoints, coeffs,
+                     velocity);
+    }
+    std::vector<SegmentEnergyTotals> totals;
+    for (auto _ : state) {
+        scoreRouteBatch(batch, RouteBatchOptions(), totals);
+        benchmark::DoNotOptimize(totals.data());
+    }
+    setWaypointCounters(state, routes * waypoints);
+}
+BENCHMARK(BM_ScoreRouteBatch)->Args({100000, 10})->Args({10000, 100})->Args({1000, 1000})->UseRealTime();
+
+// ---------------------------------------------------------------
+// Per-segment model and fleet batch mode
+// ---------------------------------------------------------------
+
+void BM_EvaluateSegments(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    SegmentEnergyParams params = demoParams();
+    SegmentEnergyProfile profile;
+    for (auto _ : state) {
+        evaluateSegments(path, params, profile);
+        benchmark::DoNotOptimize(profile.totalEnergy());
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_EvaluateSegments)->Apply(waypointSizes);
+
+void BM_EvaluateSegmentTotals(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    SegmentEnergyParams params = demoParams();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluateSegmentTotals(path.x.data(), path.y.data(), path.z.data(), n, params));
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_EvaluateSegmentTotals)->Apply(waypointSizes);
+
+void BM_EvaluateSegmentTotalsParallel(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const WaypointSoA& path = cachedRouteSoA(n);
+    SegmentEnergyParams params = demoParams();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(evaluateSegmentTotalsParallel(path, params));
+    }
+    setWaypointCounters(state, n);
+}
+BENCHMARK(BM_EvaluateSegmentTotalsParallel)->Apply(waypointSizes)->UseRealTime();
+
+// Batch input of 'missions' copies of one route
+std::string batchInput(std::size_t missions, std::size_t waypointsPerMission) {
+    const std::vector<Waypoint>& route = cachedRoute(waypointsPerMission);
+    std::ostringstream text;
+    for (std::size_t m = 0; m < missions; ++m) {
+        text << "m" << m << ' ' << kA << ' ' << kB << ' ' << kC;
+        for (const Waypoint& wp : route) {
+            text << ' ' << wp.x << ' ' << wp.y << ' ' << wp.z;
+        }
+        text << '\n';
+    }
+    return text.str();
+}
+
+// Output sink that drops everything without buffering it
+struct DiscardBuffer : std::streambuf {
+    int overflow(int ch) override { return traits_type::not_eof(ch); }
+};
+
+// Heap allocations of one runBatch() over 'input', output discarded
+std::size_t runBatchAllocations(const std::string& input, const BatchOptions& options) {
+    std::istringstream in(input);
+    DiscardBuffer sink;
+    std::ostream out(&sink);
+    std::size_t before = heapAllocations.load(std::memory_order_relaxed);
+    runBatch(in, out, options);
+    return heapAllocations.load(std::memory_order_relaxed) - before;
+}
+
+// Missions of 'range(1)' waypoints each; items = missions. After a
+// warm-up run:
+//   arena_allocs  = worker arena blocks taken from the heap per run
+//   heap_allocs   = operator new calls per run, including the per-run
+//                   setup (slot window, string streams)
+//   steady_allocs = operator new calls per mission once the window is
+//                   full: the difference between runs of 2x and 1x the
+//                   missions with a 64-mission window, divided by the
+//                   extra missions (0 = the mission loop never touches
+//                   the heap)
+void BM_RunBatch(benchmark::State& state) {
+    std::size_t missions = static_cast<std::size_t>(state.range(0));
+    std::string input = batchInput(missions, static_cast<std::size_t>(state.range(1)));
+    BatchOptions options;
+    {
+        std::istringstream in(input);
+        std::ostringstream out;
+        runBatch(in, out, options);
+    }
+    BatchOptions windowed = options;
+    windowed.window = 64;
+    std::string twice = input + input;
+    runBatchAllocations(twice, windowed);
+    double steady = (double(runBatchAllocations(twice, windowed)) - double(runBatchAllocations(input, windowed))) /
+                    double(missions);
+
+    std::size_t arenaBefore = ArenaResource::totalUpstreamAllocations();
+    std::size_t heapBefore = heapAllocations.load(std::memory_order_relaxed);
+    for (auto _ : state) {
+        std::istringstream in(input);
+        std::ostringstream out;
+        benchmark::DoNotOptimize(runBatch(in, out, options));
+    }
+    std::size_t heapAfter = heapAllocations.load(std::memory_order_relaxed);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(missions));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input.size()));
+    state.counters["arena_allocs"] = benchmark::Counter(
+        double(ArenaResource::totalUpstreamAllocations() - arenaBefore), benchmark::Counter::kAvgIterations);
+    state.counters["heap_allocs"] = benchmark::Counter(double(heapAfter - heapBefore),
+                                                       benchmark::Counter::kAvgIterations);
+    state.counters["steady_allocs"] = steady;
+}
+BENCHMARK(BM_RunBatch)->Args({1000, 10})->Args({1000, 100})->Args({100, 10000})->UseRealTime();
+
+// Same through a ResultWriter into /dev/null; range(0) = ResultFormat,
+// range(1) = 1 for per-leg records
+void BM_RunBatchWriter(benchmark::State& state) {
+    std::size_t missions = 10000;
+    std::string input = batchInput(missions, 10);
+    ResultWriterOptions output;
+    output.format = static_cast<ResultFormat>(state.range(0));
+    output.segments = state.range(1) != 0;
+    BatchOptions options;
+    for (auto _ : state) {
+        std::istringstream in(input);
+        ResultWriter writer;
+        std::string error;
+        if (!writer.open("/dev/null", output, error)) {
+            state.SkipWithError(error.c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(runBatch(in, writer, options));
+        writer.close(error);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(missions));
+}
+BENCHMARK(BM_RunBatchWriter)
+    ->Args({kResultText, 0})
+    ->Args({kResultCsv, 0})
+    ->Args({kResultJsonLines, 0})
+    ->Args({kResultBinary, 0})
+    ->Args({kResultText, 1})
+    ->Args({kResultBinary, 1})
+    ->UseRealTime();
+
+// ---------------------------------------------------------------
+// Charging-aware scheduling
+// ---------------------------------------------------------------
+
+// Replan of a day of range(0) missions (one every 8 s, 100-waypoint
+// route, mixed priorities) on range(1) drones sharing range(1) / 5
+// chargers, from the start of the day (range(2) = 0) or from midday
+// with the morning's work kept (1); features are computed once outside
+// the loop, so this is the assignment pass alone. items = missions
+void BM_ScheduleReplan(benchmark::State& state) {
+    std::size_t missions = static_cast<std::size_t>(state.range(0));
+    std::size_t drones = static_cast<std::size_t>(state.range(1));
+    const WaypointSoA& route = cachedRouteSoA(100);
+    ScheduledDrone spec;
+    spec.coeffs = demoParams().coeffs;
+    spec.velocity = 0.0;
+    // Three missions per battery, a full charge takes an hour
+    spec.capacity = 3.0 * evaluateSegmentTotals(route.x.data(), route.y.data(), route.z.data(), route.size(),
+                                                demoParams()).energy;
+    spec.charge = spec.capacity;
+    spec.chargeRate = spec.capacity / 3600.0;
+    spec.availableFrom = 0.0;
+    SchedulerOptions options;
+    options.chargers = std::max<std::size_t>(1, drones / 5);
+    MissionScheduler scheduler(std::vector<ScheduledDrone>(drones, spec), options);
+    for (std::size_t m = 0; m < missions; ++m) {
+        ScheduledMission mission;
+        mission.route = route;
+        mission.release = 8.0 * double(m);
+        mission.priority = static_cast<int>(m % 3);
+        scheduler.submit(std::move(mission));
+    }
+    scheduler.update();
+    double now = state.range(2) != 0 ? 4.0 * double(missions) : 0.0;
+    for (auto _ : state) {
+        scheduler.replan(now);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(missions));
+    ScheduleSummary summary = scheduler.summary();
+    state.counters["charges"] = double(summary.charges);
+    state.counters["unassigned"] = double(summary.unassigned);
+}
+BENCHMARK(BM_ScheduleReplan)
+    ->Args({10000, 100, 0})
+    ->Args({10000, 300, 0})
+    ->Args({10000, 1000, 0})
+    ->Args({10000, 300, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::AddCustomContext("ead_build_type", EAD_BUILD_TYPE);
+    benchmark::AddCustomContext("ead_path_kernel", pathKernelName());
+    benchmark::AddCustomContext("ead_energy_kernel", energyKernelName());
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
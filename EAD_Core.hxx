@@ -0,0 +1,124 @@
+#ifndef EAD_CORE_HXX
+#define EAD_CORE_HXX
+
+#include <cmath>
+#include <tuple>
+
+// Core Drone Model: Waypoints, Distance and Energy
+// =========================================================
+// Shared by the simulator and every evaluator built on top of it.
+// The functions here are the scalar reference implementations; the
+// batched / SIMD variants elsewhere must agree with them.
+// =========================================================
+
+// Scalar type
+// -------------------------------------------------------------
+// Waypoint, distance() and energyConsumption() are templates over the
+// scalar type T so the same model runs on targets with no double FPU:
+//
+//   double    reference (Waypoint, used everywhere else)
+//   float     single-precision FPUs; as storage (float32 route files)
+//             it halves the bytes loaded, while the SoA kernels widen
+//             it to double for the math
+//   Fixed16   Q16.16 fixed point, no FPU at all (EAD_FixedPoint.hxx)
+//
+// T needs +, -, *, comparisons, construction from double and a
+// sqrt() found by argument-dependent lookup. Error bounds of each
+// type against the double reference are in EAD_Precision.hxx.
+// -------------------------------------------------------------
+
+// Struct to represent each waypoint in 3D space (x, y, z)
+template <typename T>
+struct BasicWaypoint {
+    T x, y, z;
+};
+
+using Waypoint = BasicWaypoint<double>;
+
+// Function to calculate Euclidean distance between two waypoints
+// -------------------------------------------------------------
+// Distance Formula:
+//   distance = sqrt((x2 - x1)^2 + (y2 - y1)^2 + (z2 - z1)^2)
+// -------------------------------------------------------------
+//       (x1, y1, z1)     (x2, y2, z2)
+//           |               |
+//           V               V
+//        <------ Distance ------>
+// -------------------------------------------------------------
+// Squares are explicit products (std::pow(d, 2) is folded to d * d
+// for double anyway), so any T with * works.
+// -------------------------------------------------------------
+template <typename T>
+inline T distance(const BasicWaypoint<T>& wp1, const BasicWaypoint<T>& wp2) {
+    using std::sqrt;
+    T dx = wp2.x - wp1.x;
+    T dy = wp2.y - wp1.y;
+    T dz = wp2.z - wp1.z;
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// Function to calculate energy consumption given velocity and altitude
+// -------------------------------------------------------------
+// Energy Equation:
+//   E(t) = a * v^2 + b * h + c
+//   where:
+//     * v = velocity (speed)
+//     * h = altitude
+//     * a, b, c = coefficients affecting energy consumption
+// -------------------------------------------------------------
+// Energy depends on:
+// - v^2 (quadratic impact of speed)
+// - h (linear impact of altitude)
+// - c (constant baseline energy use)
+// -------------------------------------------------------------
+template <typename T>
+inline T energyConsumption(T velocity, T altitude, T a, T b, T c) {
+    return a * (velocity * velocity) + b * altitude + c;
+}
+
+// Non-template double overload, so mixed arguments (e.g. an int
+// altitude) still convert as they did before
+inline double energyConsumption(double velocity, double altitude, double a, double b, double c) {
+    return energyConsumption<double>(velocity, altitude, a, b, c);
+}
+
+// Coefficient set (a, b, c) of the energy equation above, bundled so
+// batch evaluators can take one argument instead of three
+struct EnergyCoefficients {
+    double a, b, c;
+};
+
+inline double energyConsumption(double velocity, double altitude, const EnergyCoefficients& coeffs) {
+    return energyConsumption(velocity, altitude, coeffs.a, coeffs.b, coeffs.c);
+}
+
+// Coefficients are rounded to T on every call; loops should convert
+// them once and use the five-argument form
+template <typename T>
+inline T energyConsumption(T velocity, T altitude, const EnergyCoefficients& coeffs) {
+    return energyConsumption(velocity, altitude, T(coeffs.a), T(coeffs.b), T(coeffs.c));
+}
+
+// Function to find optimal velocity for minimal energy consumption
+// -------------------------------------------------------------
+// Partial Derivative of Energy w.r.t velocity (v):
+//   dE/dv = 2 * a * v
+//
+// Solving for minimum energy:
+//   Set dE/dv = 0 --> v = sqrt(b / (2 * a))
+// -------------------------------------------------------------
+//   When a != 0, we solve for the optimal v
+// -------------------------------------------------------------
+inline std::tuple<double, double> findOptimalSpeedAndAltitude(double a, double b) {
+    double optimalVelocity = 0.0; // Start at zero and increment based on partial derivative
+    double optimalAltitude = 100.0; // Assume a standard altitude for simplicity
+
+    // If 'a' is non-zero, find the optimal speed that minimizes energy
+    if (a != 0) {
+        optimalVelocity = std::sqrt(b / (2 * a)); // Simplified from partial derivative
+    }
+
+    return std::make_tuple(optimalVelocity, optimalAltitude);
+}
+
+#endif // EAD_CORE_HXX
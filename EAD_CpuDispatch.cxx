@@ -0,0 +1,56 @@
+#include "EAD_CpuDispatch.hxx"
+
+#include <cstdlib>
+#include <cstring>
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case kSimdScalar:
+        return "scalar";
+    case kSimdNeon:
+        return "neon";
+    case kSimdAvx2:
+        return "avx2";
+    case kSimdAvx512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+SimdLevel detectSimdLevel() {
+    SimdLevel level = kSimdScalar;
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    // Both builtins also check that the OS saves the wide registers
+    __builtin_cpu_init();
+#if defined(EAD_SIMD_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        level = kSimdAvx2;
+    }
+#endif
+#if defined(EAD_SIMD_AVX512)
+    if (__builtin_cpu_supports("avx512f")) {
+        level = kSimdAvx512;
+    }
+#endif
+#elif defined(EAD_SIMD_AVX512)
+    level = kSimdAvx512;
+#elif defined(EAD_SIMD_AVX2)
+    level = kSimdAvx2;
+#elif defined(EAD_SIMD_NEON)
+    level = kSimdNeon;
+#endif
+
+    const char* cap = std::getenv("EAD_SIMD");
+    if (cap && *cap) {
+        for (int candidate = kSimdScalar; candidate <= kSimdAvx512; ++candidate) {
+            if (std::strcmp(cap, simdLevelName(static_cast<SimdLevel>(candidate))) == 0) {
+                if (candidate < level) {
+                    // x86 has no NEON kernels to fall back to
+                    level = candidate == kSimdNeon ? kSimdScalar : static_cast<SimdLevel>(candidate);
+                }
+                break;
+            }
+        }
+    }
+    return level;
+}
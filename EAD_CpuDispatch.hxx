@@ -0,0 +1,66 @@
+#ifndef EAD_CPU_DISPATCH_HXX
+#define EAD_CPU_DISPATCH_HXX
+
+// Runtime SIMD Kernel Selection
+// =========================================================
+// One x86-64 binary carries every batch kernel and picks the widest
+// one the host supports on first use:
+//
+//   segmentLengths()  ----+
+//   totalPathLength()     +--> simdLevel() --> avx512 | avx2 | scalar
+//   energy*Batch()    ----+        |
+//                                  +-- CPUID (and OS ymm/zmm state),
+//                                      once, capped by $EAD_SIMD
+//
+// Each wide kernel is compiled with a per-function target attribute
+// (EAD_TARGET_AVX2 / EAD_TARGET_AVX512), so the rest of the program
+// keeps the baseline ISA and still runs on any x86-64 machine.
+//
+//   build                            kernels compiled in
+//   -------------------------------  -----------------------------
+//   GCC / Clang, x86-64              scalar, avx2, avx512
+//   other compiler with -mavx2       scalar, avx2
+//   AArch64                          scalar, neon
+//   anything else, or
+//   EAD_CPU_DISPATCH=OFF             what -march enables, else scalar
+//
+// EAD_SIMD=scalar|neon|avx2|avx512 in the environment caps the level
+// (e.g. to compare kernels with ead_bench on one machine); it never
+// raises it above what the CPU supports. pathKernelName() and
+// energyKernelName() report the kernel actually chosen.
+// =========================================================
+
+enum SimdLevel { kSimdScalar, kSimdNeon, kSimdAvx2, kSimdAvx512 };
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(EAD_NO_CPU_DISPATCH)
+#define EAD_SIMD_AVX2 1
+#define EAD_SIMD_AVX512 1
+#define EAD_TARGET_AVX2 __attribute__((target("avx2")))
+#define EAD_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#if defined(__AVX2__)
+#define EAD_SIMD_AVX2 1
+#define EAD_TARGET_AVX2
+#endif
+#if defined(__AVX512F__)
+#define EAD_SIMD_AVX512 1
+#define EAD_TARGET_AVX512
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define EAD_SIMD_NEON 1
+#endif
+#endif
+
+// Best level compiled in and supported here, capped by $EAD_SIMD
+SimdLevel detectSimdLevel();
+
+// detectSimdLevel(), evaluated once
+inline SimdLevel simdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+// "scalar", "neon", "avx2" or "avx512"
+const char* simdLevelName(SimdLevel level);
+
+#endif // EAD_CPU_DISPATCH_HXX
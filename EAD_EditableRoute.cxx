@@ -0,0 +1,297 @@
+#include "EAD_EditableRoute.hxx"
+
+#include "EAD_Stats.hxx"
+
+EditableRoute::EditableRoute(const SegmentEnergyParams& params, std::uint64_t seed)
+    : params_(params), cruise_(cruiseEnergyPerMeter(params.velocity, params)), root_(kNone), rng_(seed | 1) {}
+
+EditableRoute::EditableRoute(const std::vector<Waypoint>& waypoints, const SegmentEnergyParams& params,
+                             std::uint64_t seed)
+    : EditableRoute(params, seed) {
+    assign(waypoints);
+}
+
+// xorshift64*: priorities only need to be independent of positions
+std::uint64_t EditableRoute::nextPriority() {
+    rng_ ^= rng_ >> 12;
+    rng_ ^= rng_ << 25;
+    rng_ ^= rng_ >> 27;
+    return rng_ * 0x2545f4914f6cdd1dull;
+}
+
+std::uint32_t EditableRoute::newNode(const Waypoint& wp) {
+    Node node;
+    node.wp = wp;
+    node.length = node.energy = node.sumLength = node.sumEnergy = 0.0;
+    node.priority = nextPriority();
+    node.left = node.right = kNone;
+    node.count = 1;
+    if (!free_.empty()) {
+        std::uint32_t index = free_.back();
+        free_.pop_back();
+        nodes_[index] = node;
+        return index;
+    }
+    nodes_.push_back(node);
+    return static_cast<std::uint32_t>(nodes_.size() - 1);
+}
+
+void EditableRoute::pull(std::uint32_t index) {
+    Node& node = nodes_[index];
+    node.count = 1;
+    node.sumLength = node.length;
+    node.sumEnergy = node.energy;
+    if (node.left != kNone) {
+        const Node& left = nodes_[node.left];
+        node.count += left.count;
+        node.sumLength += left.sumLength;
+        node.sumEnergy += left.sumEnergy;
+    }
+    if (node.right != kNone) {
+        const Node& right = nodes_[node.right];
+        node.count += right.count;
+        node.sumLength += right.sumLength;
+        node.sumEnergy += right.sumEnergy;
+    }
+}
+
+// First 'count' waypoints of the subtree go left, the rest right
+void EditableRoute::split(std::uint32_t node, std::size_t count, std::uint32_t& left, std::uint32_t& right) {
+    if (node == kNone) {
+        left = right = kNone;
+        return;
+    }
+    std::size_t leftCount = nodes_[node].left == kNone ? 0 : nodes_[nodes_[node].left].count;
+    if (count <= leftCount) {
+        split(nodes_[node].left, count, left, nodes_[node].left);
+        right = node;
+    } else {
+        split(nodes_[node].right, count - leftCount - 1, nodes_[node].right, right);
+        left = node;
+    }
+    pull(node);
+}
+
+std::uint32_t EditableRoute::merge(std::uint32_t left, std::uint32_t right) {
+    if (left == kNone) {
+        return right;
+    }
+    if (right == kNone) {
+        return left;
+    }
+    if (nodes_[left].priority > nodes_[right].priority) {
+        nodes_[left].right = merge(nodes_[left].right, right);
+        pull(left);
+        return left;
+    }
+    nodes_[right].left = merge(left, nodes_[right].left);
+    pull(right);
+    return right;
+}
+
+// Cartesian tree over random priorities in one left-to-right pass
+// (the stack holds the right spine); legs and sums come after
+std::uint32_t EditableRoute::build(const std::vector<Waypoint>& waypoints) {
+    std::vector<std::uint32_t> spine;
+    for (const Waypoint& wp : waypoints) {
+        std::uint32_t node = newNode(wp);
+        std::uint32_t last = kNone;
+        while (!spine.empty() && nodes_[spine.back()].priority < nodes_[node].priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        nodes_[node].left = last;
+        if (!spine.empty()) {
+            nodes_[spine.back()].right = node;
+        }
+        spine.push_back(node);
+    }
+    return spine.empty() ? kNone : spine.front();
+}
+
+void EditableRoute::cost(Node& node, const Waypoint* previous) const {
+    if (previous) {
+        node.length = distance(*previous, node.wp);
+        node.energy = legEnergy(node.length, previous->z, node.wp.z, cruise_, params_);
+    } else {
+        node.length = node.energy = 0.0;
+    }
+}
+
+// In-order pass: cost every leg from its predecessor, sums bottom-up
+void EditableRoute::recostSubtree(std::uint32_t node, const Waypoint*& previous) {
+    if (node == kNone) {
+        return;
+    }
+    recostSubtree(nodes_[node].left, previous);
+    cost(nodes_[node], previous);
+    previous = &nodes_[node].wp;
+    recostSubtree(nodes_[node].right, previous);
+    pull(node);
+}
+
+void EditableRoute::assign(const std::vector<Waypoint>& waypoints) {
+    nodes_.clear();
+    free_.clear();
+    // Headroom so the first inserts after loading do not reallocate
+    // (and copy) the whole node array mid-edit
+    nodes_.reserve(waypoints.size() + waypoints.size() / 4 + 64);
+    root_ = build(waypoints);
+    const Waypoint* previous = nullptr;
+    recostSubtree(root_, previous);
+}
+
+void EditableRoute::setParams(const SegmentEnergyParams& params) {
+    params_ = params;
+    cruise_ = cruiseEnergyPerMeter(params.velocity, params);
+    const Waypoint* previous = nullptr;
+    recostSubtree(root_, previous);
+}
+
+std::uint32_t EditableRoute::nodeAt(std::size_t i) const {
+    std::uint32_t node = root_;
+    while (node != kNone) {
+        std::size_t leftCount = nodes_[node].left == kNone ? 0 : nodes_[nodes_[node].left].count;
+        if (i < leftCount) {
+            node = nodes_[node].left;
+        } else if (i == leftCount) {
+            return node;
+        } else {
+            i -= leftCount + 1;
+            node = nodes_[node].right;
+        }
+    }
+    return kNone;
+}
+
+Waypoint EditableRoute::waypoint(std::size_t i) const {
+    return nodes_[nodeAt(i)].wp;
+}
+
+void EditableRoute::collect(std::uint32_t node, std::vector<Waypoint>& out) const {
+    if (node == kNone) {
+        return;
+    }
+    collect(nodes_[node].left, out);
+    out.push_back(nodes_[node].wp);
+    collect(nodes_[node].right, out);
+}
+
+std::vector<Waypoint> EditableRoute::waypoints() const {
+    std::vector<Waypoint> out;
+    out.reserve(size());
+    collect(root_, out);
+    return out;
+}
+
+// Re-cost the leg arriving at position i of the subtree, refreshing
+// the sums on the way back up
+void EditableRoute::recost(std::uint32_t node, std::size_t i, const Waypoint* previous) {
+    std::size_t leftCount = nodes_[node].left == kNone ? 0 : nodes_[nodes_[node].left].count;
+    if (i < leftCount) {
+        recost(nodes_[node].left, i, previous);
+    } else if (i == leftCount) {
+        cost(nodes_[node], previous);
+    } else {
+        recost(nodes_[node].right, i - leftCount - 1, previous);
+    }
+    pull(node);
+}
+
+void EditableRoute::recostIncoming(std::size_t i) {
+    if (i >= size()) {
+        return;
+    }
+    Waypoint previous;
+    if (i > 0) {
+        previous = waypoint(i - 1);
+    }
+    recost(root_, i, i > 0 ? &previous : nullptr);
+}
+
+void EditableRoute::insert(std::size_t i, const Waypoint& wp) {
+    EAD_STATS_TIMER("route_edit");
+    if (i > size()) {
+        i = size();
+    }
+    std::uint32_t node = newNode(wp);
+    std::uint32_t left, right;
+    split(root_, i, left, right);
+    root_ = merge(merge(left, node), right);
+    recostIncoming(i);
+    recostIncoming(i + 1);
+}
+
+void EditableRoute::erase(std::size_t i) {
+    EAD_STATS_TIMER("route_edit");
+    if (i >= size()) {
+        return;
+    }
+    std::uint32_t left, middle, right;
+    split(root_, i, left, right);
+    split(right, 1, middle, right);
+    free_.push_back(middle);
+    root_ = merge(left, right);
+    recostIncoming(i);
+}
+
+void EditableRoute::move(std::size_t i, const Waypoint& wp) {
+    EAD_STATS_TIMER("route_edit");
+    std::uint32_t node = nodeAt(i);
+    if (node == kNone) {
+        return;
+    }
+    nodes_[node].wp = wp;
+    recostIncoming(i);
+    recostIncoming(i + 1);
+}
+
+double EditableRoute::prefixLength(std::size_t count) const {
+    double sum = 0.0;
+    std::uint32_t node = root_;
+    while (node != kNone && count > 0) {
+        const Node& n = nodes_[node];
+        std::size_t leftCount = n.left == kNone ? 0 : nodes_[n.left].count;
+        if (count <= leftCount) {
+            node = n.left;
+        } else {
+            sum += (n.left == kNone ? 0.0 : nodes_[n.left].sumLength) + n.length;
+            count -= leftCount + 1;
+            node = n.right;
+        }
+    }
+    return sum;
+}
+
+double EditableRoute::prefixEnergy(std::size_t count) const {
+    double sum = 0.0;
+    std::uint32_t node = root_;
+    while (node != kNone && count > 0) {
+        const Node& n = nodes_[node];
+        std::size_t leftCount = n.left == kNone ? 0 : nodes_[n.left].count;
+        if (count <= leftCount) {
+            node = n.left;
+        } else {
+            sum += (n.left == kNone ? 0.0 : nodes_[n.left].sumEnergy) + n.energy;
+            count -= leftCount + 1;
+            node = n.right;
+        }
+    }
+    return sum;
+}
+
+double EditableRoute::lengthOfLeg(std::size_t i) const {
+    return nodes_[nodeAt(i + 1)].length;
+}
+
+double EditableRoute::energyOfLeg(std::size_t i) const {
+    return nodes_[nodeAt(i + 1)].energy;
+}
+
+double EditableRoute::distanceBetween(std::size_t i, std::size_t j) const {
+    return prefixLength(j + 1) - prefixLength(i + 1);
+}
+
+double EditableRoute::energyBetween(std::size_t i, std::size_t j) const {
+    return prefixEnergy(j + 1) - prefixEnergy(i + 1);
+}
@@ -0,0 +1,116 @@
+#ifndef EAD_EDITABLE_ROUTE_HXX
+#define EAD_EDITABLE_ROUTE_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+// Editable Route with O(log n) Re-Scoring
+// =========================================================
+// A route that keeps its per-segment totals current under edits, for
+// interactive mission editing. Waypoints live in an implicit treap (a
+// randomized balanced tree ordered by position, no stored keys); each
+// node carries its waypoint, the leg arriving at it, and the sums of
+// its subtree:
+//
+//                  +--[wp5 | leg 4->5 | sums of wp0..wp9]--+
+//                  |                                        |
+//   [wp2 | leg 1->2 | sums of wp0..wp4]       [wp8 | leg 7->8 | ...]
+//
+// An edit changes at most two legs (the ones touching the waypoint),
+// and each changed leg refreshes the sums on its root path:
+//
+//   insert(i, wp)   split at i, link the new node, re-cost legs into
+//                   waypoints i and i + 1
+//   erase(i)        unlink, re-cost the leg now arriving at i
+//   move(i, wp)     re-cost legs into i and i + 1
+//
+// all O(log n) expected, as are waypoint(i), distanceBetween() and
+// energyBetween() (prefix descents, like SegmentEnergyProfile's O(1)
+// range queries but on a route that changes). Legs use the
+// per-segment model of EAD_SegmentEnergy.hxx (segmentEnergy());
+// totals are summed in tree order, so they match evaluateSegments()
+// up to rounding.
+//
+// Nodes are stored in one vector and linked by index; erased slots
+// are reused by later inserts.
+// =========================================================
+
+class EditableRoute {
+public:
+    explicit EditableRoute(const SegmentEnergyParams& params, std::uint64_t seed = 0x2545f4914f6cdd1dull);
+    EditableRoute(const std::vector<Waypoint>& waypoints, const SegmentEnergyParams& params,
+                  std::uint64_t seed = 0x2545f4914f6cdd1dull);
+
+    // Replace the whole route, O(n)
+    void assign(const std::vector<Waypoint>& waypoints);
+
+    // Change the model and re-cost every leg, O(n)
+    void setParams(const SegmentEnergyParams& params);
+    const SegmentEnergyParams& params() const { return params_; }
+
+    std::size_t size() const { return root_ == kNone ? 0 : nodes_[root_].count; }
+    bool empty() const { return root_ == kNone; }
+
+    Waypoint waypoint(std::size_t i) const;
+    std::vector<Waypoint> waypoints() const;
+
+    // Edits; positions are waypoint indices before the edit
+    void insert(std::size_t i, const Waypoint& wp); // Before waypoint i; i == size() appends
+    void push_back(const Waypoint& wp) { insert(size(), wp); }
+    void erase(std::size_t i);
+    void move(std::size_t i, const Waypoint& wp);
+
+    double totalDistance() const { return root_ == kNone ? 0.0 : nodes_[root_].sumLength; }
+    double totalEnergy() const { return root_ == kNone ? 0.0 : nodes_[root_].sumEnergy; }
+
+    // Leg i runs from waypoint i to waypoint i + 1 (i < size() - 1)
+    double lengthOfLeg(std::size_t i) const;
+    double energyOfLeg(std::size_t i) const;
+
+    // From waypoint i to waypoint j (i <= j < size())
+    double distanceBetween(std::size_t i, std::size_t j) const;
+    double energyBetween(std::size_t i, std::size_t j) const;
+    double energyRemainingFrom(std::size_t i) const { return totalEnergy() - prefixEnergy(i + 1); }
+
+private:
+    static constexpr std::uint32_t kNone = 0xffffffffu;
+
+    struct Node {
+        Waypoint wp;
+        double length;     // Leg arriving at this waypoint (0 for the first)
+        double energy;
+        double sumLength;  // Over the subtree
+        double sumEnergy;
+        std::uint64_t priority;
+        std::uint32_t left, right;
+        std::uint32_t count; // Subtree size
+    };
+
+    std::uint32_t newNode(const Waypoint& wp);
+    std::uint64_t nextPriority();
+    void pull(std::uint32_t node);
+    void split(std::uint32_t node, std::size_t count, std::uint32_t& left, std::uint32_t& right);
+    std::uint32_t merge(std::uint32_t left, std::uint32_t right);
+    std::uint32_t build(const std::vector<Waypoint>& waypoints);
+    std::uint32_t nodeAt(std::size_t i) const;
+    void cost(Node& node, const Waypoint* previous) const;
+    void recost(std::uint32_t node, std::size_t i, const Waypoint* previous);
+    void recostIncoming(std::size_t i);
+    void recostSubtree(std::uint32_t node, const Waypoint*& previous);
+    double prefixLength(std::size_t count) const;
+    double prefixEnergy(std::size_t count) const;
+    void collect(std::uint32_t node, std::vector<Waypoint>& out) const;
+
+    SegmentEnergyParams params_;
+    double cruise_;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> free_;
+    std::uint32_t root_;
+    std::uint64_t rng_;
+};
+
+#endif // EAD_EDITABLE_ROUTE_HXX
@@ -1,8 +1,33 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <vector>
+#include <memory>
 #include <cmath>
+#include <csignal>
+#include <cstdlib>
 #include <tuple>
 
+#include "EAD_Batch.hxx"
+#include "EAD_Core.hxx"
+#include "EAD_Feasibility.hxx"
+#include "EAD_FleetSim.hxx"
+#include "EAD_MonteCarlo.hxx"
+#include "EAD_ParallelReduce.hxx"
+#include "EAD_Pareto.hxx"
+#include "EAD_PathSoA.hxx"
+#include "EAD_ResultWriter.hxx"
+#include "EAD_RouteCache.hxx"
+#include "EAD_Scheduler.hxx"
+#include "EAD_SegmentEnergy.hxx"
+#include "EAD_Server.hxx"
+#include "EAD_Stats.hxx"
+#include "EAD_Sweep.hxx"
+#include "EAD_ThreadPool.hxx"
+#include "EAD_WaypointFile.hxx"
+#include "EAD_WindField.hxx"
+
 // ASCII Art: Drone Path Optimization and Energy Calculation
 // =========================================================
 // The drone needs to travel between multiple waypoints while minimizing
@@ -25,68 +50,743 @@
 // - Find optimal velocity (v) and altitude (h) to reduce energy usage.
 // =========================================================
 
-// Struct to represent each waypoint in 3D space (x, y, z)
-struct Waypoint {
-    double x, y, z;
+// Command-line modes
+// -----------------------------------------------------------
+//   EAD_EnergyAwareDrone_simulator
+//       Evaluate the built-in demo mission (see main below).
+//
+//   EAD_EnergyAwareDrone_simulator --batch <file | ->
+//       [--threads N] [--window N] [--cache-mb N]
+//       [--output <file | ->] [--format text|csv|jsonl|binary] [--segments]
+//       Evaluate every mission in the file (or stdin) on a thread
+//       pool; see EAD_Batch.hxx for the input and output format.
+//       --cache-mb memoizes route profiles (EAD_RouteCache.hxx) so
+//       repeated routes and shared prefixes are evaluated once.
+//       Results go through a background ResultWriter
+//       (EAD_ResultWriter.hxx); --segments adds one record per leg.
+//
+//   EAD_EnergyAwareDrone_simulator --route <file.eadw>
+//       [--coefficients A B C] [--wind <file.eadf> | --budget E]
+//       Evaluate a memory-mapped binary route (EAD_WaypointFile.hxx),
+//       optionally through a wind / terrain field (EAD_WindField.hxx),
+//       or check it against a battery budget, stopping at the first
+//       waypoint the budget cannot reach (EAD_Feasibility.hxx).
+//
+//   EAD_EnergyAwareDrone_simulator --route <file.eadw> --sweep <file | ->
+//       [--velocity V]
+//       Score the route under every "a b c" line of the file (or
+//       stdin) from one pass of route aggregates (EAD_Sweep.hxx);
+//       prints "a b c velocity energy dE/da dE/db dE/dc" per line.
+//       Velocity is the per-set optimum unless --velocity fixes it.
+//
+//   EAD_EnergyAwareDrone_simulator --route <file.eadw> --pareto
+//       [--speeds V1,V2,...] [--offsets H1,H2,...] [--front N]
+//       [--coefficients A B C] [--threads N]
+//       Pareto front of flight time vs. energy over per-leg speeds
+//       and altitude offsets (EAD_Pareto.hxx); prints "time energy"
+//       per plan, fastest first. Speeds default to 0.5x .. 2x the
+//       energy-optimal speed, offsets to 0 (speed choice only).
+//
+//   EAD_EnergyAwareDrone_simulator --route <file.eadw> --monte-carlo N
+//       [--coefficients A B C] [--spread R] [--wind-speed MEAN SD]
+//       [--velocity V] [--seed S] [--threads N]
+//       Energy distribution over N samples of (a, b, c) around
+//       --coefficients with relative spread R (default 0.1): a and b
+//       log-normal with median A, B and log sigma R (they set the
+//       optimal speed sqrt(b / 2a), so they must keep their sign), c
+//       normal with standard deviation R |C|. Optionally a wind of
+//       normal speed in a uniform direction (EAD_MonteCarlo.hxx).
+//       Reproducible for a given seed whatever the thread count.
+//
+//   EAD_EnergyAwareDrone_simulator --serve <PORT | HOST:PORT | unix:PATH>
+//       [--threads N] [--max-batch N] [--p99-ms X] [--cache-mb N]
+//       Long-lived server answering framed mission requests with
+//       micro-batched evaluation (protocol in EAD_Server.hxx); runs
+//       until SIGINT / SIGTERM.
+//
+//   EAD_EnergyAwareDrone_simulator --fleet <file | ->
+//       [--budget E] [--velocity V] [--stagger S] [--hours H] [--dt S]
+//       [--threads N]
+//       Fly every mission of a batch file (one drone each) together
+//       in the time-stepped fleet simulator (EAD_FleetSim.hxx). Each
+//       drone carries E units (default unlimited) and departs S
+//       seconds after the previous one; prints
+//       "<id> <status> <end_time> <distance> <energy>" per drone.
+//
+//   EAD_EnergyAwareDrone_simulator --schedule <file | ->
+//       [--drones M] [--chargers K] [--budget E] [--charge-rate R]
+//       [--release-interval S] [--coefficients A B C] [--velocity V]
+//       [--threads N]
+//       Assign every mission of a batch file to M identical drones
+//       (--coefficients, battery E, default unlimited, charging at R
+//       units/s on K shared chargers) with the charging-aware
+//       scheduler (EAD_Scheduler.hxx). Mission k is released at
+//       k * S seconds; the line's own coefficients are not used.
+//       Prints "<id> <drone> <charger> <charge_start> <start> <finish>
+//       <energy>" per mission, or "<id> unassigned".
+//
+//   EAD_EnergyAwareDrone_simulator --convert-route <in.txt> <out.eadw>
+//       [--float32]
+//       Convert "x y z" text lines into the binary route format.
+//
+//   Shared options: [--climb X] [--descent X]
+//
+//   Built with -DEAD_ENABLE_STATS=ON, every mode writes timers and
+//   counters to $EAD_STATS at exit and on SIGUSR1 (EAD_Stats.hxx).
+// -----------------------------------------------------------
+struct CommandLine {
+    std::string batchInput;
+    std::string outputPath;
+    ResultWriterOptions output;
+    std::string routeFile;
+    std::string windFile;
+    std::string sweepInput;
+    std::string serveAddress;
+    ServerOptions server;
+    bool pareto;
+    ParetoOptions paretoOptions;
+    size_t monteCarloSamples;
+    double monteCarloSpread;
+    MonteCarloOptions monteCarlo;
+    size_t cacheBytes;
+    std::string fleetInput;
+    std::string scheduleInput;
+    size_t scheduleDrones;
+    size_t scheduleChargers;
+    double chargeRate;
+    double releaseInterval;
+    double fleetHours;
+    double fleetStep;
+    double fleetStagger;
+    std::string convertInput;
+    std::string convertOutput;
+    bool float32;
+    bool hasBudget;
+    double budget;
+    bool hasVelocity;
+    double velocity;
+    EnergyCoefficients coeffs;
+    BatchOptions batch;
+
+    CommandLine()
+        : outputPath("-"), pareto(false), monteCarloSamples(0), monteCarloSpread(0.1), cacheBytes(0), scheduleDrones(10), scheduleChargers(2), chargeRate(100.0), releaseInterval(0.0), fleetHours(24.0), fleetStep(1.0), fleetStagger(0.0), float32(false), hasBudget(false), budget(0.0),
+          hasVelocity(false), velocity(0.0) {
+        coeffs.a = 0.1;
+        coeffs.b = 0.05;
+        coeffs.c = 10.0;
+    }
 };
 
-// Function to calculate Euclidean distance between two waypoints
-// -------------------------------------------------------------
-// Distance Formula: 
-//   distance = sqrt((x2 - x1)^2 + (y2 - y1)^2 + (z2 - z1)^2)
-// -------------------------------------------------------------
-//       (x1, y1, z1)     (x2, y2, z2)
-//           |               |
-//           V               V
-//        <------ Distance ------>
-// -------------------------------------------------------------
-double distance(const Waypoint& wp1, const Waypoint& wp2) {
-    return std::sqrt(std::pow(wp2.x - wp1.x, 2) +
-                     std::pow(wp2.y - wp1.y, 2) +
-                     std::pow(wp2.z - wp1.z, 2));
+static int usage(const char* program) {
+    std::cerr << "usage: " << program << "\n"
+              << "  " << program << " --batch <file|-> [--threads N] [--window N] [--cache-mb N]"
+                 " [--output <file|->] [--format text|csv|jsonl|binary] [--segments]\n"
+              << "  " << program << " --route <file.eadw> [--coefficients A B C] [--wind <file.eadf> | --budget E]\n"
+              << "  " << program << " --route <file.eadw> --sweep <file|-> [--velocity V]\n"
+              << "  " << program << " --route <file.eadw> --pareto [--speeds V1,V2,...] [--offsets H1,H2,...]"
+                 " [--front N]\n"
+              << "  " << program << " --route <file.eadw> --monte-carlo N [--spread R] [--wind-speed MEAN SD]"
+                 " [--velocity V] [--seed S]\n"
+              << "  " << program << " --serve <PORT|HOST:PORT|unix:PATH> [--threads N] [--max-batch N] [--p99-ms X]"
+                 " [--cache-mb N]\n"
+              << "  " << program << " --fleet <file|-> [--budget E] [--velocity V] [--stagger S] [--hours H] [--dt S]"
+                 " [--threads N]\n"
+              << "  " << program << " --schedule <file|-> [--drones M] [--chargers K] [--budget E] [--charge-rate R]"
+                 " [--release-interval S] [--coefficients A B C] [--velocity V] [--threads N]\n"
+              << "  " << program << " --convert-route <in.txt> <out.eadw> [--float32]\n"
+              << "  shared options: [--climb X] [--descent X]\n";
+    return 2;
 }
 
-// Function to calculate energy consumption given velocity and altitude
-// -------------------------------------------------------------
-// Energy Equation: 
-//   E(t) = a * v^2 + b * h + c
-//   where:
-//     * v = velocity (speed)
-//     * h = altitude
-//     * a, b, c = coefficients affecting energy consumption
-// -------------------------------------------------------------
-// Energy depends on:
-// - v^2 (quadratic impact of speed)
-// - h (linear impact of altitude)
-// - c (constant baseline energy use)
-// -------------------------------------------------------------
-double energyConsumption(double velocity, double altitude, double a, double b, double c) {
-    return a * std::pow(velocity, 2) + b * altitude + c;
+// --cache-mb: a route cache shared by every evaluation of the run
+static std::unique_ptr<RouteCache> makeRouteCache(const CommandLine& cmd) {
+    if (cmd.cacheBytes == 0) {
+        return nullptr;
+    }
+    RouteCacheOptions options;
+    options.maxBytes = cmd.cacheBytes;
+    return std::unique_ptr<RouteCache>(new RouteCache(options));
 }
 
-// Function to find optimal velocity for minimal energy consumption
-// -------------------------------------------------------------
-// Partial Derivative of Energy w.r.t velocity (v):
-//   dE/dv = 2 * a * v
-//
-// Solving for minimum energy:
-//   Set dE/dv = 0 --> v = sqrt(b / (2 * a))
-// -------------------------------------------------------------
-//   When a != 0, we solve for the optimal v
-// -------------------------------------------------------------
-std::tuple<double, double> findOptimalSpeedAndAltitude(double a, double b) {
-    double optimalVelocity = 0.0; // Start at zero and increment based on partial derivative
-    double optimalAltitude = 100.0; // Assume a standard altitude for simplicity
+static int runBatchFile(const CommandLine& cmd) {
+    std::ios::sync_with_stdio(false);
+    std::unique_ptr<RouteCache> cache = makeRouteCache(cmd);
+    BatchOptions options = cmd.batch;
+    options.cache = cache.get();
+    std::ifstream file;
+    if (cmd.batchInput != "-") {
+        file.open(cmd.batchInput.c_str());
+        if (!file) {
+            std::cerr << "cannot open " << cmd.batchInput << "\n";
+            return 1;
+        }
+    }
+    ResultWriter writer;
+    std::string error;
+    if (!writer.open(cmd.outputPath, cmd.output, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    size_t failures = runBatch(cmd.batchInput == "-" ? std::cin : file, writer, options);
+    if (!writer.close(error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Same totals with every leg sampled through the wind / terrain field
+static int runRouteInWind(const CommandLine& cmd, const MappedRoute& route, const SegmentEnergyParams& params) {
+    WindField field;
+    std::string error;
+    if (!field.open(cmd.windFile, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    WindLegParams wind;
+    wind.energy = params;
+    WindRouteTotals totals = route.encoding() == kWaypointFloat32
+                                 ? evaluateRouteInWind(route.xf(), route.yf(), route.zf(), route.size(), field, wind)
+                                 : evaluateRouteInWind(route.x(), route.y(), route.z(), route.size(), field, wind);
+
+    std::cout << "Waypoints: " << route.size()
+              << (route.encoding() == kWaypointFloat32 ? " (float32)" : " (float64)") << "\n";
+    std::cout << "Total Distance: " << totals.distance << " meters\n";
+    std::cout << "Air Distance: " << totals.airDistance << " meters\n";
+    std::cout << "Minimum Terrain Clearance: " << totals.minimumClearance << " meters\n";
+    std::cout << "Optimal Velocity: " << params.velocity << " m/s\n";
+    if (totals.infeasibleLegs > 0) {
+        std::cout << "Infeasible Legs: " << totals.infeasibleLegs << " (wind exceeds airspeed)\n";
+        return 1;
+    }
+    std::cout << "Estimated Total Energy: " << totals.energy << " units\n";
+    return 0;
+}
+
+// Early-exit walk; exit status 1 when the budget runs out
+static int runRouteFeasibility(const CommandLine& cmd, const MappedRoute& route, const SegmentEnergyParams& params) {
+    FeasibilityResult result = route.encoding() == kWaypointFloat32
+        ? checkFeasibility(route.xf(), route.yf(), route.zf(), route.size(), params, cmd.budget)
+        : checkFeasibility(route.x(), route.y(), route.z(), route.size(), params, cmd.budget);
+
+    std::cout << "Waypoints: " << route.size()
+              << (route.encoding() == kWaypointFloat32 ? " (float32)" : " (float64)") << "\n";
+    std::cout << "Energy Budget: " << cmd.budget << " units\n";
+    if (result.feasible) {
+        std::cout << "Feasible: yes (" << result.energy << " units used)\n";
+        return 0;
+    }
+    std::cout << "Feasible: no (first unreachable waypoint " << result.firstUnreachable << ", "
+              << result.legsEvaluated << " of " << route.size() - 1 << " legs evaluated)\n";
+    return 1;
+}
+
+// One pass for the aggregates, then O(1) per coefficient line
+static int runRouteSweep(const CommandLine& cmd, const MappedRoute& route) {
+    std::ifstream file;
+    if (cmd.sweepInput != "-") {
+        file.open(cmd.sweepInput.c_str());
+        if (!file) {
+            std::cerr << "cannot open " << cmd.sweepInput << "\n";
+            return 1;
+        }
+    }
+    std::istream& in = cmd.sweepInput == "-" ? std::cin : file;
+
+    RouteAggregates aggregates = route.encoding() == kWaypointFloat32
+        ? computeRouteAggregates(route.xf(), route.yf(), route.zf(), route.size())
+        : computeRouteAggregates(route.x(), route.y(), route.z(), route.size());
+    SweepOptions options;
+    options.velocityMode = cmd.hasVelocity ? kSweepFixedVelocity : kSweepOptimalVelocity;
+    options.velocity = cmd.velocity;
+    options.climbCoefficient = cmd.batch.climbCoefficient;
+    options.descentCoefficient = cmd.batch.descentCoefficient;
+
+    std::ios::sync_with_stdio(false);
+    std::cout.precision(10);
+    std::string line;
+    size_t lineNumber = 0;
+    size_t failures = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        std::istringstream fields(line);
+        EnergyCoefficients coeffs;
+        std::string first;
+        if (!(fields >> first) || first[0] == '#') {
+            continue;
+        }
+        fields.clear();
+        fields.str(line);
+        if (!(fields >> coeffs.a >> coeffs.b >> coeffs.c)) {
+            std::cerr << cmd.sweepInput << ":" << lineNumber << ": expected coefficients a b c\n";
+            ++failures;
+            continue;
+        }
+        SweepResult result = scoreCoefficients(aggregates, coeffs, options);
+        std::cout << coeffs.a << ' ' << coeffs.b << ' ' << coeffs.c << ' ' << result.velocity << ' '
+                  << result.energy << ' ' << result.energyPerA << ' ' << result.energyPerB << ' '
+                  << result.energyPerC << '\n';
+    }
+    std::cout.flush();
+    return failures == 0 ? 0 : 1;
+}
+
+// --speeds / --offsets: comma-separated numbers
+static bool parseNumberList(const char* text, std::vector<double>& values) {
+    values.clear();
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        char* end = nullptr;
+        double value = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0') {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+static int runRoutePareto(const CommandLine& cmd, const MappedRoute& route) {
+    std::unique_ptr<ThreadPool> pool;
+    ParetoOptions options = cmd.paretoOptions;
+    options.climbCoefficient = cmd.batch.climbCoefficient;
+    options.descentCoefficient = cmd.batch.descentCoefficient;
+    if (cmd.batch.threads > 0) {
+        pool.reset(new ThreadPool(cmd.batch.threads));
+        options.pool = pool.get();
+    }
+    std::vector<ParetoPoint> front = route.encoding() == kWaypointFloat32
+        ? paretoFront(route.xf(), route.yf(), route.zf(), route.size(), cmd.coeffs, options)
+        : paretoFront(route.x(), route.y(), route.z(), route.size(), cmd.coeffs, options);
+    if (front.empty()) {
+        std::cerr << "no positive speed to fly the route at\n";
+        return 1;
+    }
+    std::ios::sync_with_stdio(false);
+    std::cout.precision(10);
+    for (const ParetoPoint& point : front) {
+        std::cout << point.time << ' ' << point.energy << '\n';
+    }
+    std::cout.flush();
+    return 0;
+}
+
+// One aggregate pass, then every sample is O(heading bins)
+static int runRouteMonteCarlo(const CommandLine& cmd, const MappedRoute& route) {
+    MonteCarloRoute aggregates = route.encoding() == kWaypointFloat32
+        ? makeMonteCarloRoute(route.xf(), route.yf(), route.zf(), route.size())
+        : makeMonteCarloRoute(route.x(), route.y(), route.z(), route.size());
+    std::unique_ptr<ThreadPool> pool;
+    MonteCarloOptions options = cmd.monteCarlo;
+    options.samples = cmd.monteCarloSamples;
+    options.a = UncertainValue(kUncertainLogNormal, cmd.coeffs.a, cmd.monteCarloSpread);
+    options.b = UncertainValue(kUncertainLogNormal, cmd.coeffs.b, cmd.monteCarloSpread);
+    options.c = UncertainValue(kUncertainNormal, cmd.coeffs.c, cmd.monteCarloSpread * std::fabs(cmd.coeffs.c));
+    options.velocity = cmd.hasVelocity ? cmd.velocity : 0.0;
+    options.climbCoefficient = cmd.batch.climbCoefficient;
+    options.descentCoefficient = cmd.batch.descentCoefficient;
+    if (cmd.batch.threads > 0) {
+        pool.reset(new ThreadPool(cmd.batch.threads));
+        options.pool = pool.get();
+    }
+    MonteCarloResult result = runMonteCarlo(aggregates, options);
+
+    std::cout << "Waypoints: " << route.size()
+              << (route.encoding() == kWaypointFloat32 ? " (float32)" : " (float64)") << "\n";
+    std::cout << "Samples: " << result.samples << " (" << result.infeasible << " infeasible)\n";
+    std::cout << "Mean Energy: " << result.mean << " units (sd " << result.standardDeviation << ")\n";
+    std::cout << "Energy Range: " << result.minimum << " .. " << result.maximum << " units\n";
+    std::cout << "Energy p50 / p95 / p99: " << result.p50 << " / " << result.p95 << " / " << result.p99
+              << " units\n";
+    return 0;
+}
+
+// Distance and energy passes straight over the mapped file
+static int runRouteFile(const CommandLine& cmd) {
+    MappedRoute route;
+    std::string error;
+    if (!route.open(cmd.routeFile, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    double optimalVelocity, optimalAltitude;
+    std::tie(optimalVelocity, optimalAltitude) = findOptimalSpeedAndAltitude(cmd.coeffs.a, cmd.coeffs.b);
+    SegmentEnergyParams params = {cmd.coeffs, optimalVelocity,
+                                  cmd.batch.climbCoefficient, cmd.batch.descentCoefficient};
+    if (!cmd.windFile.empty()) {
+        return runRouteInWind(cmd, route, params);
+    }
+    if (cmd.hasBudget) {
+        return runRouteFeasibility(cmd, route, params);
+    }
+    if (!cmd.sweepInput.empty()) {
+        return runRouteSweep(cmd, route);
+    }
+    if (cmd.pareto) {
+        return runRoutePareto(cmd, route);
+    }
+    if (cmd.monteCarloSamples > 0) {
+        return runRouteMonteCarlo(cmd, route);
+    }
+    SegmentEnergyTotals totals = route.evaluate(params);
+
+    std::cout << "Waypoints: " << route.size()
+              << (route.encoding() == kWaypointFloat32 ? " (float32)" : " (float64)") << "\n";
+    std::cout << "Total Distance: " << totals.distance << " meters\n";
+    std::cout << "Optimal Velocity: " << optimalVelocity << " m/s\n";
+    std::cout << "Estimated Total Energy: " << totals.energy << " units\n";
+    return 0;
+}
+
+static const char* fleetStatusName(FleetDroneStatus status) {
+    switch (status) {
+    case kDroneWaiting: return "waiting";
+    case kDroneFlying: return "flying";
+    case kDroneArrived: return "arrived";
+    case kDroneDepleted: return "depleted";
+    }
+    return "unknown";
+}
+
+// Whole batch file as one fleet, stepped until everyone is done
+static int runFleet(const CommandLine& cmd) {
+    std::ifstream file;
+    if (cmd.fleetInput != "-") {
+        file.open(cmd.fleetInput.c_str());
+        if (!file) {
+            std::cerr << "cannot open " << cmd.fleetInput << "\n";
+            return 1;
+        }
+    }
+    std::istream& in = cmd.fleetInput == "-" ? std::cin : file;
+
+    std::vector<std::string> ids;
+    std::vector<WaypointSoA> routes;
+    std::vector<FleetDroneSpec> drones;
+    std::string line, error;
+    Mission mission;
+    size_t lineNumber = 0;
+    size_t failures = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        if (!parseMissionLine(line, mission, error)) {
+            std::cerr << cmd.fleetInput << ":" << lineNumber << ": " << error << "\n";
+            ++failures;
+            continue;
+        }
+        FleetDroneSpec spec;
+        spec.route = routes.size();
+        spec.coeffs = mission.coeffs;
+        spec.velocity = cmd.hasVelocity ? cmd.velocity : 0.0;
+        spec.battery = cmd.hasBudget ? cmd.budget : HUGE_VAL;
+        spec.departureTime = cmd.fleetStagger * double(drones.size());
+        ids.push_back(mission.id);
+        routes.push_back(toSoA(mission.waypoints));
+        drones.push_back(spec);
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    FleetSimOptions options;
+    options.climbCoefficient = cmd.batch.climbCoefficient;
+    options.descentCoefficient = cmd.batch.descentCoefficient;
+    if (cmd.batch.threads > 0) {
+        pool.reset(new ThreadPool(cmd.batch.threads));
+        options.pool = pool.get();
+    }
+    if (!validateFleetSpecs(routes, drones, error)) {
+        std::cerr << cmd.fleetInput << ": " << error << "\n";
+        return 1;
+    }
+    FleetSimulator fleet(routes, drones, options);
+    fleet.run(cmd.fleetHours * 3600.0, cmd.fleetStep);
+
+    std::ios::sync_with_stdio(false);
+    std::cout.precision(10);
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        FleetDroneStatus status = fleet.status(i);
+        bool stopped = status == kDroneArrived || status == kDroneDepleted;
+        std::cout << ids[i] << ' ' << fleetStatusName(status) << ' ' << (stopped ? fleet.endTime(i) : fleet.time())
+                  << ' ' << fleet.distanceFlown(i) << ' ' << fleet.energyUsed(i) << '\n';
+    }
+    std::cout.flush();
+
+    FleetCounts counts = fleet.counts();
+    std::cerr << "Simulated " << fleet.size() << " drones for " << fleet.time() << " s: " << counts.arrived
+              << " arrived, " << counts.depleted << " depleted, " << counts.flying + counts.waiting
+              << " still out\n";
+    return failures == 0 ? 0 : 1;
+}
+
+static MissionServer* activeServer = nullptr;
+
+static void stopServer(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+static int runServer(const CommandLine& cmd) {
+    ServerOptions options = cmd.server;
+    options.address = cmd.serveAddress;
+    options.threads = cmd.batch.threads;
+    std::unique_ptr<RouteCache> cache = makeRouteCache(cmd);
+    options.evaluation = cmd.batch;
+    options.evaluation.cache = cache.get();
+    MissionServer server(options);
+    std::string error;
+    if (!server.start(error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    activeServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    std::cerr << "Serving missions on " << options.address << "\n";
+    server.run();
+    activeServer = nullptr;
+
+    ServerStats stats = server.stats();
+    std::cerr << "Served " << stats.requests << " requests in " << stats.batches << " batches\n";
+    return 0;
+}
+
+static int convertRoute(const CommandLine& cmd) {
+    std::ifstream in(cmd.convertInput.c_str());
+    if (!in) {
+        std::cerr << "cannot open " << cmd.convertInput << "\n";
+        return 1;
+    }
+    std::vector<Waypoint> waypoints;
+    Waypoint wp;
+    while (in >> wp.x >> wp.y >> wp.z) {
+        waypoints.push_back(wp);
+    }
+    if (!in.eof()) {
+        std::cerr << cmd.convertInput << ": waypoint " << waypoints.size() << " is not an x y z triple\n";
+        return 1;
+    }
+    std::string error;
+    if (!writeWaypointFile(cmd.convertOutput, waypoints, cmd.float32 ? kWaypointFloat32 : kWaypointFloat64, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << waypoints.size() << " waypoints to " << cmd.convertOutput << "\n";
+    return 0;
+}
 
-    // If 'a' is non-zero, find the optimal speed that minimizes energy
-    if (a != 0) {
-        optimalVelocity = std::sqrt(b / (2 * a)); // Simplified from partial derivative
+// Batch file missions assigned to a homogeneous fleet with chargers
+static int runSchedule(const CommandLine& cmd) {
+    std::ifstream file;
+    if (cmd.scheduleInput != "-") {
+        file.open(cmd.scheduleInput.c_str());
+        if (!file) {
+            std::cerr << "cannot open " << cmd.scheduleInput << "\n";
+            return 1;
+        }
+    }
+    std::istream& in = cmd.scheduleInput == "-" ? std::cin : file;
+
+    std::unique_ptr<ThreadPool> pool;
+    SchedulerOptions options;
+    options.chargers = cmd.scheduleChargers;
+    options.climbCoefficient = cmd.batch.climbCoefficient;
+    options.descentCoefficient = cmd.batch.descentCoefficient;
+    if (cmd.batch.threads > 0) {
+        pool.reset(new ThreadPool(cmd.batch.threads));
+        options.pool = pool.get();
     }
+    ScheduledDrone spec;
+    spec.coeffs = cmd.coeffs;
+    spec.velocity = cmd.hasVelocity ? cmd.velocity : 0.0;
+    spec.capacity = cmd.hasBudget ? cmd.budget : HUGE_VAL;
+    spec.charge = spec.capacity;
+    spec.chargeRate = cmd.chargeRate;
+    spec.availableFrom = 0.0;
+    MissionScheduler scheduler(std::vector<ScheduledDrone>(cmd.scheduleDrones, spec), options);
+
+    std::vector<std::string> ids;
+    std::string line, error;
+    Mission mission;
+    size_t lineNumber = 0;
+    size_t failures = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        if (!parseMissionLine(line, mission, error)) {
+            std::cerr << cmd.scheduleInput << ":" << lineNumber << ": " << error << "\n";
+            ++failures;
+            continue;
+        }
+        ScheduledMission scheduled;
+        scheduled.route = toSoA(mission.waypoints);
+        scheduled.release = cmd.releaseInterval * double(ids.size());
+        ids.push_back(mission.id);
+        scheduler.submit(std::move(scheduled));
+    }
+    scheduler.update();
+
+    std::ios::sync_with_stdio(false);
+    std::cout.precision(10);
+    for (size_t i = 0; i < scheduler.missionCount(); ++i) {
+        const MissionAssignment& a = scheduler.assignment(i);
+        if (a.drone < 0) {
+            std::cout << ids[i] << " unassigned\n";
+            continue;
+        }
+        std::cout << ids[i] << ' ' << a.drone << ' ' << a.charger << ' ' << a.chargeStart << ' ' << a.start << ' '
+                  << a.finish << ' ' << a.energy << '\n';
+    }
+    std::cout.flush();
 
-    return std::make_tuple(optimalVelocity, optimalAltitude);
+    ScheduleSummary summary = scheduler.summary();
+    std::cerr << "Scheduled " << summary.assigned << " of " << summary.missions << " missions on "
+              << cmd.scheduleDrones << " drones: makespan " << summary.makespan << " s, " << summary.charges
+              << " charges (" << summary.chargingTime << " s), " << summary.unassigned << " unassigned\n";
+    return failures == 0 && summary.unassigned == 0 ? 0 : 1;
 }
 
-int main() {
+static int runCommandLine(int argc, char* argv[]) {
+    CommandLine cmd;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        int values = argc - i - 1;
+        if (arg == "--batch" && values >= 1) {
+            cmd.batchInput = argv[++i];
+        } else if (arg == "--output" && values >= 1) {
+            cmd.outputPath = argv[++i];
+        } else if (arg == "--format" && values >= 1) {
+            if (!parseResultFormat(argv[++i], cmd.output.format)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--segments") {
+            cmd.output.segments = true;
+        } else if (arg == "--route" && values >= 1) {
+            cmd.routeFile = argv[++i];
+        } else if (arg == "--wind" && values >= 1) {
+            cmd.windFile = argv[++i];
+        } else if (arg == "--serve" && values >= 1) {
+            cmd.serveAddress = argv[++i];
+        } else if (arg == "--schedule" && values >= 1) {
+            cmd.scheduleInput = argv[++i];
+        } else if (arg == "--drones" && values >= 1) {
+            cmd.scheduleDrones = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--chargers" && values >= 1) {
+            cmd.scheduleChargers = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--charge-rate" && values >= 1) {
+            cmd.chargeRate = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--release-interval" && values >= 1) {
+            cmd.releaseInterval = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--fleet" && values >= 1) {
+            cmd.fleetInput = argv[++i];
+        } else if (arg == "--hours" && values >= 1) {
+            cmd.fleetHours = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--dt" && values >= 1) {
+            cmd.fleetStep = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--stagger" && values >= 1) {
+            cmd.fleetStagger = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--max-batch" && values >= 1) {
+            cmd.server.maxBatch = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--p99-ms" && values >= 1) {
+            cmd.server.p99TargetSeconds = 1e-3 * std::strtod(argv[++i], nullptr);
+        } else if (arg == "--sweep" && values >= 1) {
+            cmd.sweepInput = argv[++i];
+        } else if (arg == "--pareto") {
+            cmd.pareto = true;
+        } else if (arg == "--speeds" && values >= 1) {
+            if (!parseNumberList(argv[++i], cmd.paretoOptions.velocities)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--offsets" && values >= 1) {
+            if (!parseNumberList(argv[++i], cmd.paretoOptions.altitudeOffsets)) {
+                return usage(argv[0]);
+            }
+        } else if (arg == "--front" && values >= 1) {
+            cmd.paretoOptions.maxFrontSize = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--monte-carlo" && values >= 1) {
+            cmd.monteCarloSamples = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--spread" && values >= 1) {
+            cmd.monteCarloSpread = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--wind-speed" && values >= 2) {
+            double mean = std::strtod(argv[++i], nullptr);
+            double deviation = std::strtod(argv[++i], nullptr);
+            cmd.monteCarlo.windSpeed = UncertainValue(kUncertainNormal, mean, deviation);
+        } else if (arg == "--seed" && values >= 1) {
+            cmd.monteCarlo.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--velocity" && values >= 1) {
+            cmd.hasVelocity = true;
+            cmd.velocity = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--budget" && values >= 1) {
+            cmd.hasBudget = true;
+            cmd.budget = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--convert-route" && values >= 2) {
+            cmd.convertInput = argv[++i];
+            cmd.convertOutput = argv[++i];
+        } else if (arg == "--float32") {
+            cmd.float32 = true;
+        } else if (arg == "--coefficients" && values >= 3) {
+            cmd.coeffs.a = std::strtod(argv[++i], nullptr);
+            cmd.coeffs.b = std::strtod(argv[++i], nullptr);
+            cmd.coeffs.c = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--threads" && values >= 1) {
+            cmd.batch.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--cache-mb" && values >= 1) {
+            cmd.cacheBytes = static_cast<size_t>(std::strtod(argv[++i], nullptr) * 1024 * 1024);
+        } else if (arg == "--window" && values >= 1) {
+            cmd.batch.window = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--climb" && values >= 1) {
+            cmd.batch.climbCoefficient = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--descent" && values >= 1) {
+            cmd.batch.descentCoefficient = std::strtod(argv[++i], nullptr);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    if (!cmd.batchInput.empty()) {
+        return runBatchFile(cmd);
+    }
+    if (!cmd.serveAddress.empty()) {
+        return runServer(cmd);
+    }
+    if (!cmd.scheduleInput.empty()) {
+        return runSchedule(cmd);
+    }
+    if (!cmd.fleetInput.empty()) {
+        if (!(cmd.fleetStep > 0.0)) {
+            return usage(argv[0]);
+        }
+        return runFleet(cmd);
+    }
+    if (!cmd.routeFile.empty()) {
+        int extras = (cmd.hasBudget ? 1 : 0) + (cmd.windFile.empty() ? 0 : 1) + (cmd.sweepInput.empty() ? 0 : 1) +
+                     (cmd.pareto ? 1 : 0) + (cmd.monteCarloSamples > 0 ? 1 : 0);
+        if (extras > 1) {
+            return usage(argv[0]);
+        }
+        return runRouteFile(cmd);
+    }
+    if (!cmd.convertInput.empty()) {
+        return convertRoute(cmd);
+    }
+    return usage(argv[0]);
+}
+
+int main(int argc, char* argv[]) {
+    // Before the thread pool starts, so its workers inherit the signal mask
+    installStatsReporter();
+
+    if (argc > 1) {
+        return runCommandLine(argc, argv);
+    }
+
     // Define the coefficients for the energy model
     // -----------------------------------------------------------
     // a = impact of velocity on energy (squared effect)
@@ -97,6 +797,13 @@ int main() {
     double b = 0.05; // Altitude impact coefficient
     double c = 10.0; // Baseline energy use
 
+    // Climb / descent terms of the per-segment model
+    // -----------------------------------------------------------
+    // Charged per meter of altitude gained / lost on each leg
+    // -----------------------------------------------------------
+    double climbCoefficient = 0.5;   // Energy per meter climbed
+    double descentCoefficient = 0.0; // Energy per meter descended
+
     // Define waypoints for the drone to visit
     // -----------------------------------------------------------
     // Example waypoints the drone must navigate through:
@@ -119,10 +826,14 @@ int main() {
     // -----------------------------------------------------------
     // distance_total = distance(wp1, wp2) + distance(wp2, wp3) + ...
     // -----------------------------------------------------------
-    double totalDistance = 0.0;
-    for (size_t i = 0; i < waypoints.size() - 1; ++i) {
-        totalDistance += distance(waypoints[i], waypoints[i + 1]);
-    }
+    // The route is converted to the SoA layout once so the batched
+    // kernel (AVX2 / NEON / scalar, see EAD_PathSoA.hxx) can sum all
+    // segments in a single pass. Long routes are split into chunks
+    // summed on the thread pool (EAD_ParallelReduce.hxx); short ones
+    // like this stay on the calling thread.
+    // -----------------------------------------------------------
+    WaypointSoA path = toSoA(waypoints);
+    double totalDistance = totalPathLengthParallel(path);
 
     // Find the optimal speed and altitude based on the energy model
     // -----------------------------------------------------------
@@ -132,14 +843,19 @@ int main() {
     double optimalVelocity, optimalAltitude;
     std::tie(optimalVelocity, optimalAltitude) = findOptimalSpeedAndAltitude(a, b);
 
-    // Calculate total energy consumption for the entire path
+    // Calculate total energy consumption leg by leg
     // -----------------------------------------------------------
-    // Total Energy = Energy per meter * Total Distance
+    // Each leg flies at the optimal velocity with its altitude
+    // interpolated between the waypoint z values at either end:
+    //   E_leg = d * (a * v^2 + b * mean(h) + c) + climb/descent
     // -----------------------------------------------------------
-    // Since energy depends on v and h:
-    //   energy = a * v^2 + b * h + c
+    // Total Energy = E_leg(1) + E_leg(2) + ...
+    // The profile also keeps prefix sums, so the energy remaining
+    // from any waypoint is profile.energyRemainingFrom(i).
     // -----------------------------------------------------------
-    double totalEnergy = energyConsumption(optimalVelocity, optimalAltitude, a, b, c) * totalDistance;
+    SegmentEnergyParams params = {{a, b, c}, optimalVelocity, climbCoefficient, descentCoefficient};
+    SegmentEnergyProfile profile = evaluateSegments(path, params);
+    double totalEnergy = profile.totalEnergy();
 
     // Display results to understand the drone's optimal path and energy usage
     // -----------------------------------------------------------
@@ -0,0 +1,426 @@
+#include "EAD_EnergyBatch.hxx"
+
+#include <limits>
+
+#include "EAD_CpuDispatch.hxx"
+
+#if defined(EAD_SIMD_AVX2) || defined(EAD_SIMD_AVX512)
+#include <immintrin.h>
+#endif
+#if defined(EAD_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+// Scalar reference
+// -------------------------------------------------------------
+//   E = a * (v * v) + b * h + c
+// The SIMD kernels evaluate the same expression in the same order.
+// -------------------------------------------------------------
+static inline double energyScalar(double v, double h, const EnergyCoefficients& k) {
+    return k.a * (v * v) + k.b * h + k.c;
+}
+
+void energyConsumptionBatchScalar(const double* velocity, const double* altitude, std::size_t n,
+                                  const EnergyCoefficients& coeffs, double* out) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = energyScalar(velocity[i], altitude[i], coeffs);
+    }
+}
+
+EnergySample energyArgminBatchScalar(const double* velocity, const double* altitude, std::size_t n,
+                                     const EnergyCoefficients& coeffs) {
+    EnergySample best = {0, std::numeric_limits<double>::infinity()};
+    for (size_t i = 0; i < n; ++i) {
+        double e = energyScalar(velocity[i], altitude[i], coeffs);
+        if (e < best.energy) {
+            best.index = i;
+            best.energy = e;
+        }
+    }
+    return best;
+}
+
+// One grid row: fixed altitude, so b * h + c is a constant 'base'
+static EnergySample energyArgminRowScalar(const double* velocity, std::size_t nv, double a, double base) {
+    EnergySample best = {0, std::numeric_limits<double>::infinity()};
+    for (size_t i = 0; i < nv; ++i) {
+        double e = a * (velocity[i] * velocity[i]) + base;
+        if (e < best.energy) {
+            best.index = i;
+            best.energy = e;
+        }
+    }
+    return best;
+}
+
+EnergyGridSample energyArgminGridScalar(const double* velocity, std::size_t nv,
+                                        const double* altitude, std::size_t nh,
+                                        const EnergyCoefficients& coeffs) {
+    EnergyGridSample best = {0, 0, std::numeric_limits<double>::infinity()};
+    for (size_t j = 0; j < nh; ++j) {
+        EnergySample row = energyArgminRowScalar(velocity, nv, coeffs.a, coeffs.b * altitude[j] + coeffs.c);
+        if (row.energy < best.energy) {
+            best.velocityIndex = row.index;
+            best.altitudeIndex = j;
+            best.energy = row.energy;
+        }
+    }
+    return best;
+}
+
+#if defined(EAD_SIMD_AVX2)
+
+// AVX2 kernels: 4 samples per iteration
+// -------------------------------------------------------------
+// The argmin keeps one (minimum, index) pair per lane:
+//   mask   = e < minE           (strict, so the first index wins)
+//   minE   = blend(minE, e, mask)
+//   minIdx = blend(minIdx, idx, mask)
+// and reduces the 4 lanes once at the end. Indices are carried as
+// doubles, which is exact for any n below 2^53.
+// -------------------------------------------------------------
+EAD_TARGET_AVX2 static inline EnergySample reduceLanes(__m256d minE, __m256d minIdx) {
+    double e[4], idx[4];
+    _mm256_storeu_pd(e, minE);
+    _mm256_storeu_pd(idx, minIdx);
+    EnergySample best = {size_t(idx[0]), e[0]};
+    for (int lane = 1; lane < 4; ++lane) {
+        if (e[lane] < best.energy || (e[lane] == best.energy && size_t(idx[lane]) < best.index)) {
+            best.energy = e[lane];
+            best.index = size_t(idx[lane]);
+        }
+    }
+    return best;
+}
+
+EAD_TARGET_AVX2 static void energyConsumptionBatchAvx2(const double* velocity, const double* altitude,
+                                                       std::size_t n, const EnergyCoefficients& coeffs,
+                                                       double* out) {
+    const __m256d a = _mm256_set1_pd(coeffs.a);
+    const __m256d b = _mm256_set1_pd(coeffs.b);
+    const __m256d c = _mm256_set1_pd(coeffs.c);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(velocity + i);
+        __m256d h = _mm256_loadu_pd(altitude + i);
+        __m256d e = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a, _mm256_mul_pd(v, v)), _mm256_mul_pd(b, h)), c);
+        _mm256_storeu_pd(out + i, e);
+    }
+    energyConsumptionBatchScalar(velocity + i, altitude + i, n - i, coeffs, out + i);
+}
+
+EAD_TARGET_AVX2 static EnergySample energyArgminBatchAvx2(const double* velocity, const double* altitude,
+                                                          std::size_t n, const EnergyCoefficients& coeffs) {
+    const __m256d a = _mm256_set1_pd(coeffs.a);
+    const __m256d b = _mm256_set1_pd(coeffs.b);
+    const __m256d c = _mm256_set1_pd(coeffs.c);
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d idx = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+    __m256d minE = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d minIdx = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(velocity + i);
+        __m256d h = _mm256_loadu_pd(altitude + i);
+        __m256d e = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a, _mm256_mul_pd(v, v)), _mm256_mul_pd(b, h)), c);
+        __m256d mask = _mm256_cmp_pd(e, minE, _CMP_LT_OQ);
+        minE = _mm256_blendv_pd(minE, e, mask);
+        minIdx = _mm256_blendv_pd(minIdx, idx, mask);
+        idx = _mm256_add_pd(idx, step);
+    }
+    EnergySample best = reduceLanes(minE, minIdx);
+    EnergySample tail = energyArgminBatchScalar(velocity + i, altitude + i, n - i, coeffs);
+    if (tail.energy < best.energy) {
+        best.index = i + tail.index;
+        best.energy = tail.energy;
+    }
+    return best;
+}
+
+EAD_TARGET_AVX2 static EnergySample energyArgminRowAvx2(const double* velocity, std::size_t nv, double coeffA,
+                                                        double coeffBase) {
+    const __m256d a = _mm256_set1_pd(coeffA);
+    const __m256d base = _mm256_set1_pd(coeffBase);
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d idx = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+    __m256d minE = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d minIdx = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= nv; i += 4) {
+        __m256d v = _mm256_loadu_pd(velocity + i);
+        __m256d e = _mm256_add_pd(_mm256_mul_pd(a, _mm256_mul_pd(v, v)), base);
+        __m256d mask = _mm256_cmp_pd(e, minE, _CMP_LT_OQ);
+        minE = _mm256_blendv_pd(minE, e, mask);
+        minIdx = _mm256_blendv_pd(minIdx, idx, mask);
+        idx = _mm256_add_pd(idx, step);
+    }
+    EnergySample best = reduceLanes(minE, minIdx);
+    EnergySample tail = energyArgminRowScalar(velocity + i, nv - i, coeffA, coeffBase);
+    if (tail.energy < best.energy) {
+        best.index = i + tail.index;
+        best.energy = tail.energy;
+    }
+    return best;
+}
+
+#endif
+
+#if defined(EAD_SIMD_AVX512)
+
+// AVX-512 kernels: 8 samples per iteration, same lane-wise argmin as
+// AVX2 with the compare going to a mask register
+EAD_TARGET_AVX512 static inline EnergySample reduceLanes(__m512d minE, __m512d minIdx) {
+    double e[8], idx[8];
+    _mm512_storeu_pd(e, minE);
+    _mm512_storeu_pd(idx, minIdx);
+    EnergySample best = {size_t(idx[0]), e[0]};
+    for (int lane = 1; lane < 8; ++lane) {
+        if (e[lane] < best.energy || (e[lane] == best.energy && size_t(idx[lane]) < best.index)) {
+            best.energy = e[lane];
+            best.index = size_t(idx[lane]);
+        }
+    }
+    return best;
+}
+
+EAD_TARGET_AVX512 static void energyConsumptionBatchAvx512(const double* velocity, const double* altitude,
+                                                           std::size_t n, const EnergyCoefficients& coeffs,
+                                                           double* out) {
+    const __m512d a = _mm512_set1_pd(coeffs.a);
+    const __m512d b = _mm512_set1_pd(coeffs.b);
+    const __m512d c = _mm512_set1_pd(coeffs.c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_loadu_pd(velocity + i);
+        __m512d h = _mm512_loadu_pd(altitude + i);
+        __m512d e = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(a, _mm512_mul_pd(v, v)), _mm512_mul_pd(b, h)), c);
+        _mm512_storeu_pd(out + i, e);
+    }
+    energyConsumptionBatchScalar(velocity + i, altitude + i, n - i, coeffs, out + i);
+}
+
+EAD_TARGET_AVX512 static EnergySample energyArgminBatchAvx512(const double* velocity, const double* altitude,
+                                                              std::size_t n, const EnergyCoefficients& coeffs) {
+    const __m512d a = _mm512_set1_pd(coeffs.a);
+    const __m512d b = _mm512_set1_pd(coeffs.b);
+    const __m512d c = _mm512_set1_pd(coeffs.c);
+    const __m512d step = _mm512_set1_pd(8.0);
+    __m512d idx = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+    __m512d minE = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+    __m512d minIdx = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d v = _mm512_loadu_pd(velocity + i);
+        __m512d h = _mm512_loadu_pd(altitude + i);
+        __m512d e = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(a, _mm512_mul_pd(v, v)), _mm512_mul_pd(b, h)), c);
+        __mmask8 mask = _mm512_cmp_pd_mask(e, minE, _CMP_LT_OQ);
+        minE = _mm512_mask_blend_pd(mask, minE, e);
+        minIdx = _mm512_mask_blend_pd(mask, minIdx, idx);
+        idx = _mm512_add_pd(idx, step);
+    }
+    EnergySample best = reduceLanes(minE, minIdx);
+    EnergySample tail = energyArgminBatchScalar(velocity + i, altitude + i, n - i, coeffs);
+    if (tail.energy < best.energy) {
+        best.index = i + tail.index;
+        best.energy = tail.energy;
+    }
+    return best;
+}
+
+EAD_TARGET_AVX512 static EnergySample energyArgminRowAvx512(const double* velocity, std::size_t nv, double coeffA,
+                                                            double coeffBase) {
+    const __m512d a = _mm512_set1_pd(coeffA);
+    const __m512d base = _mm512_set1_pd(coeffBase);
+    const __m512d step = _mm512_set1_pd(8.0);
+    __m512d idx = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+    __m512d minE = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+    __m512d minIdx = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= nv; i += 8) {
+        __m512d v = _mm512_loadu_pd(velocity + i);
+        __m512d e = _mm512_add_pd(_mm512_mul_pd(a, _mm512_mul_pd(v, v)), base);
+        __mmask8 mask = _mm512_cmp_pd_mask(e, minE, _CMP_LT_OQ);
+        minE = _mm512_mask_blend_pd(mask, minE, e);
+        minIdx = _mm512_mask_blend_pd(mask, minIdx, idx);
+        idx = _mm512_add_pd(idx, step);
+    }
+    EnergySample best = reduceLanes(minE, minIdx);
+    EnergySample tail = energyArgminRowScalar(velocity + i, nv - i, coeffA, coeffBase);
+    if (tail.energy < best.energy) {
+        best.index = i + tail.index;
+        best.energy = tail.energy;
+    }
+    return best;
+}
+
+#endif
+
+#if defined(EAD_SIMD_NEON)
+
+// NEON kernels: 2 samples per iteration, same lane-wise argmin as AVX2
+static inline EnergySample reduceLanes(float64x2_t minE, float64x2_t minIdx) {
+    double e[2], idx[2];
+    vst1q_f64(e, minE);
+    vst1q_f64(idx, minIdx);
+    EnergySample best = {size_t(idx[0]), e[0]};
+    if (e[1] < best.energy || (e[1] == best.energy && idx[1] < idx[0])) {
+        best.index = size_t(idx[1]);
+        best.energy = e[1];
+    }
+    return best;
+}
+
+static void energyConsumptionBatchNeon(const double* velocity, const double* altitude, std::size_t n,
+                                       const EnergyCoefficients& coeffs, double* out) {
+    const float64x2_t a = vdupq_n_f64(coeffs.a);
+    const float64x2_t b = vdupq_n_f64(coeffs.b);
+    const float64x2_t c = vdupq_n_f64(coeffs.c);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vld1q_f64(velocity + i);
+        float64x2_t h = vld1q_f64(altitude + i);
+        float64x2_t e = vaddq_f64(vaddq_f64(vmulq_f64(a, vmulq_f64(v, v)), vmulq_f64(b, h)), c);
+        vst1q_f64(out + i, e);
+    }
+    energyConsumptionBatchScalar(velocity + i, altitude + i, n - i, coeffs, out + i);
+}
+
+static EnergySample energyArgminBatchNeon(const double* velocity, const double* altitude, std::size_t n,
+                                          const EnergyCoefficients& coeffs) {
+    const float64x2_t a = vdupq_n_f64(coeffs.a);
+    const float64x2_t b = vdupq_n_f64(coeffs.b);
+    const float64x2_t c = vdupq_n_f64(coeffs.c);
+    const float64x2_t step = vdupq_n_f64(2.0);
+    const double firstIdx[2] = {0.0, 1.0};
+    float64x2_t idx = vld1q_f64(firstIdx);
+    float64x2_t minE = vdupq_n_f64(std::numeric_limits<double>::infinity());
+    float64x2_t minIdx = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vld1q_f64(velocity + i);
+        float64x2_t h = vld1q_f64(altitude + i);
+        float64x2_t e = vaddq_f64(vaddq_f64(vmulq_f64(a, vmulq_f64(v, v)), vmulq_f64(b, h)), c);
+        uint64x2_t mask = vcltq_f64(e, minE);
+        minE = vbslq_f64(mask, e, minE);
+        minIdx = vbslq_f64(mask, idx, minIdx);
+        idx = vaddq_f64(idx, step);
+    }
+    EnergySample best = reduceLanes(minE, minIdx);
+    EnergySample tail = energyArgminBatchScalar(velocity + i, altitude + i, n - i, coeffs);
+    if (tail.energy < best.energy) {
+        best.index = i + tail.index;
+        best.energy = tail.energy;
+    }
+    return best;
+}
+
+static EnergySample energyArgminRowNeon(const double* velocity, std::size_t nv, double coeffA, double coeffBase) {
+    const float64x2_t a = vdupq_n_f64(coeffA);
+    const float64x2_t base = vdupq_n_f64(coeffBase);
+    const float64x2_t step = vdupq_n_f64(2.0);
+    const double firstIdx[2] = {0.0, 1.0};
+    float64x2_t idx = vld1q_f64(firstIdx);
+    float64x2_t minE = vdupq_n_f64(std::numeric_limits<double>::infinity());
+    float64x2_t minIdx = vdupq_n_f64(0.0);
+    size_t i = 0;
+    for (; i + 2 <= nv; i += 2) {
+        float64x2_t v = vld1q_f64(velocity + i);
+        float64x2_t e = vaddq_f64(vmulq_f64(a, vmulq_f64(v, v)), base);
+        uint64x2_t mask = vcltq_f64(e, minE);
+        minE = vbslq_f64(mask, e, minE);
+        minIdx = vbslq_f64(mask, idx, minIdx);
+        idx = vaddq_f64(idx, step);
+    }
+    EnergySample best = reduceLanes(minE, minIdx);
+    EnergySample tail = energyArgminRowScalar(velocity + i, nv - i, coeffA, coeffBase);
+    if (tail.energy < best.energy) {
+        best.index = i + tail.index;
+        best.energy = tail.energy;
+    }
+    return best;
+}
+
+#endif
+
+// Kernel selection (EAD_CpuDispatch.hxx)
+void energyConsumptionBatch(const double* velocity, const double* altitude, std::size_t n,
+                            const EnergyCoefficients& coeffs, double* out) {
+    switch (simdLevel()) {
+#if defined(EAD_SIMD_AVX512)
+    case kSimdAvx512:
+        energyConsumptionBatchAvx512(velocity, altitude, n, coeffs, out);
+        return;
+#endif
+#if defined(EAD_SIMD_AVX2)
+    case kSimdAvx2:
+        energyConsumptionBatchAvx2(velocity, altitude, n, coeffs, out);
+        return;
+#endif
+#if defined(EAD_SIMD_NEON)
+    case kSimdNeon:
+        energyConsumptionBatchNeon(velocity, altitude, n, coeffs, out);
+        return;
+#endif
+    default:
+        energyConsumptionBatchScalar(velocity, altitude, n, coeffs, out);
+        return;
+    }
+}
+
+EnergySample energyArgminBatch(const double* velocity, const double* altitude, std::size_t n,
+                               const EnergyCoefficients& coeffs) {
+    switch (simdLevel()) {
+#if defined(EAD_SIMD_AVX512)
+    case kSimdAvx512:
+        return energyArgminBatchAvx512(velocity, altitude, n, coeffs);
+#endif
+#if defined(EAD_SIMD_AVX2)
+    case kSimdAvx2:
+        return energyArgminBatchAvx2(velocity, altitude, n, coeffs);
+#endif
+#if defined(EAD_SIMD_NEON)
+    case kSimdNeon:
+        return energyArgminBatchNeon(velocity, altitude, n, coeffs);
+#endif
+    default:
+        return energyArgminBatchScalar(velocity, altitude, n, coeffs);
+    }
+}
+
+static EnergySample energyArgminRow(SimdLevel level, const double* velocity, std::size_t nv, double coeffA,
+                                    double coeffBase) {
+    switch (level) {
+#if defined(EAD_SIMD_AVX512)
+    case kSimdAvx512:
+        return energyArgminRowAvx512(velocity, nv, coeffA, coeffBase);
+#endif
+#if defined(EAD_SIMD_AVX2)
+    case kSimdAvx2:
+        return energyArgminRowAvx2(velocity, nv, coeffA, coeffBase);
+#endif
+#if defined(EAD_SIMD_NEON)
+    case kSimdNeon:
+        return energyArgminRowNeon(velocity, nv, coeffA, coeffBase);
+#endif
+    default:
+        return energyArgminRowScalar(velocity, nv, coeffA, coeffBase);
+    }
+}
+
+const char* energyKernelName() { return simdLevelName(simdLevel()); }
+
+EnergyGridSample energyArgminGrid(const double* velocity, std::size_t nv,
+                                  const double* altitude, std::size_t nh,
+                                  const EnergyCoefficients& coeffs) {
+    EnergyGridSample best = {0, 0, std::numeric_limits<double>::infinity()};
+    SimdLevel level = simdLevel();
+    for (size_t j = 0; j < nh; ++j) {
+        EnergySample row = energyArgminRow(level, velocity, nv, coeffs.a, coeffs.b * altitude[j] + coeffs.c);
+        if (row.energy < best.energy) {
+            best.velocityIndex = row.index;
+            best.altitudeIndex = j;
+            best.energy = row.energy;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,71 @@
+#ifndef EAD_ENERGY_BATCH_HXX
+#define EAD_ENERGY_BATCH_HXX
+
+#include <cstddef>
+
+#include "EAD_Core.hxx"
+
+// Bulk Energy Evaluation over (velocity, altitude) Samples
+// =========================================================
+// Same equation as energyConsumption():
+//   E = a * v^2 + b * h + c
+// evaluated for whole arrays of samples at once. The SIMD kernels
+// process 8 (AVX-512), 4 (AVX2) or 2 (NEON) samples per
+// instruction and never call std::pow.
+// =========================================================
+
+// Element-wise evaluation
+// -------------------------------------------------------------
+//   out[i] = a * v[i]^2 + b * h[i] + c,  0 <= i < n
+// -------------------------------------------------------------
+void energyConsumptionBatch(const double* velocity, const double* altitude, std::size_t n,
+                            const EnergyCoefficients& coeffs, double* out);
+
+// Result of an argmin scan: index of the cheapest sample and its energy.
+// For n == 0 the index is 0 and the energy is +infinity.
+struct EnergySample {
+    std::size_t index;
+    double energy;
+};
+
+// Fused evaluate + argmin over paired samples (v[i], h[i])
+// -------------------------------------------------------------
+// Returns the first index with the smallest energy; nothing is
+// written to memory, so the scan is bound by the two input streams.
+// -------------------------------------------------------------
+EnergySample energyArgminBatch(const double* velocity, const double* altitude, std::size_t n,
+                               const EnergyCoefficients& coeffs);
+
+// Result of a grid scan: cheapest (velocity, altitude) grid cell
+struct EnergyGridSample {
+    std::size_t velocityIndex;
+    std::size_t altitudeIndex;
+    double energy;
+};
+
+// Fused evaluate + argmin over the full velocity x altitude grid
+// -------------------------------------------------------------
+//           v[0]   v[1]   ...   v[nv-1]
+//   h[0]    E00    E01    ...
+//   h[1]    E10    E11    ...
+//   ...
+// Ties go to the lowest altitude index, then the lowest velocity index.
+// -------------------------------------------------------------
+EnergyGridSample energyArgminGrid(const double* velocity, std::size_t nv,
+                                  const double* altitude, std::size_t nh,
+                                  const EnergyCoefficients& coeffs);
+
+// Scalar reference kernels
+void energyConsumptionBatchScalar(const double* velocity, const double* altitude, std::size_t n,
+                                  const EnergyCoefficients& coeffs, double* out);
+EnergySample energyArgminBatchScalar(const double* velocity, const double* altitude, std::size_t n,
+                                     const EnergyCoefficients& coeffs);
+EnergyGridSample energyArgminGridScalar(const double* velocity, std::size_t nv,
+                                        const double* altitude, std::size_t nh,
+                                        const EnergyCoefficients& coeffs);
+
+// Name of the kernel selected for this CPU ("avx512", "avx2", "neon" or
+// "scalar"; see EAD_CpuDispatch.hxx)
+const char* energyKernelName();
+
+#endif // EAD_ENERGY_BATCH_HXX
@@ -0,0 +1,249 @@
+#ifndef EAD_ENERGY_MODEL_HXX
+#define EAD_ENERGY_MODEL_HXX
+
+#include <cmath>
+#include <cstddef>
+#include <tuple>
+
+#include "EAD_Core.hxx"
+#include "EAD_PathSoA.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+// Compile-Time Energy Model Policies
+// =========================================================
+// energyConsumption() hard-codes one model shape with runtime a, b, c.
+// An energy model here is any type with these inline members:
+//
+//   double speedCost(double v, double h) const;
+//       The speed-dependent part of E (a * v^2 for the legacy model).
+//
+//   double energyPerMeter(double v, double h) const;
+//       E(v, h) for one meter flown at speed v and altitude h.
+//
+//   double meanEnergyPerMeter(double v, double h0, double h1) const;
+//       E averaged over a leg whose altitude goes linearly h0 -> h1.
+//
+//   std::tuple<double, double> optimalSpeedAndAltitude() const;
+//       The model's closed-form cruise point (see below).
+//
+// The evaluators are templates over the model, so each airframe gets
+// its own fully inlined inner loop: no virtual calls, no std::pow.
+// Coefficients known at build time can be baked in with the Fixed*
+// models, whose members are constexpr.
+//
+// Optimal speed convention
+// -------------------------------------------------------------
+// findOptimalSpeedAndAltitude(a, b) returns v = sqrt(b / (2a)), i.e.
+// the speed at which the speed cost a * v^2 equals b / 2. The models
+// keep that convention: v solves speedCost(v, h) = b / 2 at the
+// standard altitude of 100 m, so QuadraticEnergyModel reproduces the
+// legacy function exactly.
+// =========================================================
+
+inline constexpr double kStandardAltitude = 100.0;
+
+// E = a * v^2 + b * h + c  (same shape as energyConsumption())
+struct QuadraticEnergyModel {
+    double a, b, c;
+
+    constexpr double speedCost(double v, double /*h*/) const { return a * (v * v); }
+    constexpr double energyPerMeter(double v, double h) const { return a * (v * v) + b * h + c; }
+
+    // Linear in h, so the leg average is the value at the mean altitude
+    constexpr double meanEnergyPerMeter(double v, double h0, double h1) const {
+        return energyPerMeter(v, 0.5 * (h0 + h1));
+    }
+
+    std::tuple<double, double> optimalSpeedAndAltitude() const {
+        return findOptimalSpeedAndAltitude(a, b);
+    }
+};
+
+// E = a * v^2 + d * v^3 + b * h + c  (profile + induced drag airframes)
+struct DragEnergyModel {
+    double a, d, b, c;
+
+    constexpr double speedCost(double v, double /*h*/) const { return (a + d * v) * (v * v); }
+    constexpr double energyPerMeter(double v, double h) const { return speedCost(v, h) + b * h + c; }
+
+    constexpr double meanEnergyPerMeter(double v, double h0, double h1) const {
+        return energyPerMeter(v, 0.5 * (h0 + h1));
+    }
+
+    // Newton on a v^2 + d v^3 - b / 2 = 0, started from the quadratic answer
+    std::tuple<double, double> optimalSpeedAndAltitude() const {
+        double v = 0.0;
+        if (a != 0 || d != 0) {
+            double target = 0.5 * b;
+            v = a > 0 ? std::sqrt(target / a) : std::cbrt(target / d);
+            for (int iteration = 0; iteration < 20; ++iteration) {
+                double f = (a + d * v) * (v * v) - target;
+                double df = (2.0 * a + 3.0 * d * v) * v;
+                if (df == 0) {
+                    break;
+                }
+                double step = f / df;
+                v -= step;
+                if (std::fabs(step) <= 1e-12 * v) {
+                    break;
+                }
+            }
+        }
+        return std::make_tuple(v, kStandardAltitude);
+    }
+};
+
+// Air-density correction on top of another model
+// -------------------------------------------------------------
+//   rho(h) / rho0 = exp(-h / H)      (isothermal atmosphere, H ~ 8500 m)
+//   E(v, h) = rho(h)/rho0 * speedCost(v, h) + (base E without speed cost)
+//
+// Thinner air lowers drag, so the speed term shrinks with altitude.
+// The leg average uses Simpson's rule; its error is O((dz / H)^4),
+// negligible for any climb a drone makes on one leg.
+// -------------------------------------------------------------
+template <typename Base>
+struct DensityCorrectedModel {
+    Base base;
+    double scaleHeight;
+
+    double densityRatio(double h) const { return std::exp(-h / scaleHeight); }
+
+    double speedCost(double v, double h) const { return densityRatio(h) * base.speedCost(v, h); }
+    double energyPerMeter(double v, double h) const {
+        double speed = base.speedCost(v, h);
+        return base.energyPerMeter(v, h) - speed + densityRatio(h) * speed;
+    }
+
+    double meanEnergyPerMeter(double v, double h0, double h1) const {
+        return (energyPerMeter(v, h0) + 4.0 * energyPerMeter(v, 0.5 * (h0 + h1)) + energyPerMeter(v, h1)) / 6.0;
+    }
+
+    std::tuple<double, double> optimalSpeedAndAltitude() const {
+        double v, h;
+        std::tie(v, h) = base.optimalSpeedAndAltitude();
+        // speedCost is scaled by the density ratio; for a quadratic
+        // speed cost that moves the balance point by 1 / sqrt(ratio)
+        // (exact for the quadratic models, first-order for drag ones)
+        return std::make_tuple(v / std::sqrt(densityRatio(h)), h);
+    }
+};
+
+// Build-time coefficients
+// -------------------------------------------------------------
+//   struct DemoAirframe {
+//       static constexpr double a = 0.1, b = 0.05, c = 10.0;
+//   };
+//   FixedQuadraticEnergyModel<DemoAirframe> model;
+//
+// The coefficients fold into the generated code as immediates.
+// -------------------------------------------------------------
+template <typename Coefficients>
+struct FixedQuadraticEnergyModel {
+    static constexpr double a = Coefficients::a;
+    static constexpr double b = Coefficients::b;
+    static constexpr double c = Coefficients::c;
+
+    constexpr double speedCost(double v, double /*h*/) const { return a * (v * v); }
+    constexpr double energyPerMeter(double v, double h) const { return a * (v * v) + b * h + c; }
+    constexpr double meanEnergyPerMeter(double v, double h0, double h1) const {
+        return energyPerMeter(v, 0.5 * (h0 + h1));
+    }
+
+    std::tuple<double, double> optimalSpeedAndAltitude() const {
+        return findOptimalSpeedAndAltitude(a, b);
+    }
+};
+
+template <typename Coefficients>
+struct FixedDragEnergyModel {
+    static constexpr double a = Coefficients::a;
+    static constexpr double d = Coefficients::d;
+    static constexpr double b = Coefficients::b;
+    static constexpr double c = Coefficients::c;
+
+    constexpr double speedCost(double v, double /*h*/) const { return (a + d * v) * (v * v); }
+    constexpr double energyPerMeter(double v, double h) const { return speedCost(v, h) + b * h + c; }
+    constexpr double meanEnergyPerMeter(double v, double h0, double h1) const {
+        return energyPerMeter(v, 0.5 * (h0 + h1));
+    }
+
+    std::tuple<double, double> optimalSpeedAndAltitude() const {
+        DragEnergyModel runtime = {a, d, b, c};
+        return runtime.optimalSpeedAndAltitude();
+    }
+};
+
+// Model-generic counterpart of findOptimalSpeedAndAltitude(a, b)
+template <typename Model>
+inline std::tuple<double, double> findOptimalSpeedAndAltitude(const Model& model) {
+    return model.optimalSpeedAndAltitude();
+}
+
+// Per-leg flight settings that are independent of the model
+struct LegFlightParams {
+    double velocity;
+    double climbCoefficient;   // Energy per meter of altitude gained
+    double descentCoefficient; // Energy per meter of altitude lost
+};
+
+// Model-specialized leg energy (same structure as legEnergy())
+template <typename Model>
+inline double modelLegEnergy(const Model& model, double length, double z0, double z1,
+                             const LegFlightParams& flight) {
+    double dz = z1 - z0;
+    double verticalEnergy = dz > 0.0 ? flight.climbCoefficient * dz : -flight.descentCoefficient * dz;
+    return length * model.meanEnergyPerMeter(flight.velocity, z0, z1) + verticalEnergy;
+}
+
+// Model-specialized evaluateSegments(): per-leg values plus prefix sums
+template <typename Model>
+void evaluateSegments(const WaypointSoA& path, const Model& model, const LegFlightParams& flight,
+                      SegmentEnergyProfile& profile) {
+    std::size_t n = path.size();
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    profile.length.resize(segments);
+    profile.energy.resize(segments);
+    profile.cumulativeDistance.resize(n);
+    profile.cumulativeEnergy.resize(n);
+    if (n == 0) {
+        return;
+    }
+    segmentLengths(path, profile.length.data());
+
+    const double* z = path.z.data();
+    double distanceSum = 0.0;
+    double energySum = 0.0;
+    profile.cumulativeDistance[0] = 0.0;
+    profile.cumulativeEnergy[0] = 0.0;
+    for (std::size_t i = 0; i < segments; ++i) {
+        double e = modelLegEnergy(model, profile.length[i], z[i], z[i + 1], flight);
+        profile.energy[i] = e;
+        distanceSum += profile.length[i];
+        energySum += e;
+        profile.cumulativeDistance[i + 1] = distanceSum;
+        profile.cumulativeEnergy[i + 1] = energySum;
+    }
+}
+
+// Model-specialized evaluateSegmentTotals() over raw coordinate planes
+template <typename Model, typename T>
+SegmentEnergyTotals evaluateSegmentTotals(const T* x, const T* y, const T* z, std::size_t n,
+                                          const Model& model, const LegFlightParams& flight) {
+    const std::size_t kBlock = 1024;
+    double lengths[kBlock];
+    SegmentEnergyTotals totals = {0.0, 0.0};
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    for (std::size_t begin = 0; begin < segments; begin += kBlock) {
+        std::size_t count = segments - begin < kBlock ? segments - begin : kBlock;
+        segmentLengths(x + begin, y + begin, z + begin, count + 1, lengths);
+        for (std::size_t k = 0; k < count; ++k) {
+            std::size_t i = begin + k;
+            totals.distance += lengths[k];
+            totals.energy += modelLegEnergy(model, lengths[k], double(z[i]), double(z[i + 1]), flight);
+        }
+    }
+    return totals;
+}
+
+#endif // EAD_ENERGY_MODEL_HXX
@@ -0,0 +1,167 @@
+#include "EAD_Feasibility.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "EAD_Stats.hxx"
+#include "EAD_ThreadPool.hxx"
+
+namespace {
+
+// Small blocks keep the work wasted past the failing leg low
+const std::size_t kFeasibilityBlock = 256;
+
+// Call visit(i, E_i) for waypoints i = 1 .. n - 1 until it returns
+// false; returns the number of legs whose energy was computed
+template <typename T, typename Visit>
+std::size_t walkRoute(const T* x, const T* y, const T* z, std::size_t n, const SegmentEnergyParams& params,
+                      Visit visit) {
+    double lengths[kFeasibilityBlock];
+    const double cruise = cruiseEnergyPerMeter(params.velocity, params);
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    double energy = 0.0;
+    for (std::size_t begin = 0; begin < segments; begin += kFeasibilityBlock) {
+        std::size_t count = std::min(kFeasibilityBlock, segments - begin);
+        segmentLengths(x + begin, y + begin, z + begin, count + 1, lengths);
+        for (std::size_t k = 0; k < count; ++k) {
+            std::size_t i = begin + k;
+            energy += legEnergy(lengths[k], double(z[i]), double(z[i + 1]), cruise, params);
+            if (!visit(i + 1, energy)) {
+                return i + 1;
+            }
+        }
+    }
+    return segments;
+}
+
+template <typename T>
+FeasibilityResult checkFeasibilityImpl(const T* x, const T* y, const T* z, std::size_t n,
+                                       const SegmentEnergyParams& params, double budget) {
+    EAD_STATS_TIMER("feasibility");
+    FeasibilityResult result = {true, n, 0.0, 0};
+    if (n > 0 && budget < 0.0) {
+        result.feasible = false;
+        result.firstUnreachable = 0;
+        return result;
+    }
+    double total = 0.0;
+    result.legsEvaluated = walkRoute(x, y, z, n, params, [&](std::size_t i, double energy) {
+        total = energy;
+        if (energy > budget) {
+            result.feasible = false;
+            result.firstUnreachable = i;
+            return false;
+        }
+        return true;
+    });
+    result.energy = total;
+    EAD_STATS_COUNT("feasibility_legs", result.legsEvaluated);
+    return result;
+}
+
+// O(1) lower bound on a route's total energy (see the header), or
+// -infinity when the model does not allow one
+double energyLowerBound(const WaypointSoA& path, const SegmentEnergyParams& params, double minimumAltitude) {
+    std::size_t n = path.size();
+    double b = params.coeffs.b;
+    if (n < 2 || b < 0.0 || params.climbCoefficient + params.descentCoefficient < 0.0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    double perMeter = cruiseEnergyPerMeter(params.velocity, params);
+    if (b > 0.0) {
+        if (!std::isfinite(minimumAltitude)) {
+            return -std::numeric_limits<double>::infinity();
+        }
+        perMeter += b * minimumAltitude;
+    }
+    if (perMeter < 0.0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    Waypoint first = path[0];
+    Waypoint last = path[n - 1];
+    double dz = last.z - first.z;
+    double vertical = dz > 0.0 ? params.climbCoefficient * dz : -params.descentCoefficient * dz;
+    return distance(first, last) * perMeter + vertical;
+}
+
+} // namespace
+
+FeasibilityResult checkFeasibility(const double* x, const double* y, const double* z, std::size_t n,
+                                   const SegmentEnergyParams& params, double budget) {
+    return checkFeasibilityImpl(x, y, z, n, params, budget);
+}
+
+FeasibilityResult checkFeasibility(const float* x, const float* y, const float* z, std::size_t n,
+                                   const SegmentEnergyParams& params, double budget) {
+    return checkFeasibilityImpl(x, y, z, n, params, budget);
+}
+
+FeasibilityResult checkFeasibility(const WaypointSoA& path, const SegmentEnergyParams& params, double budget) {
+    return checkFeasibilityImpl(path.x.data(), path.y.data(), path.z.data(), path.size(), params, budget);
+}
+
+FleetScreenOptions::FleetScreenOptions()
+    : minimumAltitude(-std::numeric_limits<double>::infinity()), pool(nullptr) {}
+
+void screenRoutes(const std::vector<WaypointSoA>& routes, const SegmentEnergyParams& params,
+                  const std::vector<double>& budgets, FleetScreen& screen, const FleetScreenOptions& options) {
+    EAD_STATS_TIMER("fleet_screen");
+    std::size_t drones = budgets.size();
+    screen.drones = drones;
+    screen.firstUnreachable.assign(routes.size() * drones, 0);
+    screen.waypointCounts.resize(routes.size());
+    screen.legsEvaluated.assign(routes.size(), 0);
+    screen.prunedRoutes = 0;
+
+    // Drones by ascending budget; the walk retires them in this order
+    std::vector<std::size_t> order(drones);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::sort(order.begin(), order.end(), [&](std::size_t l, std::size_t r) { return budgets[l] < budgets[r]; });
+    double largest = drones ? budgets[order.back()] : -std::numeric_limits<double>::infinity();
+
+    std::vector<unsigned char> pruned(routes.size(), 0);
+    auto body = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            const WaypointSoA& path = routes[r];
+            std::size_t n = path.size();
+            std::size_t* row = screen.firstUnreachable.data() + r * drones;
+            screen.waypointCounts[r] = n;
+            if (drones == 0) {
+                continue;
+            }
+            if (energyLowerBound(path, params, options.minimumAltitude) > largest) {
+                std::fill(row, row + drones, FleetScreen::kPruned);
+                pruned[r] = 1;
+                continue;
+            }
+            // Waypoint 0 needs no energy: only negative budgets fail there
+            std::size_t cursor = 0;
+            while (n > 0 && cursor < drones && budgets[order[cursor]] < 0.0) {
+                row[order[cursor++]] = 0;
+            }
+            if (cursor < drones) {
+                screen.legsEvaluated[r] = walkRoute(path.x.data(), path.y.data(), path.z.data(), n, params,
+                                                    [&](std::size_t i, double energy) {
+                    while (cursor < drones && energy > budgets[order[cursor]]) {
+                        row[order[cursor++]] = i;
+                    }
+                    return cursor < drones;
+                });
+            }
+            for (; cursor < drones; ++cursor) {
+                row[order[cursor]] = n;
+            }
+        }
+    };
+    if (routes.size() > 1) {
+        ThreadPool& pool = options.pool ? *options.pool : defaultThreadPool();
+        pool.parallelFor(0, routes.size(), 16, body);
+    } else {
+        body(0, routes.size());
+    }
+    for (unsigned char p : pruned) {
+        screen.prunedRoutes += p;
+    }
+}
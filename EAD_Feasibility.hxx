@@ -0,0 +1,93 @@
+#ifndef EAD_FEASIBILITY_HXX
+#define EAD_FEASIBILITY_HXX
+
+#include <cstddef>
+#include <vector>
+
+#include "EAD_PathSoA.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+class ThreadPool;
+
+// Battery Feasibility Queries
+// =========================================================
+// "Can this drone fly the route with 'budget' energy to spend?"
+// (budget = charge - reserve). With E_i the cumulative leg energy from
+// waypoint 0 to waypoint i (per-segment model, E_0 = 0):
+//
+//   first unreachable waypoint = min { i : E_i > budget }   (n if none)
+//
+// The walk stops at that waypoint, so an infeasible route costs only
+// the legs up to where the battery runs out. Legs are processed in
+// blocks of 256 through the batched segmentLengths() kernel, and E_i
+// accumulates in the same order as evaluateSegmentTotals(), so a
+// feasible route reports exactly the same total.
+//
+// Fleet screening
+// -------------------------------------------------------------
+// screenRoutes() answers the query for every (route, drone) pair.
+// Budgets are sorted once; each route is walked a single time while a
+// cursor retires drones whose budget E_i has passed, smallest budget
+// first:
+//
+//   budgets (sorted):  20   35   80   120
+//   E_i along route:   0 .. 21 .. 36 ........ 119 | done (n)
+//                      ^ drone 20 fails here
+//                           ^ drone 35 fails here
+//
+// The walk stops as soon as the largest budget is exceeded. Before
+// walking, an O(1) lower bound on the route's total energy is checked
+// against the largest budget, and a route that cannot possibly fit is
+// rejected without touching its legs:
+//
+//   E_total >= chord(wp0, wp_n-1) * (a v^2 + c + b * minimumAltitude)
+//            + climb * max(dz, 0) + descent * max(-dz, 0),  dz = z_n-1 - z_0
+//
+// The bound needs b >= 0, a non-negative per-meter cost, climb +
+// descent >= 0, and every waypoint at or above minimumAltitude; when
+// minimumAltitude is unset (-infinity, the default) the prune is only
+// used with b == 0. A pruned route is infeasible for every drone; its
+// entries are kPruned since none of its legs were walked.
+// =========================================================
+
+struct FeasibilityResult {
+    bool feasible;
+    std::size_t firstUnreachable; // Waypoint count when feasible
+    double energy;                // E at firstUnreachable, or the route total
+    std::size_t legsEvaluated;
+};
+
+FeasibilityResult checkFeasibility(const double* x, const double* y, const double* z, std::size_t n,
+                                   const SegmentEnergyParams& params, double budget);
+FeasibilityResult checkFeasibility(const float* x, const float* y, const float* z, std::size_t n,
+                                   const SegmentEnergyParams& params, double budget);
+FeasibilityResult checkFeasibility(const WaypointSoA& path, const SegmentEnergyParams& params, double budget);
+
+struct FleetScreenOptions {
+    double minimumAltitude; // Lower bound on every waypoint z; enables the prune for b > 0
+    ThreadPool* pool;       // nullptr = defaultThreadPool()
+
+    FleetScreenOptions();
+};
+
+struct FleetScreen {
+    static constexpr std::size_t kPruned = static_cast<std::size_t>(-1);
+
+    std::size_t drones;
+    // firstUnreachable[r * drones + d] for route r and drone d (the
+    // route's waypoint count if feasible, kPruned if the bound rejected it)
+    std::vector<std::size_t> firstUnreachable;
+    std::vector<std::size_t> waypointCounts; // Per route
+    std::vector<std::size_t> legsEvaluated;  // Per route
+    std::size_t prunedRoutes;
+
+    bool feasible(std::size_t route, std::size_t drone) const {
+        return firstUnreachable[route * drones + drone] == waypointCounts[route];
+    }
+};
+
+void screenRoutes(const std::vector<WaypointSoA>& routes, const SegmentEnergyParams& params,
+                  const std::vector<double>& budgets, FleetScreen& screen,
+                  const FleetScreenOptions& options = FleetScreenOptions());
+
+#endif // EAD_FEASIBILITY_HXX
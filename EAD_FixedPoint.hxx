@@ -0,0 +1,191 @@
+#ifndef EAD_FIXED_POINT_HXX
+#define EAD_FIXED_POINT_HXX
+
+#include <cstdint>
+
+#include "EAD_Core.hxx"
+
+// Q16.16 Fixed-Point Scalar
+// =========================================================
+// For flight controllers without a double (or any) FPU. A Fixed16 is a
+// signed 32-bit integer counting units of q = 2^-16:
+//
+//   bit  31   30 ............ 16   15 ............. 0
+//      | sign |  integer part     |  fraction        |
+//
+//   value = raw / 65536,  range [-32768, 32768),  q = 1.53e-5
+//
+// Conversions and products round to nearest (error <= q / 2), sums
+// are exact, and every result saturates at the range ends instead of
+// wrapping, so an out-of-range route degrades to a pinned value rather
+// than garbage. Products and quotients use a 64-bit intermediate
+// (one SMULL / SDIV-class sequence on Cortex-M4).
+//
+// The range is the one to design around: coordinates should be taken
+// relative to a local origin (convertWaypoints() in EAD_Precision.hxx
+// does that), and per-leg values (length, energy per meter, leg energy)
+// must stay below 32768. Route totals are summed in a 64-bit
+// Fixed16Accumulator, which holds any realistic mission.
+//
+// distance() has its own overload here: squaring widens to Q32.32 in
+// 64 bits and an integer square root brings the result back, so legs
+// up to the full range do not overflow the way the generic template
+// would after a single 181 m axis delta.
+// =========================================================
+
+class Fixed16 {
+public:
+    static constexpr std::int32_t kOne = 1 << 16;
+
+    constexpr Fixed16() : raw_(0) {}
+    explicit constexpr Fixed16(double value) : raw_(saturate(roundToRaw(value))) {}
+    explicit constexpr Fixed16(int value) : raw_(saturate(std::int64_t(value) * kOne)) {}
+
+    static constexpr Fixed16 fromRaw(std::int32_t raw) {
+        Fixed16 f;
+        f.raw_ = raw;
+        return f;
+    }
+
+    // Saturating conversion of a 64-bit raw value
+    static constexpr Fixed16 fromWideRaw(std::int64_t raw) { return fromRaw(saturate(raw)); }
+
+    constexpr std::int32_t raw() const { return raw_; }
+    constexpr double toDouble() const { return double(raw_) / kOne; }
+    constexpr float toFloat() const { return float(raw_) / kOne; }
+
+    constexpr Fixed16 operator-() const { return fromWideRaw(-std::int64_t(raw_)); }
+
+    friend constexpr Fixed16 operator+(Fixed16 a, Fixed16 b) {
+        return fromWideRaw(std::int64_t(a.raw_) + b.raw_);
+    }
+    friend constexpr Fixed16 operator-(Fixed16 a, Fixed16 b) {
+        return fromWideRaw(std::int64_t(a.raw_) - b.raw_);
+    }
+    friend constexpr Fixed16 operator*(Fixed16 a, Fixed16 b) {
+        return fromWideRaw(roundShift(std::int64_t(a.raw_) * b.raw_));
+    }
+    friend constexpr Fixed16 operator/(Fixed16 a, Fixed16 b) {
+        if (b.raw_ == 0) {
+            return fromRaw(a.raw_ < 0 ? INT32_MIN : INT32_MAX);
+        }
+        // Round to nearest: add half the divisor before truncating
+        std::int64_t n = std::int64_t(a.raw_) * kOne;
+        std::int64_t d = b.raw_;
+        std::int64_t half = (d < 0 ? -d : d) / 2;
+        return fromWideRaw(((n < 0) == (d < 0) ? n + half : n - half) / d);
+    }
+
+    Fixed16& operator+=(Fixed16 b) { return *this = *this + b; }
+    Fixed16& operator-=(Fixed16 b) { return *this = *this - b; }
+    Fixed16& operator*=(Fixed16 b) { return *this = *this * b; }
+    Fixed16& operator/=(Fixed16 b) { return *this = *this / b; }
+
+    friend constexpr bool operator==(Fixed16 a, Fixed16 b) { return a.raw_ == b.raw_; }
+    friend constexpr bool operator!=(Fixed16 a, Fixed16 b) { return a.raw_ != b.raw_; }
+    friend constexpr bool operator<(Fixed16 a, Fixed16 b) { return a.raw_ < b.raw_; }
+    friend constexpr bool operator>(Fixed16 a, Fixed16 b) { return a.raw_ > b.raw_; }
+    friend constexpr bool operator<=(Fixed16 a, Fixed16 b) { return a.raw_ <= b.raw_; }
+    friend constexpr bool operator>=(Fixed16 a, Fixed16 b) { return a.raw_ >= b.raw_; }
+
+private:
+    static constexpr std::int32_t saturate(std::int64_t raw) {
+        return raw > INT32_MAX ? INT32_MAX : raw < INT32_MIN ? INT32_MIN : std::int32_t(raw);
+    }
+
+    // Clamped before the cast so NaN / huge values cannot overflow it
+    static constexpr std::int64_t roundToRaw(double value) {
+        double scaled = value * kOne;
+        if (!(scaled > -4.0e18)) {
+            return scaled != scaled ? 0 : INT64_MIN / 2;
+        }
+        if (scaled > 4.0e18) {
+            return INT64_MAX / 2;
+        }
+        return std::int64_t(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5);
+    }
+
+    // Q32.32 -> Q16.16, round half up (arithmetic shift floors)
+    static constexpr std::int64_t roundShift(std::int64_t product) {
+        return (product + (std::int64_t(1) << 15)) >> 16;
+    }
+
+    std::int32_t raw_;
+};
+
+// Integer square root, rounded to nearest: the r minimizing |r^2 - n|
+inline std::uint64_t isqrtRounded(std::uint64_t n) {
+    if (n == 0) {
+        return 0;
+    }
+    // Bit-by-bit: one compare and subtract per result bit, no divides.
+    // The step is masked rather than branched on: its outcome is the
+    // next root bit, which a predictor cannot guess.
+    std::uint64_t remainder = n;
+    std::uint64_t root = 0;
+    std::uint64_t bit = std::uint64_t(1) << 62;
+    while (bit > remainder) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        std::uint64_t trial = root + bit;
+        std::uint64_t take = std::uint64_t(0) - std::uint64_t(remainder >= trial);
+        remainder -= trial & take;
+        root = (root >> 1) + (bit & take);
+        bit >>= 2;
+    }
+    // floor(sqrt(n)) = root, n - root^2 = remainder; round up past root + 1/2
+    return remainder > root ? root + 1 : root;
+}
+
+inline Fixed16 sqrt(Fixed16 value) {
+    if (value.raw() <= 0) {
+        return Fixed16();
+    }
+    // sqrt(raw / 2^16) * 2^16 = sqrt(raw * 2^16)
+    return Fixed16::fromWideRaw(std::int64_t(isqrtRounded(std::uint64_t(value.raw()) << 16)));
+}
+
+// Leg length with a 64-bit sum of squares
+// -------------------------------------------------------------
+//   dx, dy, dz        Q16.16 in int64 (|d| < 2^32)
+//   dx^2 + dy^2 + dz^2  Q32.32, pre-shifted right by 2s when a delta
+//                       exceeds 2^30 so the sum fits in 63 bits
+//   length             isqrt(sum) << s
+// Error <= q / 2 on top of the inputs' own rounding for legs below
+// 2^14 m; longer legs lose the s low bits of the deltas.
+// -------------------------------------------------------------
+inline Fixed16 distance(const BasicWaypoint<Fixed16>& wp1, const BasicWaypoint<Fixed16>& wp2) {
+    std::int64_t dx = std::int64_t(wp2.x.raw()) - wp1.x.raw();
+    std::int64_t dy = std::int64_t(wp2.y.raw()) - wp1.y.raw();
+    std::int64_t dz = std::int64_t(wp2.z.raw()) - wp1.z.raw();
+    std::uint64_t ax = std::uint64_t(dx < 0 ? -dx : dx);
+    std::uint64_t ay = std::uint64_t(dy < 0 ? -dy : dy);
+    std::uint64_t az = std::uint64_t(dz < 0 ? -dz : dz);
+    std::uint64_t largest = ax > ay ? (ax > az ? ax : az) : (ay > az ? ay : az);
+    int shift = 0;
+    while ((largest >> shift) >= (std::uint64_t(1) << 30)) {
+        ++shift;
+    }
+    ax >>= shift;
+    ay >>= shift;
+    az >>= shift;
+    std::uint64_t sum = ax * ax + ay * ay + az * az;
+    return Fixed16::fromWideRaw(std::int64_t(isqrtRounded(sum) << shift));
+}
+
+// Exact 64-bit running sum of Fixed16 values (Q48.16)
+struct Fixed16Accumulator {
+    std::int64_t raw;
+
+    Fixed16Accumulator() : raw(0) {}
+
+    Fixed16Accumulator& operator+=(Fixed16 value) {
+        raw += value.raw();
+        return *this;
+    }
+
+    double toDouble() const { return double(raw) / Fixed16::kOne; }
+};
+
+#endif // EAD_FIXED_POINT_HXX
@@ -0,0 +1,257 @@
+#include "EAD_FleetSim.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <tuple>
+
+#include "EAD_Stats.hxx"
+#include "EAD_ThreadPool.hxx"
+
+namespace {
+
+// Phase 1 of a tick over drones [0, n) of the pointers given. Every
+// array is distinct, which __restrict tells the compiler so it can
+// vectorize without runtime overlap checks.
+void bulkStep(std::size_t n, double dt, double climb, double descent,
+              double* __restrict x, double* __restrict y, double* __restrict z,
+              const double* __restrict dirX, const double* __restrict dirY, const double* __restrict dirZ,
+              double* __restrict legRemaining, const double* __restrict speed,
+              const double* __restrict cruise, const double* __restrict altitudeCost,
+              double* __restrict battery, double* __restrict energyUsed, double* __restrict distanceFlown,
+              double* __restrict leftover) {
+    for (std::size_t i = 0; i < n; ++i) {
+        double travel = speed[i] * dt;
+        double s = std::min(travel, legRemaining[i]);
+        double dz = dirZ[i] * s;
+        double vertical = climb * std::max(dz, 0.0) + descent * std::max(-dz, 0.0);
+        double energy = s * (cruise[i] + altitudeCost[i] * (z[i] + 0.5 * dz)) + vertical;
+        x[i] += dirX[i] * s;
+        y[i] += dirY[i] * s;
+        z[i] += dz;
+        legRemaining[i] -= s;
+        battery[i] -= energy;
+        energyUsed[i] += energy;
+        distanceFlown[i] += s;
+        leftover[i] = travel - s;
+    }
+}
+
+} // namespace
+
+bool validateFleetSpecs(const std::vector<WaypointSoA>& routes, const std::vector<FleetDroneSpec>& drones,
+                        std::string& error) {
+    for (std::size_t i = 0; i < drones.size(); ++i) {
+        if (drones[i].route >= routes.size()) {
+            error = "drone " + std::to_string(i) + " references route " + std::to_string(drones[i].route) +
+                    " of " + std::to_string(routes.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+FleetSimulator::FleetSimulator(const std::vector<WaypointSoA>& routes, const std::vector<FleetDroneSpec>& drones,
+                               const FleetSimOptions& options)
+    : routes_(&routes), options_(options), pool_(options.pool ? options.pool : &defaultThreadPool()),
+      time_(0.0), departed_(0), arrived_(0), depleted_(0) {
+    std::size_t n = drones.size();
+    route_.resize(n);
+    x_.assign(n, 0.0);
+    y_.assign(n, 0.0);
+    z_.assign(n, 0.0);
+    dirX_.assign(n, 0.0);
+    dirY_.assign(n, 0.0);
+    dirZ_.assign(n, 0.0);
+    legRemaining_.assign(n, 0.0);
+    speed_.assign(n, 0.0);
+    velocity_.resize(n);
+    cruise_.resize(n);
+    altitudeCost_.resize(n);
+    battery_.resize(n);
+    energyUsed_.assign(n, 0.0);
+    distanceFlown_.assign(n, 0.0);
+    leftover_.assign(n, 0.0);
+    endTime_.assign(n, 0.0);
+    departureTime_.resize(n);
+    target_.assign(n, 0);
+    status_.assign(n, kDroneWaiting);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const FleetDroneSpec& spec = drones[i];
+        double velocity = spec.velocity;
+        if (velocity == 0.0) {
+            velocity = std::get<0>(findOptimalSpeedAndAltitude(spec.coeffs.a, spec.coeffs.b));
+        }
+        route_[i] = spec.route;
+        velocity_[i] = velocity;
+        cruise_[i] = energyConsumption(velocity, 0.0, spec.coeffs);
+        altitudeCost_[i] = spec.coeffs.b;
+        battery_[i] = spec.battery;
+        departureTime_[i] = spec.departureTime;
+    }
+
+    departures_.resize(n);
+    std::iota(departures_.begin(), departures_.end(), std::size_t(0));
+    std::stable_sort(departures_.begin(), departures_.end(),
+                     [this](std::size_t a, std::size_t b) { return departureTime_[a] < departureTime_[b]; });
+}
+
+FleetCounts FleetSimulator::counts() const {
+    FleetCounts counts;
+    counts.arrived = arrived_.load(std::memory_order_relaxed);
+    counts.depleted = depleted_.load(std::memory_order_relaxed);
+    counts.waiting = size() - departed_;
+    counts.flying = departed_ - counts.arrived - counts.depleted;
+    return counts;
+}
+
+// Aim drone i at waypoint target_[i] from where it is now
+bool FleetSimulator::startLeg(std::size_t i) {
+    const WaypointSoA& route = (*routes_)[route_[i]];
+    std::size_t t = target_[i];
+    if (t >= route.size()) {
+        return false;
+    }
+    double dx = route.x[t] - x_[i];
+    double dy = route.y[t] - y_[i];
+    double dz = route.z[t] - z_[i];
+    double length = std::sqrt(dx * dx + dy * dy + dz * dz);
+    double inverse = length > 0.0 ? 1.0 / length : 0.0;
+    dirX_[i] = dx * inverse;
+    dirY_[i] = dy * inverse;
+    dirZ_[i] = dz * inverse;
+    legRemaining_[i] = length;
+    return true;
+}
+
+// Release a waiting drone at the first waypoint of its route. A route
+// with a single waypoint is arrived at once; a drone with no positive
+// cruise speed cannot fly and is marked depleted.
+void FleetSimulator::depart(std::size_t i) {
+    const WaypointSoA& route = (*routes_)[route_[i]];
+    endTime_[i] = time_;
+    if (route.size() > 0) {
+        x_[i] = route.x[0];
+        y_[i] = route.y[0];
+        z_[i] = route.z[0];
+    }
+    if (route.size() < 2) {
+        status_[i] = kDroneArrived;
+        arrived_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (!(velocity_[i] > 0.0)) {
+        status_[i] = kDroneDepleted;
+        depleted_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    status_[i] = kDroneFlying;
+    speed_[i] = velocity_[i];
+    target_[i] = 1;
+    startLeg(i);
+}
+
+// Scalar counterpart of one bulkStep() iteration for 'length' meters
+// of the current leg; returns the energy spent
+double FleetSimulator::flyPiece(std::size_t i, double length) {
+    double dz = dirZ_[i] * length;
+    double vertical = options_.climbCoefficient * std::max(dz, 0.0) +
+                      options_.descentCoefficient * std::max(-dz, 0.0);
+    double energy = length * (cruise_[i] + altitudeCost_[i] * (z_[i] + 0.5 * dz)) + vertical;
+    x_[i] += dirX_[i] * length;
+    y_[i] += dirY_[i] * length;
+    z_[i] += dz;
+    legRemaining_[i] -= length;
+    battery_[i] -= energy;
+    energyUsed_[i] += energy;
+    distanceFlown_[i] += length;
+    return energy;
+}
+
+// Phase 2 for one drone that finished its leg or ran flat this tick
+void FleetSimulator::fixUp(std::size_t i, double dt) {
+    const WaypointSoA& route = (*routes_)[route_[i]];
+    double tickEnd = time_ + dt;
+    for (;;) {
+        if (battery_[i] < 0.0) {
+            status_[i] = kDroneDepleted;
+            endTime_[i] = tickEnd;
+            break;
+        }
+        if (legRemaining_[i] > 0.0) {
+            return;
+        }
+        // At waypoint target_[i]: snap to it so rounding never drifts
+        std::size_t reached = target_[i];
+        x_[i] = route.x[reached];
+        y_[i] = route.y[reached];
+        z_[i] = route.z[reached];
+        target_[i] = static_cast<std::uint32_t>(reached + 1);
+        if (!startLeg(i)) {
+            status_[i] = kDroneArrived;
+            endTime_[i] = tickEnd - leftover_[i] / velocity_[i];
+            break;
+        }
+        double piece = std::min(leftover_[i], legRemaining_[i]);
+        if (piece > 0.0) {
+            flyPiece(i, piece);
+            leftover_[i] -= piece;
+        }
+    }
+    speed_[i] = 0.0;
+    leftover_[i] = 0.0;
+    legRemaining_[i] = 0.0;
+    dirX_[i] = dirY_[i] = dirZ_[i] = 0.0;
+}
+
+void FleetSimulator::stepRange(std::size_t begin, std::size_t end, double dt) {
+    bulkStep(end - begin, dt, options_.climbCoefficient, options_.descentCoefficient,
+             &x_[begin], &y_[begin], &z_[begin], &dirX_[begin], &dirY_[begin], &dirZ_[begin],
+             &legRemaining_[begin], &speed_[begin], &cruise_[begin], &altitudeCost_[begin],
+             &battery_[begin], &energyUsed_[begin], &distanceFlown_[begin], &leftover_[begin]);
+    std::size_t fixUps = 0, arrived = 0, depleted = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        if (status_[i] == kDroneFlying && (legRemaining_[i] <= 0.0 || battery_[i] < 0.0)) {
+            fixUp(i, dt);
+            ++fixUps;
+            arrived += status_[i] == kDroneArrived;
+            depleted += status_[i] == kDroneDepleted;
+        }
+    }
+    if (arrived) {
+        arrived_.fetch_add(arrived, std::memory_order_relaxed);
+    }
+    if (depleted) {
+        depleted_.fetch_add(depleted, std::memory_order_relaxed);
+    }
+    EAD_STATS_COUNT("fleet_fixups", fixUps);
+}
+
+void FleetSimulator::step(double dt) {
+    EAD_STATS_TIMER("fleet_step");
+    while (departed_ < departures_.size() && departureTime_[departures_[departed_]] <= time_) {
+        depart(departures_[departed_]);
+        ++departed_;
+    }
+    std::size_t n = size();
+    std::size_t grain = std::max<std::size_t>(options_.grain, 1);
+    if (n > grain) {
+        pool_->parallelFor(0, n, grain, [this, dt](std::size_t begin, std::size_t end) {
+            stepRange(begin, end, dt);
+        });
+    } else if (n > 0) {
+        stepRange(0, n, dt);
+    }
+    EAD_STATS_COUNT("fleet_drone_steps", n);
+    time_ += dt;
+}
+
+void FleetSimulator::run(double duration, double dt) {
+    double end = time_ + duration;
+    // The tolerance keeps rounding in time_ from adding a sliver step
+    while (end - time_ > dt * 1e-9 && !finished()) {
+        step(std::min(dt, end - time_));
+    }
+}
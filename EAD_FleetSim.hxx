@@ -0,0 +1,148 @@
+#ifndef EAD_FLEET_SIM_HXX
+#define EAD_FLEET_SIM_HXX
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_PathSoA.hxx"
+
+class ThreadPool;
+
+// Time-Stepped Fleet Simulation
+// =========================================================
+// Thousands of drones, each flying its own route, advanced in fixed
+// time steps. Drone state is stored as one contiguous array per field
+// (structure of arrays), so a tick is a straight pass over them:
+//
+//   x[]  y[]  z[]           position
+//   dirX[] dirY[] dirZ[]    unit vector of the current leg
+//   legRemaining[]          meters left on the current leg
+//   speed[]                 cruise speed while flying, 0 otherwise
+//   cruise[] altitudeCost[] a v^2 + c and b of the drone's model
+//   battery[] energyUsed[] distanceFlown[]
+//   target[] status[]       next waypoint index, FleetDroneStatus
+//
+// Tick (split across the pool by drone range, 'grain' drones a task)
+// -------------------------------------------------------------
+//   1. Bulk pass, branch free (vectorizes): every drone moves
+//      min(speed * dt, legRemaining) along its leg and pays the
+//      per-segment model for that piece,
+//
+//        E = s * (cruise + b * mean(h)) + climb / descent * |dz|
+//
+//      Drones that are not flying have speed 0 and pay nothing.
+//   2. Fix-up pass, scalar, only for the few drones that finished a
+//      leg or ran flat this tick: move on to the next leg with the
+//      time left over, mark arrivals and depletions.
+//
+// Because E is linear in the distance flown and dz keeps its sign
+// along a leg, the pieces of a leg add up to exactly the per-segment
+// model's E_leg: a drone that arrives has used evaluateSegments()'s
+// total for its route, up to rounding.
+//
+// A drone whose battery drops below zero stops where it is
+// ("depleted") at the end of that tick. Departures are released at
+// the first tick that starts at or after their departure time.
+// =========================================================
+
+enum FleetDroneStatus : std::uint8_t { kDroneWaiting, kDroneFlying, kDroneArrived, kDroneDepleted };
+
+struct FleetDroneSpec {
+    std::size_t route;         // Index into the simulator's routes
+    EnergyCoefficients coeffs;
+    double velocity;           // Cruise speed; 0 = findOptimalSpeedAndAltitude(a, b)
+    double battery;            // Usable energy at departure
+    double departureTime;      // Seconds after the start
+};
+
+struct FleetSimOptions {
+    double climbCoefficient;   // Per-segment model climb term
+    double descentCoefficient; // Per-segment model descent term
+    ThreadPool* pool;          // nullptr = defaultThreadPool()
+    std::size_t grain;         // Drones per task
+
+    FleetSimOptions() : climbCoefficient(0.5), descentCoefficient(0.0), pool(nullptr), grain(4096) {}
+};
+
+struct FleetCounts {
+    std::size_t waiting, flying, arrived, depleted;
+};
+
+// Check every drone references one of 'routes'; returns false and sets
+// 'error' for the first that does not
+bool validateFleetSpecs(const std::vector<WaypointSoA>& routes, const std::vector<FleetDroneSpec>& drones,
+                        std::string& error);
+
+class FleetSimulator {
+public:
+    // 'routes' must outlive the simulator; drones only reference them.
+    // The specs must pass validateFleetSpecs().
+    FleetSimulator(const std::vector<WaypointSoA>& routes, const std::vector<FleetDroneSpec>& drones,
+                   const FleetSimOptions& options = FleetSimOptions());
+
+    FleetSimulator(const FleetSimulator&) = delete;
+    FleetSimulator& operator=(const FleetSimulator&) = delete;
+
+    // Advance every drone by dt seconds
+    void step(double dt);
+
+    // Step by dt until 'duration' seconds have passed or every drone
+    // has arrived or run flat
+    void run(double duration, double dt);
+
+    double time() const { return time_; }
+    std::size_t size() const { return status_.size(); }
+    bool finished() const { return counts().waiting == 0 && counts().flying == 0; }
+    FleetCounts counts() const;
+
+    // Per-drone state
+    FleetDroneStatus status(std::size_t i) const { return FleetDroneStatus(status_[i]); }
+    Waypoint position(std::size_t i) const { Waypoint p = {x_[i], y_[i], z_[i]}; return p; }
+    std::size_t targetWaypoint(std::size_t i) const { return target_[i]; }
+    double battery(std::size_t i) const { return battery_[i]; }
+    double energyUsed(std::size_t i) const { return energyUsed_[i]; }
+    double distanceFlown(std::size_t i) const { return distanceFlown_[i]; }
+    // Arrival / depletion time; only meaningful once the drone stopped
+    double endTime(std::size_t i) const { return endTime_[i]; }
+
+private:
+    void depart(std::size_t i);
+    bool startLeg(std::size_t i);
+    void fixUp(std::size_t i, double dt);
+    void stepRange(std::size_t begin, std::size_t end, double dt);
+    double flyPiece(std::size_t i, double length);
+
+    const std::vector<WaypointSoA>* routes_;
+    FleetSimOptions options_;
+    ThreadPool* pool_;
+    double time_;
+
+    std::vector<std::size_t> route_;
+    std::vector<double> x_, y_, z_;
+    std::vector<double> dirX_, dirY_, dirZ_;
+    std::vector<double> legRemaining_;
+    std::vector<double> speed_;
+    std::vector<double> velocity_;
+    std::vector<double> cruise_;
+    std::vector<double> altitudeCost_;
+    std::vector<double> battery_;
+    std::vector<double> energyUsed_;
+    std::vector<double> distanceFlown_;
+    std::vector<double> leftover_; // Meters of this tick not flown yet
+    std::vector<double> endTime_;
+    std::vector<double> departureTime_;
+    std::vector<std::uint32_t> target_;
+    std::vector<std::uint8_t> status_;
+
+    // Drone indices by departure time; the first 'departed_' are released
+    std::vector<std::size_t> departures_;
+    std::size_t departed_;
+    std::atomic<std::size_t> arrived_;
+    std::atomic<std::size_t> depleted_;
+};
+
+#endif // EAD_FLEET_SIM_HXX
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "EAD_Batch.hxx"
+#include "EAD_Core.hxx"
+#include "EAD_RouteBatch.hxx"
+#include "EAD_RouteBatchGpu.hxx"
+
+// GPU Bulk Scorer (EAD_EnergyAwareDrone_gpu)
+// =========================================================
+// Batch-mode input and output (EAD_Batch.hxx) scored on a CUDA device:
+//
+//   EAD_EnergyAwareDrone_gpu <file | -> [--device N] [--streams N]
+//       [--routes-per-batch N] [--check] [--climb X] [--descent X]
+//
+// Missions are read into packed batches of up to --routes-per-batch
+// routes, each batch is scored by GpuRouteScorer (chunked over the
+// streams) and written as "<id> <distance> <velocity> <energy>", the
+// same lines --batch prints. --check also scores every batch on the
+// CPU (scoreRouteBatch()) and fails if any route differs by more than
+// gpuScoreTolerance() for the longest route read.
+// =========================================================
+
+struct GpuCommandLine {
+    std::string input;
+    GpuBatchOptions gpu;
+    RouteBatchOptions scoring;
+    std::size_t routesPerBatch;
+    bool check;
+
+    GpuCommandLine() : routesPerBatch(1 << 20), check(false) {}
+};
+
+static int usage(const char* program) {
+    std::cerr << "usage: " << program << " <file|-> [--device N] [--streams N] [--routes-per-batch N] [--check]"
+                 " [--climb X] [--descent X]\n";
+    return 2;
+}
+
+struct PendingBatch {
+    PackedRouteBatch routes;
+    std::vector<std::string> ids;
+    std::vector<std::string> errors; // Per input line; empty = scored
+    std::vector<std::size_t> routeOfLine;
+};
+
+// Score and write one batch; returns false on a device error or a
+// --check mismatch
+static bool flushBatch(const GpuCommandLine& cmd, GpuRouteScorer& scorer, PendingBatch& batch, double& worst) {
+    std::vector<SegmentEnergyTotals> totals;
+    std::string error;
+    if (!scorer.score(batch.routes, cmd.scoring, totals, error)) {
+        std::cerr << error << "\n";
+        return false;
+    }
+    if (cmd.check) {
+        std::vector<SegmentEnergyTotals> reference;
+        scoreRouteBatch(batch.routes, cmd.scoring, reference);
+        worst = std::max(worst, maxRelativeDifference(reference, totals));
+    }
+    for (std::size_t line = 0; line < batch.ids.size(); ++line) {
+        if (!batch.errors[line].empty()) {
+            std::cout << batch.ids[line] << " error " << batch.errors[line] << '\n';
+            continue;
+        }
+        std::size_t r = batch.routeOfLine[line];
+        std::cout << batch.ids[line] << ' ' << totals[r].distance << ' ' << batch.routes.velocity[r] << ' '
+                  << totals[r].energy << '\n';
+    }
+    batch.routes.clear();
+    batch.ids.clear();
+    batch.errors.clear();
+    batch.routeOfLine.clear();
+    return true;
+}
+
+static int runGpuScorer(const GpuCommandLine& cmd) {
+    std::ifstream file;
+    if (cmd.input != "-") {
+        file.open(cmd.input.c_str());
+        if (!file) {
+            std::cerr << "cannot open " << cmd.input << "\n";
+            return 1;
+        }
+    }
+    std::istream& in = cmd.input == "-" ? std::cin : file;
+
+    GpuRouteScorer scorer;
+    std::string error;
+    if (!scorer.open(cmd.gpu, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cerr << "Scoring on " << scorer.deviceName() << "\n";
+
+    std::ios::sync_with_stdio(false);
+    std::cout.precision(10);
+    PendingBatch batch;
+    Mission mission;
+    std::string line;
+    std::vector<double> x, y, z;
+    std::size_t failures = 0;
+    double worst = 0.0;
+    std::size_t longest = 0; // Legs of the longest route
+    while (std::getline(in, line)) {
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        if (!parseMissionLine(line, mission, error)) {
+            std::size_t end = line.find_first_of(" \t\r", first);
+            batch.ids.push_back(line.substr(first, end == std::string::npos ? std::string::npos : end - first));
+            batch.errors.push_back(error);
+            batch.routeOfLine.push_back(0);
+            ++failures;
+            continue;
+        }
+        // Same velocity as batch mode
+        double velocity = std::get<0>(findOptimalSpeedAndAltitude(mission.coeffs.a, mission.coeffs.b));
+        std::size_t n = mission.waypoints.size();
+        longest = std::max(longest, n > 0 ? n - 1 : 0);
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] = mission.waypoints[i].x;
+            y[i] = mission.waypoints[i].y;
+            z[i] = mission.waypoints[i].z;
+        }
+        batch.ids.push_back(mission.id);
+        batch.errors.push_back(std::string());
+        batch.routeOfLine.push_back(batch.routes.routeCount());
+        batch.routes.append(x.data(), y.data(), z.data(), n, mission.coeffs, velocity);
+        if (batch.routes.routeCount() >= cmd.routesPerBatch && !flushBatch(cmd, scorer, batch, worst)) {
+            return 1;
+        }
+    }
+    if (!flushBatch(cmd, scorer, batch, worst)) {
+        return 1;
+    }
+    std::cout.flush();
+    if (cmd.check) {
+        double tolerance = gpuScoreTolerance(longest);
+        std::cerr << "Largest GPU / CPU relative difference: " << worst << " (tolerance " << tolerance << ")\n";
+        if (!(worst <= tolerance)) {
+            return 1;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    GpuCommandLine cmd;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        int values = argc - i - 1;
+        if (arg == "--device" && values >= 1) {
+            cmd.gpu.device = std::atoi(argv[++i]);
+        } else if (arg == "--streams" && values >= 1) {
+            cmd.gpu.streams = std::atoi(argv[++i]);
+        } else if (arg == "--routes-per-batch" && values >= 1) {
+            cmd.routesPerBatch = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--check") {
+            cmd.check = true;
+        } else if (arg == "--climb" && values >= 1) {
+            cmd.scoring.climbCoefficient = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--descent" && values >= 1) {
+            cmd.scoring.descentCoefficient = std::strtod(argv[++i], nullptr);
+        } else if (cmd.input.empty() && (arg == "-" || arg[0] != '-')) {
+            cmd.input = arg;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (cmd.input.empty() || cmd.routesPerBatch == 0) {
+        return usage(argv[0]);
+    }
+    return runGpuScorer(cmd);
+}
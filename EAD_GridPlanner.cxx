@@ -0,0 +1,379 @@
+#include "EAD_GridPlanner.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "EAD_Stats.hxx"
+
+namespace {
+
+const double kInfinity = std::numeric_limits<double>::infinity();
+const double kSqrt2 = 1.4142135623730951;
+const double kSqrt3 = 1.7320508075688772;
+
+std::size_t absDiff(std::size_t a, std::size_t b) { return a > b ? a - b : b - a; }
+
+} // namespace
+
+// ---------------------------------------------------------------
+// AirspaceGrid
+// ---------------------------------------------------------------
+
+AirspaceGrid::AirspaceGrid(std::size_t nx, std::size_t ny, std::size_t nz, double cellSize, const Waypoint& origin)
+    : nx_(nx), ny_(ny), nz_(nz), cellSize_(cellSize), origin_(origin),
+      blocked_((nx * ny * nz + 63) / 64, 0) {}
+
+void AirspaceGrid::setBlocked(std::size_t ix, std::size_t iy, std::size_t iz, bool value) {
+    std::size_t voxel = index(ix, iy, iz);
+    std::uint64_t bit = std::uint64_t(1) << (voxel & 63);
+    if (value) {
+        blocked_[voxel >> 6] |= bit;
+    } else {
+        blocked_[voxel >> 6] &= ~bit;
+    }
+}
+
+void AirspaceGrid::blockBox(std::size_t x0, std::size_t y0, std::size_t z0,
+                            std::size_t x1, std::size_t y1, std::size_t z1) {
+    x1 = std::min(x1, nx_ - 1);
+    y1 = std::min(y1, ny_ - 1);
+    z1 = std::min(z1, nz_ - 1);
+    for (std::size_t iz = z0; iz <= z1; ++iz) {
+        for (std::size_t iy = y0; iy <= y1; ++iy) {
+            for (std::size_t ix = x0; ix <= x1; ++ix) {
+                setBlocked(ix, iy, iz, true);
+            }
+        }
+    }
+}
+
+bool AirspaceGrid::voxelOf(const Waypoint& wp, std::size_t& voxel) const {
+    double fx = std::floor((wp.x - origin_.x) / cellSize_);
+    double fy = std::floor((wp.y - origin_.y) / cellSize_);
+    double fz = std::floor((wp.z - origin_.z) / cellSize_);
+    if (!(fx >= 0 && fy >= 0 && fz >= 0 && fx < double(nx_) && fy < double(ny_) && fz < double(nz_))) {
+        return false;
+    }
+    voxel = index(std::size_t(fx), std::size_t(fy), std::size_t(fz));
+    return true;
+}
+
+Waypoint AirspaceGrid::centre(std::size_t voxel) const {
+    std::size_t ix = voxel % nx_;
+    std::size_t iy = (voxel / nx_) % ny_;
+    std::size_t iz = voxel / (nx_ * ny_);
+    Waypoint wp;
+    wp.x = origin_.x + (double(ix) + 0.5) * cellSize_;
+    wp.y = origin_.y + (double(iy) + 0.5) * cellSize_;
+    wp.z = origin_.z + (double(iz) + 0.5) * cellSize_;
+    return wp;
+}
+
+// ---------------------------------------------------------------
+// GridPlanner
+// ---------------------------------------------------------------
+
+GridPlanner::GridPlanner(const AirspaceGrid& grid, const SegmentEnergyParams& params)
+    : grid_(grid), params_(params), cruise_(cruiseEnergyPerMeter(params.velocity, params)),
+      bricksX_((grid.nx() + kBrickSide - 1) / kBrickSide), bricksY_((grid.ny() + kBrickSide - 1) / kBrickSide),
+      brickKeys_(std::size_t(1) << 12, kNone), brickOffsets_(std::size_t(1) << 12, 0) {
+    // Energy per meter is linear in h, so its minimum over the grid is
+    // at the centre of the bottom or the top layer
+    double low = grid.origin().z + 0.5 * grid.cellSize();
+    double high = grid.origin().z + (double(grid.nz()) - 0.5) * grid.cellSize();
+    minEnergyPerMeter_ = cruise_ + std::min(params.coeffs.b * low, params.coeffs.b * high);
+
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx == 0 && dy == 0 && dz == 0) {
+                    continue;
+                }
+                Move move = {dx, dy, dz, grid.cellSize() * std::sqrt(double(dx * dx + dy * dy + dz * dz))};
+                moves_.push_back(move);
+            }
+        }
+    }
+}
+
+void GridPlanner::clearNodes() {
+    nodes_.clear();
+    brickSlots_.clear();
+    std::fill(brickKeys_.begin(), brickKeys_.end(), kNone);
+}
+
+std::uint32_t GridPlanner::nodeFor(std::size_t ix, std::size_t iy, std::size_t iz) {
+    std::uint32_t brick = static_cast<std::uint32_t>(
+        ((iz / kBrickSide) * bricksY_ + iy / kBrickSide) * bricksX_ + ix / kBrickSide);
+    std::size_t local = ((iz % kBrickSide) * kBrickSide + iy % kBrickSide) * kBrickSide + ix % kBrickSide;
+
+    std::size_t mask = brickKeys_.size() - 1;
+    std::size_t h = (std::uint64_t(brick) * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+    while (brickKeys_[h] != kNone && brickKeys_[h] != brick) {
+        h = (h + 1) & mask;
+    }
+    if (brickKeys_[h] == kNone) {
+        std::size_t bricks = brickSlots_.size() / kBrickVoxels;
+        if (2 * (bricks + 1) > brickKeys_.size()) {
+            // Grow at 50% load, then look the brick up again
+            std::vector<std::uint32_t> keys(brickKeys_.size() * 2, kNone);
+            std::vector<std::uint32_t> offsets(keys.size(), 0);
+            for (std::size_t k = 0; k < brickKeys_.size(); ++k) {
+                if (brickKeys_[k] == kNone) {
+                    continue;
+                }
+                std::size_t g = (std::uint64_t(brickKeys_[k]) * 0x9E3779B97F4A7C15ULL >> 32) & (keys.size() - 1);
+                while (keys[g] != kNone) {
+                    g = (g + 1) & (keys.size() - 1);
+                }
+                keys[g] = brickKeys_[k];
+                offsets[g] = brickOffsets_[k];
+            }
+            brickKeys_.swap(keys);
+            brickOffsets_.swap(offsets);
+            return nodeFor(ix, iy, iz);
+        }
+        brickKeys_[h] = brick;
+        brickOffsets_[h] = static_cast<std::uint32_t>(bricks);
+        brickSlots_.resize(brickSlots_.size() + kBrickVoxels, kNone);
+    }
+
+    std::uint32_t& slot = brickSlots_[std::size_t(brickOffsets_[h]) * kBrickVoxels + local];
+    if (slot == kNone) {
+        Node node;
+        node.g[0] = node.g[1] = kInfinity;
+        node.parent[0] = node.parent[1] = kNone;
+        node.voxel = static_cast<std::uint32_t>(grid_.index(ix, iy, iz));
+        slot = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.push_back(node);
+    }
+    return slot;
+}
+
+double GridPlanner::heuristic(std::size_t from, std::size_t to) const {
+    std::size_t nx = grid_.nx(), nxy = grid_.nx() * grid_.ny();
+    std::size_t fz = from / nxy, tz = to / nxy;
+    std::size_t d[3] = {absDiff(from % nx, to % nx), absDiff((from / nx) % grid_.ny(), (to / nx) % grid_.ny()),
+                        absDiff(fz, tz)};
+    // Sort descending: d[0] >= d[1] >= d[2]
+    if (d[0] < d[1]) std::swap(d[0], d[1]);
+    if (d[1] < d[2]) std::swap(d[1], d[2]);
+    if (d[0] < d[1]) std::swap(d[0], d[1]);
+    double octile = grid_.cellSize() * (double(d[0]) + (kSqrt2 - 1.0) * double(d[1]) +
+                                        (kSqrt3 - kSqrt2) * double(d[2]));
+    double z0 = grid_.origin().z + (double(fz) + 0.5) * grid_.cellSize();
+    double z1 = grid_.origin().z + (double(tz) + 0.5) * grid_.cellSize();
+    if (params_.coeffs.b < 0.0) {
+        // Energy falls with altitude: no benefit from dipping, plain bound
+        double dz = z1 - z0;
+        double vertical = dz > 0.0 ? params_.climbCoefficient * dz : -params_.descentCoefficient * dz;
+        return octile * minEnergyPerMeter_ + vertical;
+    }
+    // Relaxed problem: any altitude profile h(s) with |dh/ds| <= 1 (a
+    // move climbs at most one layer per cellSize flown), h >= bottom
+    // layer and length >= octile. The cheapest such profile descends
+    // at slope 1 to some floor L, cruises there and climbs at slope 1:
+    //
+    //   z0 \            / z1      length = max(octile, z0 + z1 - 2L)
+    //       \__________/          E(h)   = cruise + b * h
+    //            L
+    //
+    //   bound(L) = (cruise + b L) * length + b ((z0 - L)^2 + (z1 - L)^2) / 2
+    //            + descent * (z0 - L) + climb * (z1 - L)
+    //
+    // bound(L) is a convex quadratic on [max(bottom, (z0 + z1 - octile) / 2),
+    // min(z0, z1)], so its minimum is the clamped stationary point. The
+    // bound is the exact optimum of the relaxation, which makes it
+    // consistent as well as admissible (joining two relaxed paths gives
+    // a relaxed path).
+    double b = params_.coeffs.b;
+    double sum = z0 + z1;
+    double bottom = grid_.origin().z + 0.5 * grid_.cellSize();
+    double low = std::max(bottom, 0.5 * (sum - octile));
+    double high = std::min(z0, z1);
+    double level = high;
+    if (b > 0.0) {
+        double stationary = 0.5 * (sum - octile + (params_.climbCoefficient + params_.descentCoefficient) / b);
+        level = std::max(low, std::min(high, stationary));
+    }
+    double length = std::max(octile, sum - 2.0 * level);
+    return (cruise_ + b * level) * length + 0.5 * b * ((z0 - level) * (z0 - level) + (z1 - level) * (z1 - level)) +
+           params_.descentCoefficient * (z0 - level) + params_.climbCoefficient * (z1 - level);
+}
+
+double GridPlanner::edgeCost(std::size_t from, std::size_t to, double length) const {
+    std::size_t nxy = grid_.nx() * grid_.ny();
+    double z0 = grid_.origin().z + (double(from / nxy) + 0.5) * grid_.cellSize();
+    double z1 = grid_.origin().z + (double(to / nxy) + 0.5) * grid_.cellSize();
+    return legEnergy(length, z0, z1, cruise_, params_);
+}
+
+bool GridPlanner::moveAllowed(std::size_t ix, std::size_t iy, std::size_t iz, const Move& move) const {
+    // Every voxel of the move's bounding box must be free. The box is
+    // walked from its low corner, so the rule is the same in both
+    // directions and the graph stays symmetric.
+    std::size_t x0 = move.dx < 0 ? ix - 1 : ix, y0 = move.dy < 0 ? iy - 1 : iy, z0 = move.dz < 0 ? iz - 1 : iz;
+    for (int cz = 0; cz <= (move.dz ? 1 : 0); ++cz) {
+        for (int cy = 0; cy <= (move.dy ? 1 : 0); ++cy) {
+            for (int cx = 0; cx <= (move.dx ? 1 : 0); ++cx) {
+                if (grid_.blocked(x0 + std::size_t(cx), y0 + std::size_t(cy), z0 + std::size_t(cz))) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool GridPlanner::plan(const Waypoint& start, const Waypoint& goal, PlannedPath& path, std::string& error,
+                       const PlannerOptions& options) {
+    EAD_STATS_TIMER("planner");
+    path.waypoints.clear();
+    path.energy = 0.0;
+    path.expansions = 0;
+
+    if (grid_.voxelCount() >= kNone) {
+        error = "grid has too many voxels (limit 2^32 - 1)";
+        return false;
+    }
+    if (!(minEnergyPerMeter_ >= 0.0) || params_.climbCoefficient < 0.0 || params_.descentCoefficient < 0.0) {
+        error = "energy coefficients make some edge costs negative";
+        return false;
+    }
+    std::size_t source, target;
+    if (!grid_.voxelOf(start, source) || !grid_.voxelOf(goal, target)) {
+        error = "start or goal is outside the grid";
+        return false;
+    }
+    if (grid_.blocked(source) || grid_.blocked(target)) {
+        error = "start or goal is inside a blocked voxel";
+        return false;
+    }
+    if (source == target) {
+        path.waypoints.push_back(grid_.centre(source));
+        return true;
+    }
+
+    const bool bidirectional = options.bidirectional;
+    const double quantum = options.costQuantum > 0.0 ? options.costQuantum
+                                                     : std::max(heuristic(source, target), 1e-300) * 0x1p-32;
+
+    // Potentials: p[0] for the forward search, p[1] = -p[0] for the
+    // backward one (only pure A* potentials when unidirectional)
+    auto forwardPotential = [&](std::size_t v) {
+        return bidirectional ? 0.5 * (heuristic(v, target) - heuristic(source, v)) : heuristic(v, target);
+    };
+    const double offset[2] = {-forwardPotential(source), forwardPotential(target)};
+    auto keyOf = [&](int direction, std::size_t v, double g) -> std::uint64_t {
+        double p = forwardPotential(v);
+        double reduced = g + (direction == 0 ? p : -p) + offset[direction];
+        if (!(reduced > 0.0)) {
+            return 0;
+        }
+        double q = reduced / quantum;
+        return q < 9.2e18 ? static_cast<std::uint64_t>(q) : std::uint64_t(9.2e18);
+    };
+
+    clearNodes();
+    heaps_[0].clear();
+    heaps_[1].clear();
+    std::size_t nx = grid_.nx(), ny = grid_.ny(), nz = grid_.nz();
+    std::uint32_t sourceSlot = nodeFor(source % nx, (source / nx) % ny, source / (nx * ny));
+    std::uint32_t targetSlot = nodeFor(target % nx, (target / nx) % ny, target / (nx * ny));
+    nodes_[sourceSlot].g[0] = 0.0;
+    nodes_[targetSlot].g[1] = 0.0;
+    HeapEntry first = {sourceSlot, 0.0};
+    heaps_[0].push(0, first);
+    if (bidirectional) {
+        HeapEntry last = {targetSlot, 0.0};
+        heaps_[1].push(0, last);
+    }
+
+    double best = kInfinity; // mu: cheapest start -> goal path seen so far
+    std::uint32_t meet = kNone; // Slot of the node where the searches join
+
+    for (;;) {
+        int direction;
+        if (bidirectional) {
+            if (heaps_[0].empty() || heaps_[1].empty()) {
+                break;
+            }
+            std::uint64_t k0 = heaps_[0].minKey(), k1 = heaps_[1].minKey();
+            if ((double(k0) + double(k1)) * quantum >= best + offset[0] + offset[1]) {
+                break;
+            }
+            direction = k0 <= k1 ? 0 : 1;
+        } else {
+            if (heaps_[0].empty() || double(heaps_[0].minKey()) * quantum >= best + offset[0]) {
+                break;
+            }
+            direction = 0;
+        }
+
+        RadixHeap<HeapEntry>::Item item = heaps_[direction].pop();
+        std::uint32_t slot = item.value.slot;
+        double g = nodes_[slot].g[direction];
+        if (item.value.g != g) {
+            continue; // Superseded by a cheaper label
+        }
+        if (options.maxExpansions && path.expansions >= options.maxExpansions) {
+            error = "planner gave up after " + std::to_string(path.expansions) + " expansions";
+            return false;
+        }
+        ++path.expansions;
+        EAD_STATS_COUNT("planner_expansions", 1);
+
+        std::size_t voxel = nodes_[slot].voxel;
+        std::size_t ix = voxel % nx, iy = (voxel / nx) % ny, iz = voxel / (nx * ny);
+        for (const Move& move : moves_) {
+            std::size_t jx = ix + std::size_t(move.dx), jy = iy + std::size_t(move.dy), jz = iz + std::size_t(move.dz);
+            if (jx >= nx || jy >= ny || jz >= nz) {
+                continue; // Unsigned wrap covers the -1 side too
+            }
+            std::size_t next = grid_.index(jx, jy, jz);
+            if (grid_.blocked(next) || !moveAllowed(ix, iy, iz, move)) {
+                continue;
+            }
+            double cost = direction == 0 ? edgeCost(voxel, next, move.length) : edgeCost(next, voxel, move.length);
+            double ng = g + cost;
+            std::uint32_t nextSlot = nodeFor(jx, jy, jz);
+            Node& node = nodes_[nextSlot];
+            if (ng < node.g[direction]) {
+                node.g[direction] = ng;
+                node.parent[direction] = slot;
+                HeapEntry entry = {nextSlot, ng};
+                heaps_[direction].push(keyOf(direction, next, ng), entry);
+                if (node.g[1 - direction] < kInfinity && ng + node.g[1 - direction] < best) {
+                    best = ng + node.g[1 - direction];
+                    meet = nextSlot;
+                }
+            }
+        }
+    }
+
+    if (meet == kNone) {
+        error = "goal is unreachable from start";
+        return false;
+    }
+
+    // meet -> start along parent[0], then meet -> goal along parent[1]
+    std::vector<std::uint32_t> voxels;
+    for (std::uint32_t s = meet; s != kNone; s = nodes_[s].parent[0]) {
+        voxels.push_back(nodes_[s].voxel);
+    }
+    std::reverse(voxels.begin(), voxels.end());
+    for (std::uint32_t s = nodes_[meet].parent[1]; s != kNone; s = nodes_[s].parent[1]) {
+        voxels.push_back(nodes_[s].voxel);
+    }
+
+    path.waypoints.reserve(voxels.size());
+    for (std::size_t i = 0; i < voxels.size(); ++i) {
+        path.waypoints.push_back(grid_.centre(voxels[i]));
+        if (i > 0) {
+            double length = distance(path.waypoints[i - 1], path.waypoints[i]);
+            path.energy += edgeCost(voxels[i - 1], voxels[i], length);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#include "EAD_MappedFile.hxx"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "EAD_Stats.hxx"
+
+bool MappedFile::open(const std::string& path, std::string& error, bool sequential) {
+    EAD_STATS_TIMER("io_map");
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        error = "cannot stat " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        error = path + " is empty";
+        ::close(fd);
+        return false;
+    }
+    void* mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference to the file
+    if (mapped == MAP_FAILED) {
+        error = "cannot map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    if (sequential) {
+        ::madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    }
+    data_ = static_cast<const unsigned char*>(mapped);
+    size_ = static_cast<size_t>(info.st_size);
+    EAD_STATS_COUNT("io_bytes_mapped", size_);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        ::munmap(const_cast<unsigned char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef EAD_MAPPED_FILE_HXX
+#define EAD_MAPPED_FILE_HXX
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory-mapped file (POSIX mmap)
+// =========================================================
+// The file's pages are mapped straight into the address space and
+// faulted in on first touch, so large inputs are never copied or
+// parsed up front. The mapping is released by the destructor.
+// =========================================================
+class MappedFile {
+public:
+    MappedFile() : data_(nullptr), size_(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map 'path'; returns false and sets 'error' on failure.
+    // 'sequential' hints the kernel to read ahead aggressively.
+    bool open(const std::string& path, std::string& error, bool sequential = true);
+    void close();
+
+    const unsigned char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool isOpen() const { return data_ != nullptr; }
+
+private:
+    const unsigned char* data_;
+    std::size_t size_;
+};
+
+#endif // EAD_MAPPED_FILE_HXX
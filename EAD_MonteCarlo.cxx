@@ -0,0 +1,271 @@
+#include "EAD_MonteCarlo.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+#include "EAD_Philox.hxx"
+#include "EAD_Stats.hxx"
+#include "EAD_ThreadPool.hxx"
+
+namespace {
+
+// Philox stream per sampled quantity
+enum MonteCarloStream { kStreamA, kStreamB, kStreamC, kStreamWindSpeed, kStreamWindDirection };
+
+const double kTwoPi = 6.283185307179586;
+
+// Block-wise like computeRouteAggregates(): lengths through the
+// batched kernel, then each leg into its heading bin
+template <typename T>
+MonteCarloRoute makeMonteCarloRouteImpl(const T* x, const T* y, const T* z, std::size_t n) {
+    MonteCarloRoute route;
+    route.totals = computeRouteAggregates(x, y, z, n);
+    route.binDistance.assign(kMonteCarloHeadingBins, 0.0);
+    route.binAltitudeDistance.assign(kMonteCarloHeadingBins, 0.0);
+    route.binTrackX.assign(kMonteCarloHeadingBins, 0.0);
+    route.binTrackY.assign(kMonteCarloHeadingBins, 0.0);
+
+    const std::size_t kBlock = 1024;
+    double lengths[kBlock];
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    for (std::size_t begin = 0; begin < segments; begin += kBlock) {
+        std::size_t count = std::min(kBlock, segments - begin);
+        segmentLengths(x + begin, y + begin, z + begin, count + 1, lengths);
+        for (std::size_t k = 0; k < count; ++k) {
+            std::size_t i = begin + k;
+            double dx = double(x[i + 1]) - double(x[i]);
+            double dy = double(y[i + 1]) - double(y[i]);
+            double heading = std::atan2(dy, dx) + 0.5 * kTwoPi; // [0, 2 pi]
+            std::size_t bin = std::min(static_cast<std::size_t>(heading * (kMonteCarloHeadingBins / kTwoPi)),
+                                       kMonteCarloHeadingBins - 1);
+            route.binDistance[bin] += lengths[k];
+            route.binAltitudeDistance[bin] += lengths[k] * 0.5 * (double(z[i]) + double(z[i + 1]));
+            route.binTrackX[bin] += dx;
+            route.binTrackY[bin] += dy;
+        }
+    }
+    // Sum of d * t over the bin, divided by sum of d
+    for (std::size_t bin = 0; bin < kMonteCarloHeadingBins; ++bin) {
+        if (route.binDistance[bin] > 0.0) {
+            route.binTrackX[bin] /= route.binDistance[bin];
+            route.binTrackY[bin] /= route.binDistance[bin];
+        }
+    }
+    return route;
+}
+
+// Value of 'spec' for one sample; fixed values draw nothing
+double drawValue(const UncertainValue& spec, std::uint64_t sample, MonteCarloStream stream, std::uint64_t seed) {
+    if (spec.kind == kUncertainFixed) {
+        return spec.first;
+    }
+    Philox4x32 counter = {{std::uint32_t(sample), std::uint32_t(sample >> 32), std::uint32_t(stream), 0u}};
+    Philox4x32 bits = philox4x32(counter, std::uint32_t(seed), std::uint32_t(seed >> 32));
+    double u0 = philoxUniform(bits.v[0], bits.v[1]);
+    if (spec.kind == kUncertainUniform) {
+        return spec.first + (spec.second - spec.first) * u0;
+    }
+    double u1 = philoxUniform(bits.v[2], bits.v[3]);
+    double normal = std::sqrt(-2.0 * std::log(u0)) * std::cos(kTwoPi * u1);
+    if (spec.kind == kUncertainNormal) {
+        return spec.first + spec.second * normal;
+    }
+    return spec.first * std::exp(spec.second * normal);
+}
+
+void drawBlock(const UncertainValue& spec, std::uint64_t first, std::size_t count, MonteCarloStream stream,
+               std::uint64_t seed, double* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = drawValue(spec, first + i, stream, seed);
+    }
+}
+
+// Still-air energy of n samples from the route aggregates (the
+// per-sample form of scoreCoefficients()); every array is distinct,
+// which __restrict tells the compiler so it can vectorize. A draw with
+// a <= 0, or b / 2a < 0 when the optimal speed is used, has no finite
+// cruise energy and gets +inf (infeasible)
+void stillAirBlock(std::size_t n, double fixedVelocity, const RouteAggregates& totals, double vertical,
+                   const double* __restrict a, const double* __restrict b, const double* __restrict c,
+                   double* __restrict velocity, double* __restrict cruise, double* __restrict energy) {
+    const double distance = totals.distance;
+    const double altitudeDistance = totals.altitudeDistance;
+    const double infinity = HUGE_VAL;
+    const bool fixed = fixedVelocity > 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        // Both sides are evaluated so the selects need no branch
+        double ratio = b[i] / (2.0 * a[i]);
+        bool physical = (a[i] > 0.0) & (fixed | (ratio >= 0.0));
+        double optimal = physical ? std::sqrt(std::max(ratio, 0.0)) : 0.0;
+        double v = fixed ? fixedVelocity : optimal;
+        velocity[i] = v;
+        cruise[i] = a[i] * v * v + c[i];
+        double e = cruise[i] * distance + b[i] * altitudeDistance + vertical;
+        energy[i] = physical ? e : infinity;
+    }
+}
+
+// Adds one heading bin's air energy, (v / s) * (SD * cruise + b * SH),
+// to n samples; +inf where the wind makes the heading unflyable
+void windBinBlock(std::size_t n, double distance, double altitudeDistance, double trackX, double trackY,
+                  const double* __restrict velocity, const double* __restrict cruise, const double* __restrict b,
+                  const double* __restrict windX, const double* __restrict windY,
+                  const double* __restrict windSquared, double* __restrict energy) {
+    const double infinity = HUGE_VAL;
+    for (std::size_t i = 0; i < n; ++i) {
+        double along = trackX * windX[i] + trackY * windY[i];
+        double v = velocity[i];
+        double discriminant = v * v - windSquared[i] + along * along;
+        double ground = along + std::sqrt(std::max(discriminant, 0.0));
+        double air = (cruise[i] * distance + b[i] * altitudeDistance) * v / ground;
+        bool flyable = (discriminant >= 0.0) & (ground > 0.0);
+        energy[i] += flyable ? air : infinity;
+    }
+}
+
+struct SampleBlock {
+    std::vector<double> a, b, c, windSpeed, windDirection;
+    std::vector<double> velocity, cruise, windX, windY, windSquared;
+};
+
+// Samples [first, first + count) into energy[0, count): draw, then
+// the still-air pass and one pass per heading bin over the block
+void evaluateBlock(const MonteCarloRoute& route, const MonteCarloOptions& options, std::uint64_t first,
+                   std::size_t count, SampleBlock& block, double* energy) {
+    block.a.resize(count);
+    block.b.resize(count);
+    block.c.resize(count);
+    block.velocity.resize(count);
+    block.cruise.resize(count);
+    drawBlock(options.a, first, count, kStreamA, options.seed, block.a.data());
+    drawBlock(options.b, first, count, kStreamB, options.seed, block.b.data());
+    drawBlock(options.c, first, count, kStreamC, options.seed, block.c.data());
+
+    const RouteAggregates& totals = route.totals;
+    const double vertical = options.climbCoefficient * totals.climb + options.descentCoefficient * totals.descent;
+    stillAirBlock(count, options.velocity, totals, vertical, block.a.data(), block.b.data(), block.c.data(),
+                  block.velocity.data(), block.cruise.data(), energy);
+
+    bool windy = !(options.windSpeed.kind == kUncertainFixed && options.windSpeed.first == 0.0);
+    if (!windy) {
+        return;
+    }
+    block.windSpeed.resize(count);
+    block.windDirection.resize(count);
+    block.windX.resize(count);
+    block.windY.resize(count);
+    block.windSquared.resize(count);
+    drawBlock(options.windSpeed, first, count, kStreamWindSpeed, options.seed, block.windSpeed.data());
+    drawBlock(options.windDirection, first, count, kStreamWindDirection, options.seed, block.windDirection.data());
+    for (std::size_t i = 0; i < count; ++i) {
+        double speed = block.windSpeed[i];
+        block.windX[i] = speed * std::cos(block.windDirection[i]);
+        block.windY[i] = speed * std::sin(block.windDirection[i]);
+        block.windSquared[i] = speed * speed;
+        energy[i] = energy[i] == HUGE_VAL ? HUGE_VAL : vertical;
+    }
+    for (std::size_t bin = 0; bin < kMonteCarloHeadingBins; ++bin) {
+        if (route.binDistance[bin] == 0.0) {
+            continue;
+        }
+        windBinBlock(count, route.binDistance[bin], route.binAltitudeDistance[bin], route.binTrackX[bin],
+                     route.binTrackY[bin], block.velocity.data(), block.cruise.data(), block.b.data(),
+                     block.windX.data(), block.windY.data(), block.windSquared.data(), energy);
+    }
+}
+
+} // namespace
+
+MonteCarloRoute makeMonteCarloRoute(const double* x, const double* y, const double* z, std::size_t n) {
+    return makeMonteCarloRouteImpl(x, y, z, n);
+}
+
+MonteCarloRoute makeMonteCarloRoute(const float* x, const float* y, const float* z, std::size_t n) {
+    return makeMonteCarloRouteImpl(x, y, z, n);
+}
+
+MonteCarloRoute makeMonteCarloRoute(const WaypointSoA& path) {
+    return makeMonteCarloRouteImpl(path.x.data(), path.y.data(), path.z.data(), path.size());
+}
+
+void sampleRouteEnergy(const MonteCarloRoute& route, const MonteCarloOptions& options,
+                       std::vector<double>& energies) {
+    EAD_STATS_TIMER("monte_carlo");
+    EAD_STATS_COUNT("monte_carlo_samples", options.samples);
+    std::size_t samples = options.samples;
+    energies.resize(samples);
+    std::size_t blockSize = std::max<std::size_t>(options.blockSize, 1);
+    std::size_t blocks = (samples + blockSize - 1) / blockSize;
+    auto run = [&](std::size_t firstBlock, std::size_t lastBlock) {
+        SampleBlock block;
+        for (std::size_t k = firstBlock; k < lastBlock; ++k) {
+            std::size_t begin = k * blockSize;
+            std::size_t count = std::min(blockSize, samples - begin);
+            evaluateBlock(route, options, begin, count, block, energies.data() + begin);
+        }
+    };
+    if (blocks > 1) {
+        ThreadPool& pool = options.pool ? *options.pool : defaultThreadPool();
+        pool.parallelFor(0, blocks, 1, run);
+    } else if (blocks == 1) {
+        run(0, 1);
+    }
+}
+
+double energyPercentile(std::vector<double>& energies, double q) {
+    if (energies.empty()) {
+        return 0.0;
+    }
+    double rank = std::ceil(q * double(energies.size()));
+    std::size_t index = rank < 1.0 ? 0 : std::min(static_cast<std::size_t>(rank) - 1, energies.size() - 1);
+    std::nth_element(energies.begin(), energies.begin() + index, energies.end());
+    return energies[index];
+}
+
+MonteCarloResult runMonteCarlo(const MonteCarloRoute& route, const MonteCarloOptions& options,
+                               std::vector<double>* energies) {
+    std::vector<double> local;
+    std::vector<double>& values = energies ? *energies : local;
+    sampleRouteEnergy(route, options, values);
+
+    MonteCarloResult result;
+    result.samples = values.size();
+    result.infeasible = 0;
+    result.minimum = HUGE_VAL;
+    result.maximum = -HUGE_VAL;
+    double sum = 0.0;
+    for (double& e : values) {
+        if (!std::isfinite(e)) {
+            // NaN would leave the percentile ordering undefined
+            e = HUGE_VAL;
+            ++result.infeasible;
+            continue;
+        }
+        sum += e;
+        result.minimum = std::min(result.minimum, e);
+        result.maximum = std::max(result.maximum, e);
+    }
+    std::size_t feasible = result.samples - result.infeasible;
+    result.mean = feasible > 0 ? sum / double(feasible) : 0.0;
+    double squares = 0.0;
+    for (double e : values) {
+        if (std::isfinite(e)) {
+            squares += (e - result.mean) * (e - result.mean);
+        }
+    }
+    result.standardDeviation = feasible > 1 ? std::sqrt(squares / double(feasible - 1)) : 0.0;
+    if (feasible == 0) {
+        result.minimum = result.maximum = 0.0;
+    }
+
+    // Percentiles reorder, so keep the caller's samples in sample order
+    std::vector<double> copy;
+    if (energies) {
+        copy = values;
+    }
+    std::vector<double>& ranked = energies ? copy : values;
+    result.p50 = energyPercentile(ranked, 0.50);
+    result.p95 = energyPercentile(ranked, 0.95);
+    result.p99 = energyPercentile(ranked, 0.99);
+    return result;
+}
@@ -0,0 +1,130 @@
+#ifndef EAD_MONTE_CARLO_HXX
+#define EAD_MONTE_CARLO_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "EAD_PathSoA.hxx"
+#include "EAD_Sweep.hxx"
+
+class ThreadPool;
+
+// Monte Carlo Energy Uncertainty
+// =========================================================
+// The coefficients a, b, c are estimates (battery aging, payload
+// mass), and so is the wind. runMonteCarlo() draws N samples of
+// (a, b, c) and optionally a uniform wind, evaluates the route energy
+// for each, and reports the distribution:
+//
+//   samples ----> [ sample 0 | sample 1 | ... | sample N-1 ]
+//                     |           |                 |
+//   Philox(i, q) -> a, b, c, wind speed, wind direction
+//                     |           |                 |
+//   route model  -> E_0        E_1      ...      E_N-1  -> p50 p95 p99
+//
+// Sampling
+// -------------------------------------------------------------
+// Sample i, quantity q draws from philox4x32((i, q, 0, 0), seed)
+// (EAD_Philox.hxx), so each value depends only on (seed, i, q): the
+// result is the same for any thread count or block size, and
+// enabling wind does not change the coefficient draws. Normal values
+// use Box-Muller on the block's two 53-bit uniforms.
+//
+// Route model
+// -------------------------------------------------------------
+// Route energy is linear in a, b, c for fixed legs (EAD_Sweep.hxx), so
+// one pass builds the aggregates and each sample costs O(1):
+//
+//   E = a * v^2 * SD + b * SH + c * SD + climb * SU + descent * SW
+//
+// With wind w (horizontal, constant over the route) every ground meter
+// of a leg along unit track t takes v / s meters of air, with ground
+// speed s = t.w + sqrt(v^2 - |w|^2 + (t.w)^2) as in EAD_WindField.hxx.
+// That depends on the leg heading, so legs are binned by heading into
+// kMonteCarloHeadingBins bins holding SD, SH and the summed track
+// (sum dx, sum dy); each bin's t.w uses its distance-weighted mean
+// track. Per sample the cost is then O(bins), and a sample with a leg
+// the wind makes unflyable (no real s > 0) has infinite energy and
+// counts as infeasible, as does a coefficient draw with a <= 0 or,
+// at the optimal speed (velocity 0), b / 2a < 0. Normal draws can
+// produce those; kUncertainLogNormal keeps a and b positive. Against per-leg evaluation the binned energy
+// is within about 2e-4 relative for winds up to 60% of the airspeed on
+// a random-walk route.
+//
+// The sample loops run over structure-of-arrays blocks (a[], b[],
+// wind[] ...), bins outer and samples inner, so the energy loop
+// vectorizes over samples. Blocks run on the thread pool.
+// =========================================================
+
+static const std::size_t kMonteCarloHeadingBins = 64;
+
+enum UncertainKind {
+    kUncertainFixed,     // first
+    kUncertainNormal,    // mean first, standard deviation second
+    kUncertainUniform,   // in [first, second)
+    kUncertainLogNormal  // median first, sigma of the log second (stays > 0)
+};
+
+struct UncertainValue {
+    UncertainKind kind;
+    double first;
+    double second;
+
+    UncertainValue(double value = 0.0) : kind(kUncertainFixed), first(value), second(0.0) {}
+    UncertainValue(UncertainKind k, double p0, double p1) : kind(k), first(p0), second(p1) {}
+};
+
+struct MonteCarloOptions {
+    UncertainValue a, b, c;
+    UncertainValue windSpeed;     // m/s; fixed 0 = still air
+    UncertainValue windDirection; // Radians from +x the wind blows toward
+    double velocity;              // Airspeed; 0 = findOptimalSpeedAndAltitude() per sample
+    double climbCoefficient;      // Per-segment model climb term
+    double descentCoefficient;    // Per-segment model descent term
+    std::size_t samples;
+    std::uint64_t seed;
+    std::size_t blockSize;        // Samples per task (does not change the result)
+    ThreadPool* pool;             // nullptr = defaultThreadPool()
+
+    MonteCarloOptions()
+        : windDirection(kUncertainUniform, 0.0, 6.283185307179586), velocity(0.0), climbCoefficient(0.5),
+          descentCoefficient(0.0), samples(100000), seed(1), blockSize(16384), pool(nullptr) {}
+};
+
+// Route aggregates plus the per-heading bins for the wind model
+struct MonteCarloRoute {
+    RouteAggregates totals;
+    std::vector<double> binDistance;         // SD per bin
+    std::vector<double> binAltitudeDistance; // SH per bin
+    std::vector<double> binTrackX;           // Mean unit track per bin (distance-weighted)
+    std::vector<double> binTrackY;
+};
+
+MonteCarloRoute makeMonteCarloRoute(const double* x, const double* y, const double* z, std::size_t n);
+MonteCarloRoute makeMonteCarloRoute(const float* x, const float* y, const float* z, std::size_t n);
+MonteCarloRoute makeMonteCarloRoute(const WaypointSoA& path);
+
+struct MonteCarloResult {
+    std::size_t samples;
+    std::size_t infeasible; // Samples with no finite energy (wind, or a / b draws, see above)
+    double mean;            // Over feasible samples
+    double standardDeviation;
+    double minimum;
+    double maximum;         // Of the feasible samples
+    double p50, p95, p99;   // Nearest rank over all samples (+inf counts as highest)
+};
+
+// Energy of every sample, in sample order
+void sampleRouteEnergy(const MonteCarloRoute& route, const MonteCarloOptions& options,
+                       std::vector<double>& energies);
+
+// Nearest-rank percentile (0 < q <= 1); reorders 'energies'
+double energyPercentile(std::vector<double>& energies, double q);
+
+// Draws, evaluates and summarizes; 'energies' (optional) receives the
+// samples in sample order
+MonteCarloResult runMonteCarlo(const MonteCarloRoute& route, const MonteCarloOptions& options,
+                               std::vector<double>* energies = nullptr);
+
+#endif // EAD_MONTE_CARLO_HXX
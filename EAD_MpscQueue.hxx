@@ -0,0 +1,89 @@
+#ifndef EAD_MPSC_QUEUE_HXX
+#define EAD_MPSC_QUEUE_HXX
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Lock-Free Multi-Producer Inbox
+// =========================================================
+// Any number of threads push(); one consumer drain()s everything
+// pushed so far, oldest first:
+//
+//   producers:  push(c)   push(b)   push(a)
+//                  \         |         /
+//   head_ --> [c] --> [b] --> [a] --> null     (CAS on head_)
+//
+//   consumer:   exchange(head_, null), reverse --> a b c
+//
+// push() is one CAS loop (lock-free; a producer only retries when
+// another producer got in first). The consumer takes the whole list
+// in one exchange and never unlinks single nodes, so there is no ABA
+// problem and no node is touched by two threads after it is published.
+// FIFO holds per producer; pushes from different threads are ordered
+// by when their CAS succeeded.
+// =========================================================
+
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(nullptr) {}
+
+    ~MpscQueue() {
+        Node* node = head_.load(std::memory_order_acquire);
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        node->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+    // Consumer only: append everything pushed so far to 'out', oldest
+    // first; returns the number of values taken
+    std::size_t drain(std::vector<T>& out) {
+        Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+        Node* reversed = nullptr;
+        std::size_t count = 0;
+        while (node) {
+            Node* next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
+            ++count;
+        }
+        out.reserve(out.size() + count);
+        while (reversed) {
+            Node* next = reversed->next;
+            out.push_back(std::move(reversed->value));
+            delete reversed;
+            reversed = next;
+        }
+        return count;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+
+        explicit Node(T v) : value(std::move(v)), next(nullptr) {}
+    };
+
+    std::atomic<Node*> head_;
+};
+
+#endif // EAD_MPSC_QUEUE_HXX
@@ -0,0 +1,105 @@
+#include "EAD_ParallelReduce.hxx"
+
+#include <algorithm>
+#include <vector>
+
+#include "EAD_ThreadPool.hxx"
+
+namespace {
+
+SegmentEnergyTotals operator+(const SegmentEnergyTotals& l, const SegmentEnergyTotals& r) {
+    SegmentEnergyTotals sum = {l.distance + r.distance, l.energy + r.energy};
+    return sum;
+}
+
+// Fixed pairwise tree: (p0 + p1) + (p2 + p3), ... regardless of who
+// computed the partials
+template <typename Partial>
+Partial combinePairwise(std::vector<Partial>& partials) {
+    std::size_t m = partials.size();
+    for (std::size_t step = 1; step < m; step *= 2) {
+        for (std::size_t i = 0; i + step < m; i += 2 * step) {
+            partials[i] = partials[i] + partials[i + step];
+        }
+    }
+    return partials[0];
+}
+
+// Evaluate chunk(firstPoint, pointCount) for every chunk and reduce
+template <typename Partial, typename Chunk>
+Partial reduceSegments(std::size_t n, const ParallelReduceOptions& options, Partial zero, Chunk chunk) {
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    if (segments == 0) {
+        return zero;
+    }
+    std::size_t chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+    std::size_t chunks = (segments + chunkSize - 1) / chunkSize;
+    std::vector<Partial> partials(chunks, zero);
+
+    auto body = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            std::size_t first = c * chunkSize;
+            std::size_t count = std::min(chunkSize, segments - first);
+            partials[c] = chunk(first, count + 1);
+        }
+    };
+    if (segments < options.serialThreshold || chunks == 1) {
+        body(0, chunks);
+    } else {
+        ThreadPool& pool = options.pool ? *options.pool : defaultThreadPool();
+        pool.parallelFor(0, chunks, 1, body);
+    }
+    return combinePairwise(partials);
+}
+
+template <typename T>
+double totalPathLengthParallelImpl(const T* x, const T* y, const T* z, std::size_t n,
+                                   const ParallelReduceOptions& options) {
+    return reduceSegments(n, options, 0.0, [&](std::size_t first, std::size_t count) {
+        return totalPathLength(x + first, y + first, z + first, count);
+    });
+}
+
+template <typename T>
+SegmentEnergyTotals evaluateSegmentTotalsParallelImpl(const T* x, const T* y, const T* z, std::size_t n,
+                                                      const SegmentEnergyParams& params,
+                                                      const ParallelReduceOptions& options) {
+    SegmentEnergyTotals zero = {0.0, 0.0};
+    return reduceSegments(n, options, zero, [&](std::size_t first, std::size_t count) {
+        return evaluateSegmentTotals(x + first, y + first, z + first, count, params);
+    });
+}
+
+} // namespace
+
+double totalPathLengthParallel(const double* x, const double* y, const double* z, std::size_t n,
+                               const ParallelReduceOptions& options) {
+    return totalPathLengthParallelImpl(x, y, z, n, options);
+}
+
+double totalPathLengthParallel(const float* x, const float* y, const float* z, std::size_t n,
+                               const ParallelReduceOptions& options) {
+    return totalPathLengthParallelImpl(x, y, z, n, options);
+}
+
+double totalPathLengthParallel(const WaypointSoA& path, const ParallelReduceOptions& options) {
+    return totalPathLengthParallelImpl(path.x.data(), path.y.data(), path.z.data(), path.size(), options);
+}
+
+SegmentEnergyTotals evaluateSegmentTotalsParallel(const double* x, const double* y, const double* z,
+                                                  std::size_t n, const SegmentEnergyParams& params,
+                                                  const ParallelReduceOptions& options) {
+    return evaluateSegmentTotalsParallelImpl(x, y, z, n, params, options);
+}
+
+SegmentEnergyTotals evaluateSegmentTotalsParallel(const float* x, const float* y, const float* z,
+                                                  std::size_t n, const SegmentEnergyParams& params,
+                                                  const ParallelReduceOptions& options) {
+    return evaluateSegmentTotalsParallelImpl(x, y, z, n, params, options);
+}
+
+SegmentEnergyTotals evaluateSegmentTotalsParallel(const WaypointSoA& path, const SegmentEnergyParams& params,
+                                                  const ParallelReduceOptions& options) {
+    return evaluateSegmentTotalsParallelImpl(path.x.data(), path.y.data(), path.z.data(), path.size(),
+                                             params, options);
+}
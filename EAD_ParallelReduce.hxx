@@ -0,0 +1,61 @@
+#ifndef EAD_PARALLEL_REDUCE_HXX
+#define EAD_PARALLEL_REDUCE_HXX
+
+#include <cstddef>
+
+#include "EAD_PathSoA.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+class ThreadPool;
+
+// Deterministic Parallel Route Reduction
+// =========================================================
+// Segments are cut into fixed-size chunks that do not depend on the
+// number of threads:
+//
+//   segments: [ chunk 0 | chunk 1 | chunk 2 | chunk 3 | chunk 4 ]
+//                  |         |         |         |         |
+//   partials:     p0        p1        p2        p3        p4
+//                   \      /            \      /          |
+//                   p0 + p1             p2 + p3           p4
+//                         \            /                  |
+//                          \__________/                   |
+//                               \_________________________/
+//                                        total
+//
+// Each chunk is evaluated with the usual (SIMD) kernels; threads only
+// decide who computes which chunk. The partials are then combined in
+// a fixed pairwise tree, so the result is bit-identical for 1 or 64
+// threads, and the rounding error grows with log2(chunks) rather than
+// with the segment count.
+//
+// Routes shorter than serialThreshold segments are evaluated on the
+// calling thread (same chunks, same tree, same result) since the
+// fork/join cost would exceed the work.
+// =========================================================
+
+struct ParallelReduceOptions {
+    ThreadPool* pool;            // nullptr = defaultThreadPool()
+    std::size_t chunkSize;       // Segments per chunk; fixes the result
+    std::size_t serialThreshold; // Below this many segments, stay on one thread
+
+    ParallelReduceOptions() : pool(nullptr), chunkSize(32768), serialThreshold(262144) {}
+};
+
+double totalPathLengthParallel(const double* x, const double* y, const double* z, std::size_t n,
+                               const ParallelReduceOptions& options = ParallelReduceOptions());
+double totalPathLengthParallel(const float* x, const float* y, const float* z, std::size_t n,
+                               const ParallelReduceOptions& options = ParallelReduceOptions());
+double totalPathLengthParallel(const WaypointSoA& path,
+                               const ParallelReduceOptions& options = ParallelReduceOptions());
+
+SegmentEnergyTotals evaluateSegmentTotalsParallel(const double* x, const double* y, const double* z,
+                                                  std::size_t n, const SegmentEnergyParams& params,
+                                                  const ParallelReduceOptions& options = ParallelReduceOptions());
+SegmentEnergyTotals evaluateSegmentTotalsParallel(const float* x, const float* y, const float* z,
+                                                  std::size_t n, const SegmentEnergyParams& params,
+                                                  const ParallelReduceOptions& options = ParallelReduceOptions());
+SegmentEnergyTotals evaluateSegmentTotalsParallel(const WaypointSoA& path, const SegmentEnergyParams& params,
+                                                  const ParallelReduceOptions& options = ParallelReduceOptions());
+
+#endif // EAD_PARALLEL_REDUCE_HXX
@@ -0,0 +1,315 @@
+#include "EAD_Pareto.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
+
+#include "EAD_Stats.hxx"
+#include "EAD_ThreadPool.hxx"
+
+namespace {
+
+typedef std::vector<ParetoPoint> Front;
+
+// Per-run constants: the surviving speeds as per-meter (time, cruise
+// energy) pairs, fastest first, and the levels
+struct ParetoModel {
+    std::vector<double> unitTime;   // 1 / v
+    std::vector<double> unitEnergy; // a * v^2 + c
+    std::vector<double> offsets;
+    double b;
+    double climb;
+    double descent;
+    std::size_t maxFront;
+
+    std::size_t levels() const { return offsets.size(); }
+
+    // Energy to change altitude from one offset to another
+    double transition(double from, double to) const {
+        double dz = to - from;
+        return dz > 0.0 ? climb * dz : -descent * dz;
+    }
+};
+
+struct ParetoScratch {
+    Front merged;
+    Front next;
+    std::vector<Front> copies;
+};
+
+// out = a (+) shift(b, dt, de), both sorted by (time, energy), keeping
+// only labels whose energy is below every faster one
+void mergePrune(const Front& a, const Front& b, double dt, double de, Front& out) {
+    out.clear();
+    out.reserve(a.size() + b.size());
+    std::size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        ParetoPoint p;
+        if (j == b.size()) {
+            p = a[i++];
+        } else {
+            ParetoPoint q = {b[j].time + dt, b[j].energy + de};
+            if (i < a.size() && (a[i].time < q.time || (a[i].time == q.time && a[i].energy <= q.energy))) {
+                p = a[i++];
+            } else {
+                p = q;
+                ++j;
+            }
+        }
+        if (out.empty() || p.energy < out.back().energy) {
+            out.push_back(p);
+        }
+    }
+}
+
+// acc = acc (+) shift(b, dt, de)
+void mergeInto(Front& acc, const Front& b, double dt, double de, Front& scratch) {
+    if (b.empty()) {
+        return;
+    }
+    mergePrune(acc, b, dt, de, scratch);
+    acc.swap(scratch);
+}
+
+// Keep at most 'limit' labels about evenly spaced in time, always the
+// fastest and the cheapest (front ends). Every interior label kept
+// passes a distinct grid time below the last label's, so at most
+// limit - 2 of them survive.
+void thin(Front& front, std::size_t limit) {
+    if (front.size() <= limit) {
+        return;
+    }
+    double first = front.front().time;
+    double step = (front.back().time - first) / double(limit - 1);
+    double next = first + step;
+    std::size_t kept = 1;
+    for (std::size_t i = 1; i + 1 < front.size(); ++i) {
+        if (front[i].time >= next) {
+            front[kept++] = front[i];
+            while (next <= front[i].time) {
+                next += step;
+            }
+        }
+    }
+    front[kept++] = front.back();
+    front.resize(kept);
+}
+
+// Labels arriving ready to fly level k: every level's front plus the
+// cost of changing to k
+void gatherLevel(const ParetoModel& model, const std::vector<Front>& fronts, std::size_t k, Front& out,
+                 Front& scratch) {
+    out.clear();
+    for (std::size_t j = 0; j < model.levels(); ++j) {
+        mergeInto(out, fronts[j], 0.0, model.transition(model.offsets[j], model.offsets[k]), scratch);
+    }
+}
+
+// out = front (+) the leg's speed options, thinned. The m shifted
+// copies are merged as a balanced tree (log2(m) passes over the
+// labels) rather than one after another.
+void flyLeg(const ParetoModel& model, const Front& in, double length, double base, Front& out,
+            ParetoScratch& scratch) {
+    std::vector<Front>& copies = scratch.copies;
+    std::size_t count = model.unitTime.size();
+    copies.resize(std::max(copies.size(), count));
+    for (std::size_t s = 0; s < count; ++s) {
+        double dt = length * model.unitTime[s];
+        double de = length * model.unitEnergy[s] + base;
+        copies[s].resize(in.size());
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            copies[s][i].time = in[i].time + dt;
+            copies[s][i].energy = in[i].energy + de;
+        }
+    }
+    for (std::size_t width = 1; width < count; width *= 2) {
+        for (std::size_t s = 0; s + width < count; s += 2 * width) {
+            mergePrune(copies[s], copies[s + width], 0.0, 0.0, scratch.next);
+            copies[s].swap(scratch.next);
+        }
+    }
+    out.swap(copies[0]);
+    thin(out, model.maxFront);
+}
+
+// Legs [0, count) of a chunk into table[i * L + k]: entered at level
+// i, last leg flown at level k. The first chunk starts from the route
+// at offset 0 instead, so its table is the single row i = 0 with the
+// climb to each first level included. 'base[l]' is the leg energy
+// without the speed term and without the offset.
+void solveChunk(const ParetoModel& model, const double* lengths, const double* base, const double* altitudeScale,
+                std::size_t count, bool fromStart, std::vector<Front>& table) {
+    std::size_t levels = model.levels();
+    std::size_t rows = fromStart ? 1 : levels;
+    table.assign(rows * levels, Front());
+    std::vector<Front> current(levels), next(levels);
+    ParetoScratch scratch;
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t k = 0; k < levels; ++k) {
+            current[k].clear();
+            if (fromStart || k == row) {
+                Front origin(1, ParetoPoint{0.0, fromStart ? model.transition(0.0, model.offsets[k]) : 0.0});
+                flyLeg(model, origin, lengths[0], base[0] + altitudeScale[0] * model.offsets[k], current[k],
+                       scratch);
+            }
+        }
+        for (std::size_t l = 1; l < count; ++l) {
+            for (std::size_t k = 0; k < levels; ++k) {
+                gatherLevel(model, current, k, scratch.merged, scratch.next);
+                flyLeg(model, scratch.merged, lengths[l], base[l] + altitudeScale[l] * model.offsets[k], next[k],
+                       scratch);
+            }
+            current.swap(next);
+        }
+        for (std::size_t k = 0; k < levels; ++k) {
+            table[row * levels + k].swap(current[k]);
+        }
+    }
+}
+
+// left = left then right: across the boundary the exit level j of
+// 'left' changes to the entry level j' of 'right'
+void combineTables(const ParetoModel& model, std::vector<Front>& left, const std::vector<Front>& right) {
+    std::size_t levels = model.levels();
+    std::size_t rows = left.size() / levels;
+    std::vector<Front> combined(rows * levels);
+    Front ready, scratch;
+    for (std::size_t i = 0; i < rows; ++i) {
+        std::vector<Front> exits(left.begin() + i * levels, left.begin() + (i + 1) * levels);
+        for (std::size_t entry = 0; entry < levels; ++entry) {
+            gatherLevel(model, exits, entry, ready, scratch);
+            for (std::size_t k = 0; k < levels; ++k) {
+                Front& out = combined[i * levels + k];
+                for (const ParetoPoint& p : ready) {
+                    mergeInto(out, right[entry * levels + k], p.time, p.energy, scratch);
+                }
+            }
+        }
+        for (std::size_t k = 0; k < levels; ++k) {
+            thin(combined[i * levels + k], model.maxFront);
+        }
+    }
+    left.swap(combined);
+}
+
+ParetoModel makeModel(const EnergyCoefficients& coeffs, const ParetoOptions& options) {
+    ParetoModel model;
+    std::vector<double> velocities = options.velocities.empty() ? defaultParetoVelocities(coeffs)
+                                                                : options.velocities;
+    velocities.erase(std::remove_if(velocities.begin(), velocities.end(),
+                                    [](double v) { return !(v > 0.0) || !std::isfinite(v); }),
+                     velocities.end());
+    std::sort(velocities.begin(), velocities.end(), [](double a, double b) { return a > b; });
+    for (double v : velocities) {
+        double time = 1.0 / v;
+        double energy = energyConsumption(v, 0.0, coeffs);
+        // Slower must be cheaper per meter, or the speed is never worth it
+        if (model.unitTime.empty() || (time > model.unitTime.back() && energy < model.unitEnergy.back())) {
+            model.unitTime.push_back(time);
+            model.unitEnergy.push_back(energy);
+        }
+    }
+    model.offsets = options.altitudeOffsets.empty() ? std::vector<double>(1, 0.0) : options.altitudeOffsets;
+    model.b = coeffs.b;
+    model.climb = options.climbCoefficient;
+    model.descent = options.descentCoefficient;
+    model.maxFront = std::max<std::size_t>(options.maxFrontSize, 2);
+    return model;
+}
+
+// Lengths through the batched kernel, then the offset-free part of
+// each leg's energy (altitude and vertical terms)
+template <typename T>
+void solveRange(const ParetoModel& model, const T* x, const T* y, const T* z, std::size_t begin,
+                std::size_t count, std::vector<Front>& table) {
+    std::vector<double> lengths(count), base(count), altitudeScale(count);
+    segmentLengths(x + begin, y + begin, z + begin, count + 1, lengths.data());
+    for (std::size_t l = 0; l < count; ++l) {
+        double z0 = double(z[begin + l]), z1 = double(z[begin + l + 1]);
+        altitudeScale[l] = model.b * lengths[l];
+        base[l] = altitudeScale[l] * 0.5 * (z0 + z1) + model.transition(z0, z1);
+    }
+    solveChunk(model, lengths.data(), base.data(), altitudeScale.data(), count, begin == 0, table);
+}
+
+template <typename T>
+std::vector<ParetoPoint> paretoFrontImpl(const T* x, const T* y, const T* z, std::size_t n,
+                                         const EnergyCoefficients& coeffs, const ParetoOptions& options) {
+    EAD_STATS_TIMER("pareto");
+    ParetoModel model = makeModel(coeffs, options);
+    if (model.unitTime.empty()) {
+        return Front();
+    }
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    if (segments == 0) {
+        return Front(1, ParetoPoint{0.0, 0.0});
+    }
+    EAD_STATS_COUNT("pareto_legs", segments);
+
+    std::size_t chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+    std::size_t chunks = (segments + chunkSize - 1) / chunkSize;
+    std::vector<std::vector<Front> > tables(chunks);
+    auto solve = [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last; ++c) {
+            std::size_t begin = c * chunkSize;
+            solveRange(model, x, y, z, begin, std::min(chunkSize, segments - begin), tables[c]);
+        }
+    };
+    ThreadPool& pool = options.pool ? *options.pool : defaultThreadPool();
+    if (chunks > 1) {
+        pool.parallelFor(0, chunks, 1, solve);
+    } else {
+        solve(0, 1);
+    }
+
+    // Fixed pairwise tree, independent of the thread count
+    for (std::size_t width = 1; width < chunks; width *= 2) {
+        std::size_t pairs = (chunks - width + 2 * width - 1) / (2 * width);
+        pool.parallelFor(0, pairs, 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t p = first; p < last; ++p) {
+                std::size_t c = p * 2 * width;
+                combineTables(model, tables[c], tables[c + width]);
+                std::vector<Front>().swap(tables[c + width]);
+            }
+        });
+    }
+
+    // Back down to the route at the end
+    Front front, scratch;
+    for (std::size_t k = 0; k < model.levels(); ++k) {
+        mergeInto(front, tables[0][k], 0.0, model.transition(model.offsets[k], 0.0), scratch);
+    }
+    thin(front, model.maxFront);
+    return front;
+}
+
+} // namespace
+
+std::vector<double> defaultParetoVelocities(const EnergyCoefficients& coeffs) {
+    double optimal = std::get<0>(findOptimalSpeedAndAltitude(coeffs.a, coeffs.b));
+    std::vector<double> velocities;
+    if (!(optimal > 0.0) || !std::isfinite(optimal)) {
+        return velocities;
+    }
+    const int kSteps = 8;
+    for (int s = 0; s < kSteps; ++s) {
+        velocities.push_back(optimal * std::pow(2.0, -1.0 + 2.0 * s / (kSteps - 1)));
+    }
+    return velocities;
+}
+
+std::vector<ParetoPoint> paretoFront(const double* x, const double* y, const double* z, std::size_t n,
+                                     const EnergyCoefficients& coeffs, const ParetoOptions& options) {
+    return paretoFrontImpl(x, y, z, n, coeffs, options);
+}
+
+std::vector<ParetoPoint> paretoFront(const float* x, const float* y, const float* z, std::size_t n,
+                                     const EnergyCoefficients& coeffs, const ParetoOptions& options) {
+    return paretoFrontImpl(x, y, z, n, coeffs, options);
+}
+
+std::vector<ParetoPoint> paretoFront(const WaypointSoA& path, const EnergyCoefficients& coeffs,
+                                     const ParetoOptions& options) {
+    return paretoFrontImpl(path.x.data(), path.y.data(), path.z.data(), path.size(), coeffs, options);
+}
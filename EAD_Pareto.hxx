@@ -0,0 +1,102 @@
+#ifndef EAD_PARETO_HXX
+#define EAD_PARETO_HXX
+
+#include <cstddef>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_PathSoA.hxx"
+
+class ThreadPool;
+
+// Time vs. Energy Pareto Front per Route
+// =========================================================
+// findOptimalSpeedAndAltitude() minimizes energy alone; with a
+// deadline the question is what the fastest route costs at each
+// flight time. Every leg i picks a speed v from 'velocities' and a
+// level k from 'altitudeOffsets' (added to both ends of the leg):
+//
+//   time_i   = d_i / v
+//   energy_i = d_i * (a * v^2 + b * (mean(h_i) + offset_k) + c)
+//            + climb / descent over the leg (unchanged by the offset)
+//
+// and changing level between legs (and from / back to offset 0 at the
+// two ends of the route) costs climb or descent energy for the step.
+// The result is every (total time, total energy) that no other choice
+// beats in both, fastest first:
+//
+//   energy
+//     |  *
+//     |    *
+//     |       *  *                  * = reported plans
+//     |              *    *     *
+//     +--------------------------------- time
+//
+// Labels and pruning
+// -------------------------------------------------------------
+// A front (sorted by time, energy strictly falling) is kept per level.
+// Each leg merges the L level fronts with their transition costs,
+// adds the leg's speed options (m shifted copies of a sorted front,
+// merged pairwise) and drops every dominated label as it merges.
+// A front longer than maxFrontSize is thinned to points about evenly
+// spaced in time, always keeping the fastest and the cheapest; the
+// result is then an inner approximation (every point reported is a
+// real plan) instead of the exact front.
+//
+// Parallel chunks
+// -------------------------------------------------------------
+// Legs are cut into chunks of chunkSize. Each chunk is solved on the
+// pool into an L x L table of fronts (entry level x exit level; the
+// first chunk starts at offset 0 and has one row), and the tables are
+// combined in a fixed pairwise tree, by Minkowski sums of fronts
+// across each chunk boundary:
+//
+//   chunk 0   chunk 1   chunk 2   chunk 3
+//       \      /            \      /
+//      T0 (+) T1           T2 (+) T3
+//            \______________/
+//                  front
+//
+// Chunks do not depend on the thread count, so neither does the
+// result. One chunk costs O(legs * L^2 * m * F) for F = maxFrontSize,
+// and L times that when it has L entry rows, so splitting pays once
+// there are more threads than levels; routes of at most chunkSize
+// legs stay on the calling thread.
+// =========================================================
+
+struct ParetoPoint {
+    double time;   // Flight time, seconds
+    double energy; // Energy units
+};
+
+struct ParetoOptions {
+    std::vector<double> velocities;      // Candidate speeds; empty = defaultParetoVelocities()
+    std::vector<double> altitudeOffsets; // Candidate levels, meters above the waypoints
+    double climbCoefficient;             // Per-segment model climb term
+    double descentCoefficient;           // Per-segment model descent term
+    std::size_t maxFrontSize;            // Labels kept per front (>= 2)
+    std::size_t chunkSize;               // Legs per parallel chunk; fixes the result
+    ThreadPool* pool;                    // nullptr = defaultThreadPool()
+
+    ParetoOptions()
+        : altitudeOffsets(1, 0.0), climbCoefficient(0.5), descentCoefficient(0.0), maxFrontSize(64),
+          chunkSize(4096), pool(nullptr) {}
+};
+
+// 0.5x .. 2x the energy-optimal speed of findOptimalSpeedAndAltitude()
+// in 8 steps; empty when that speed is not positive
+std::vector<double> defaultParetoVelocities(const EnergyCoefficients& coeffs);
+
+// Front of the route [0, n), fastest first. Speeds that are not
+// positive are ignored; with none left the front is empty. A route
+// with fewer than two waypoints has the single point (0, 0).
+std::vector<ParetoPoint> paretoFront(const double* x, const double* y, const double* z, std::size_t n,
+                                     const EnergyCoefficients& coeffs,
+                                     const ParetoOptions& options = ParetoOptions());
+std::vector<ParetoPoint> paretoFront(const float* x, const float* y, const float* z, std::size_t n,
+                                     const EnergyCoefficients& coeffs,
+                                     const ParetoOptions& options = ParetoOptions());
+std::vector<ParetoPoint> paretoFront(const WaypointSoA& path, const EnergyCoefficients& coeffs,
+                                     const ParetoOptions& options = ParetoOptions());
+
+#endif // EAD_PARETO_HXX
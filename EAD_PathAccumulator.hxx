@@ -0,0 +1,105 @@
+#ifndef EAD_PATH_ACCUMULATOR_HXX
+#define EAD_PATH_ACCUMULATOR_HXX
+
+#include <cmath>
+#include <cstddef>
+
+#include "EAD_Core.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+// Streaming Path Evaluation for Live Telemetry
+// =========================================================
+// Waypoints / GPS fixes are pushed one at a time as the drone flies:
+//
+//   fix 0 ---> fix 1 ---> fix 2 ---> ... ---> fix k   (only fix k kept)
+//          d1,E1      d2,E2               dk,Ek
+//
+//   totalDistance = d1 + d2 + ... + dk
+//   totalEnergy   = E1 + E2 + ... + Ek
+//
+// Each append() adds one leg with the same math as distance() and
+// legEnergy() and then forgets the previous fix, so appends are O(1)
+// and memory is a few dozen bytes per drone regardless of flight
+// length. Sums are Neumaier-compensated so millions of short legs
+// (50 Hz for hours) don't drift from the batch evaluator.
+//
+// Not synchronized: one accumulator per drone, appended and read from
+// the thread that owns that drone's telemetry.
+// =========================================================
+
+struct PathSnapshot {
+    std::size_t waypointCount;
+    double totalDistance;
+    double totalEnergy;
+    Waypoint lastWaypoint; // Only meaningful when waypointCount > 0
+};
+
+class PathAccumulator {
+public:
+    explicit PathAccumulator(const SegmentEnergyParams& params)
+        : params_(params), cruise_(cruiseEnergyPerMeter(params.velocity, params)) {
+        reset();
+    }
+
+    // Add the next fix, flown at the configured cruise velocity
+    void append(const Waypoint& wp) { appendLeg(wp, cruise_); }
+
+    // Add the next fix with the velocity measured over the leg
+    void append(const Waypoint& wp, double velocity) {
+        appendLeg(wp, cruiseEnergyPerMeter(velocity, params_));
+    }
+
+    void reset() {
+        count_ = 0;
+        distance_.reset();
+        energy_.reset();
+        last_.x = last_.y = last_.z = 0.0;
+    }
+
+    PathSnapshot snapshot() const {
+        PathSnapshot snap;
+        snap.waypointCount = count_;
+        snap.totalDistance = distance_.value();
+        snap.totalEnergy = energy_.value();
+        snap.lastWaypoint = last_;
+        return snap;
+    }
+
+    std::size_t waypointCount() const { return count_; }
+    double totalDistance() const { return distance_.value(); }
+    double totalEnergy() const { return energy_.value(); }
+
+private:
+    // Neumaier compensated sum: value = sum + compensation
+    struct CompensatedSum {
+        double sum;
+        double compensation;
+
+        void reset() { sum = compensation = 0.0; }
+        void add(double x) {
+            double t = sum + x;
+            compensation += std::fabs(sum) >= std::fabs(x) ? (sum - t) + x : (x - t) + sum;
+            sum = t;
+        }
+        double value() const { return sum + compensation; }
+    };
+
+    void appendLeg(const Waypoint& wp, double cruise) {
+        if (count_ > 0) {
+            double d = distance(last_, wp);
+            distance_.add(d);
+            energy_.add(legEnergy(d, last_.z, wp.z, cruise, params_));
+        }
+        last_ = wp;
+        ++count_;
+    }
+
+    SegmentEnergyParams params_;
+    double cruise_;
+    std::size_t count_;
+    CompensatedSum distance_;
+    CompensatedSum energy_;
+    Waypoint last_;
+};
+
+#endif // EAD_PATH_ACCUMULATOR_HXX
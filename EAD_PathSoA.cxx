@@ -0,0 +1,316 @@
+#include "EAD_PathSoA.hxx"
+
+#include <cmath>
+
+#include "EAD_CpuDispatch.hxx"
+#include "EAD_Stats.hxx"
+
+#if defined(EAD_SIMD_AVX2) || defined(EAD_SIMD_AVX512)
+#include <immintrin.h>
+#endif
+#if defined(EAD_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+WaypointSoA toSoA(const std::vector<Waypoint>& waypoints) {
+    WaypointSoA path;
+    path.reserve(waypoints.size());
+    for (size_t i = 0; i < waypoints.size(); ++i) {
+        path.push_back(waypoints[i]);
+    }
+    return path;
+}
+
+// Scalar reference
+// -------------------------------------------------------------
+// Same formula as distance(), with explicit products instead of
+// std::pow(..., 2) so the compiler can keep everything in registers.
+// T is double or float; the math is always done in double.
+// -------------------------------------------------------------
+template <typename T>
+static void segmentLengthsScalarImpl(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+    for (size_t i = 0; i + 1 < n; ++i) {
+        double dx = double(x[i + 1]) - double(x[i]);
+        double dy = double(y[i + 1]) - double(y[i]);
+        double dz = double(z[i + 1]) - double(z[i]);
+        out[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+}
+
+template <typename T>
+static double totalPathLengthScalarImpl(const T* x, const T* y, const T* z, std::size_t n) {
+    double total = 0.0;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        double dx = double(x[i + 1]) - double(x[i]);
+        double dy = double(y[i + 1]) - double(y[i]);
+        double dz = double(z[i + 1]) - double(z[i]);
+        total += std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+    return total;
+}
+
+void segmentLengthsScalar(const double* x, const double* y, const double* z,
+                          std::size_t n, double* out) {
+    segmentLengthsScalarImpl(x, y, z, n, out);
+}
+
+double totalPathLengthScalar(const double* x, const double* y, const double* z, std::size_t n) {
+    return totalPathLengthScalarImpl(x, y, z, n);
+}
+
+void segmentLengthsScalar(const float* x, const float* y, const float* z,
+                          std::size_t n, double* out) {
+    segmentLengthsScalarImpl(x, y, z, n, out);
+}
+
+double totalPathLengthScalar(const float* x, const float* y, const float* z, std::size_t n) {
+    return totalPathLengthScalarImpl(x, y, z, n);
+}
+
+#if defined(EAD_SIMD_AVX2)
+
+// AVX2 kernels: 4 segments per iteration
+// -------------------------------------------------------------
+//   a = load(x + i)      -> x[i]   .. x[i+3]
+//   b = load(x + i + 1)  -> x[i+1] .. x[i+4]
+//   dx = b - a           -> 4 segment deltas at once
+// -------------------------------------------------------------
+// Multiplies and adds are kept separate (no FMA), matching the
+// order of operations of the scalar reference.
+// -------------------------------------------------------------
+EAD_TARGET_AVX2 static inline __m256d load4(const double* p) { return _mm256_loadu_pd(p); }
+EAD_TARGET_AVX2 static inline __m256d load4(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+
+template <typename T>
+EAD_TARGET_AVX2 static inline __m256d segmentLengths4(const T* x, const T* y, const T* z, size_t i) {
+    __m256d dx = _mm256_sub_pd(load4(x + i + 1), load4(x + i));
+    __m256d dy = _mm256_sub_pd(load4(y + i + 1), load4(y + i));
+    __m256d dz = _mm256_sub_pd(load4(z + i + 1), load4(z + i));
+    __m256d sq = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)),
+                               _mm256_mul_pd(dz, dz));
+    return _mm256_sqrt_pd(sq);
+}
+
+template <typename T>
+EAD_TARGET_AVX2 static void segmentLengthsAvx2(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+    if (n < 2) {
+        return;
+    }
+    size_t segments = n - 1;
+    size_t i = 0;
+    for (; i + 4 <= segments; i += 4) {
+        _mm256_storeu_pd(out + i, segmentLengths4(x, y, z, i));
+    }
+    segmentLengthsScalarImpl(x + i, y + i, z + i, n - i, out + i);
+}
+
+template <typename T>
+EAD_TARGET_AVX2 static double totalPathLengthAvx2(const T* x, const T* y, const T* z, std::size_t n) {
+    if (n < 2) {
+        return 0.0;
+    }
+    size_t segments = n - 1;
+    size_t i = 0;
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= segments; i += 8) {
+        acc0 = _mm256_add_pd(acc0, segmentLengths4(x, y, z, i));
+        acc1 = _mm256_add_pd(acc1, segmentLengths4(x, y, z, i + 4));
+    }
+    for (; i + 4 <= segments; i += 4) {
+        acc0 = _mm256_add_pd(acc0, segmentLengths4(x, y, z, i));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    return total + totalPathLengthScalarImpl(x + i, y + i, z + i, n - i);
+}
+
+#endif
+
+#if defined(EAD_SIMD_AVX512)
+
+// AVX-512 kernels: 8 segments per iteration, same scheme as AVX2
+EAD_TARGET_AVX512 static inline __m512d load8(const double* p) { return _mm512_loadu_pd(p); }
+EAD_TARGET_AVX512 static inline __m512d load8(const float* p) { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }
+
+template <typename T>
+EAD_TARGET_AVX512 static inline __m512d segmentLengths8(const T* x, const T* y, const T* z, size_t i) {
+    __m512d dx = _mm512_sub_pd(load8(x + i + 1), load8(x + i));
+    __m512d dy = _mm512_sub_pd(load8(y + i + 1), load8(y + i));
+    __m512d dz = _mm512_sub_pd(load8(z + i + 1), load8(z + i));
+    __m512d sq = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)),
+                               _mm512_mul_pd(dz, dz));
+    return _mm512_sqrt_pd(sq);
+}
+
+template <typename T>
+EAD_TARGET_AVX512 static void segmentLengthsAvx512(const T* x, const T* y, const T* z, std::size_t n,
+                                                   double* out) {
+    if (n < 2) {
+        return;
+    }
+    size_t segments = n - 1;
+    size_t i = 0;
+    for (; i + 8 <= segments; i += 8) {
+        _mm512_storeu_pd(out + i, segmentLengths8(x, y, z, i));
+    }
+    segmentLengthsScalarImpl(x + i, y + i, z + i, n - i, out + i);
+}
+
+template <typename T>
+EAD_TARGET_AVX512 static double totalPathLengthAvx512(const T* x, const T* y, const T* z, std::size_t n) {
+    if (n < 2) {
+        return 0.0;
+    }
+    size_t segments = n - 1;
+    size_t i = 0;
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    for (; i + 16 <= segments; i += 16) {
+        acc0 = _mm512_add_pd(acc0, segmentLengths8(x, y, z, i));
+        acc1 = _mm512_add_pd(acc1, segmentLengths8(x, y, z, i + 8));
+    }
+    for (; i + 8 <= segments; i += 8) {
+        acc0 = _mm512_add_pd(acc0, segmentLengths8(x, y, z, i));
+    }
+    double lanes[8];
+    _mm512_storeu_pd(lanes, _mm512_add_pd(acc0, acc1));
+    double total = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    return total + totalPathLengthScalarImpl(x + i, y + i, z + i, n - i);
+}
+
+#endif
+
+#if defined(EAD_SIMD_NEON)
+
+// NEON kernels: 2 segments per iteration (AArch64 float64x2_t)
+static inline float64x2_t load2(const double* p) { return vld1q_f64(p); }
+static inline float64x2_t load2(const float* p) { return vcvt_f64_f32(vld1_f32(p)); }
+
+template <typename T>
+static inline float64x2_t segmentLengths2(const T* x, const T* y, const T* z, size_t i) {
+    float64x2_t dx = vsubq_f64(load2(x + i + 1), load2(x + i));
+    float64x2_t dy = vsubq_f64(load2(y + i + 1), load2(y + i));
+    float64x2_t dz = vsubq_f64(load2(z + i + 1), load2(z + i));
+    float64x2_t sq = vaddq_f64(vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)), vmulq_f64(dz, dz));
+    return vsqrtq_f64(sq);
+}
+
+template <typename T>
+static void segmentLengthsNeon(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+    if (n < 2) {
+        return;
+    }
+    size_t segments = n - 1;
+    size_t i = 0;
+    for (; i + 2 <= segments; i += 2) {
+        vst1q_f64(out + i, segmentLengths2(x, y, z, i));
+    }
+    segmentLengthsScalarImpl(x + i, y + i, z + i, n - i, out + i);
+}
+
+template <typename T>
+static double totalPathLengthNeon(const T* x, const T* y, const T* z, std::size_t n) {
+    if (n < 2) {
+        return 0.0;
+    }
+    size_t segments = n - 1;
+    size_t i = 0;
+    float64x2_t acc0 = vdupq_n_f64(0.0);
+    float64x2_t acc1 = vdupq_n_f64(0.0);
+    for (; i + 4 <= segments; i += 4) {
+        acc0 = vaddq_f64(acc0, segmentLengths2(x, y, z, i));
+        acc1 = vaddq_f64(acc1, segmentLengths2(x, y, z, i + 2));
+    }
+    for (; i + 2 <= segments; i += 2) {
+        acc0 = vaddq_f64(acc0, segmentLengths2(x, y, z, i));
+    }
+    double total = vaddvq_f64(vaddq_f64(acc0, acc1));
+    return total + totalPathLengthScalarImpl(x + i, y + i, z + i, n - i);
+}
+
+#endif
+
+// Kernel selection (EAD_CpuDispatch.hxx)
+template <typename T>
+static void segmentLengthsImpl(const T* x, const T* y, const T* z, std::size_t n, double* out) {
+    switch (simdLevel()) {
+#if defined(EAD_SIMD_AVX512)
+    case kSimdAvx512:
+        segmentLengthsAvx512(x, y, z, n, out);
+        return;
+#endif
+#if defined(EAD_SIMD_AVX2)
+    case kSimdAvx2:
+        segmentLengthsAvx2(x, y, z, n, out);
+        return;
+#endif
+#if defined(EAD_SIMD_NEON)
+    case kSimdNeon:
+        segmentLengthsNeon(x, y, z, n, out);
+        return;
+#endif
+    default:
+        segmentLengthsScalarImpl(x, y, z, n, out);
+        return;
+    }
+}
+
+template <typename T>
+static double totalPathLengthImpl(const T* x, const T* y, const T* z, std::size_t n) {
+    switch (simdLevel()) {
+#if defined(EAD_SIMD_AVX512)
+    case kSimdAvx512:
+        return totalPathLengthAvx512(x, y, z, n);
+#endif
+#if defined(EAD_SIMD_AVX2)
+    case kSimdAvx2:
+        return totalPathLengthAvx2(x, y, z, n);
+#endif
+#if defined(EAD_SIMD_NEON)
+    case kSimdNeon:
+        return totalPathLengthNeon(x, y, z, n);
+#endif
+    default:
+        return totalPathLengthScalarImpl(x, y, z, n);
+    }
+}
+
+const char* pathKernelName() { return simdLevelName(simdLevel()); }
+
+void segmentLengths(const double* x, const double* y, const double* z,
+                    std::size_t n, double* out) {
+    segmentLengthsImpl(x, y, z, n, out);
+}
+
+double totalPathLength(const double* x, const double* y, const double* z, std::size_t n) {
+    EAD_STATS_TIMER("path_length");
+    EAD_STATS_COUNT("path_length_waypoints", n);
+    return totalPathLengthImpl(x, y, z, n);
+}
+
+void segmentLengths(const float* x, const float* y, const float* z,
+                    std::size_t n, double* out) {
+    segmentLengthsImpl(x, y, z, n, out);
+}
+
+double totalPathLength(const float* x, const float* y, const float* z, std::size_t n) {
+    EAD_STATS_TIMER("path_length");
+    EAD_STATS_COUNT("path_length_waypoints", n);
+    return totalPathLengthImpl(x, y, z, n);
+}
+
+void segmentLengths(const WaypointSoA& path, double* out) {
+    segmentLengths(path.x.data(), path.y.data(), path.z.data(), path.size(), out);
+}
+
+std::vector<double> segmentLengths(const WaypointSoA& path) {
+    std::vector<double> out(path.size() > 1 ? path.size() - 1 : 0);
+    segmentLengths(path, out.data());
+    return out;
+}
+
+double totalPathLength(const WaypointSoA& path) {
+    return totalPathLength(path.x.data(), path.y.data(), path.z.data(), path.size());
+}
@@ -0,0 +1,96 @@
+#ifndef EAD_PATH_SOA_HXX
+#define EAD_PATH_SOA_HXX
+
+#include <cstddef>
+#include <vector>
+
+#include "EAD_Core.hxx"
+
+// Structure-of-Arrays Waypoint Container
+// =========================================================
+// std::vector<Waypoint> stores x, y, z interleaved:
+//   [x0 y0 z0][x1 y1 z1][x2 y2 z2] ...
+//
+// WaypointSoA stores each coordinate in its own buffer:
+//   x: [x0 x1 x2 ...]
+//   y: [y0 y1 y2 ...]
+//   z: [z0 z1 z2 ...]
+//
+// so the batched kernels below can load 8 (AVX-512), 4 (AVX2) or
+// 2 (NEON) consecutive waypoints per coordinate with one instruction.
+// =========================================================
+struct WaypointSoA {
+    std::vector<double> x, y, z;
+
+    std::size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+
+    void reserve(std::size_t n) {
+        x.reserve(n);
+        y.reserve(n);
+        z.reserve(n);
+    }
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+    }
+
+    void push_back(const Waypoint& wp) {
+        x.push_back(wp.x);
+        y.push_back(wp.y);
+        z.push_back(wp.z);
+    }
+
+    Waypoint operator[](std::size_t i) const {
+        Waypoint wp = {x[i], y[i], z[i]};
+        return wp;
+    }
+};
+
+// Convert an array-of-structs route into the SoA layout
+WaypointSoA toSoA(const std::vector<Waypoint>& waypoints);
+
+// Batched segment lengths
+// -------------------------------------------------------------
+// For n waypoints there are n - 1 segments:
+//   out[i] = distance(wp[i], wp[i + 1]),  0 <= i < n - 1
+// 'out' must have room for n - 1 values (nothing is written if n < 2).
+// -------------------------------------------------------------
+void segmentLengths(const double* x, const double* y, const double* z,
+                    std::size_t n, double* out);
+void segmentLengths(const WaypointSoA& path, double* out);
+std::vector<double> segmentLengths(const WaypointSoA& path);
+
+// Batched total path length
+// -------------------------------------------------------------
+//   totalPathLength = sum of segmentLengths
+// The SIMD kernels keep one partial sum per lane, so the result may
+// differ from the scalar reference in the last few ulps.
+// -------------------------------------------------------------
+double totalPathLength(const double* x, const double* y, const double* z, std::size_t n);
+double totalPathLength(const WaypointSoA& path);
+
+// Single-precision input (e.g. a float32 mapped route file)
+// -------------------------------------------------------------
+// Coordinates are widened to double before differencing, so the
+// results match the double kernels run on the widened values.
+// -------------------------------------------------------------
+void segmentLengths(const float* x, const float* y, const float* z,
+                    std::size_t n, double* out);
+double totalPathLength(const float* x, const float* y, const float* z, std::size_t n);
+
+// Scalar reference kernels (same math as distance(), one segment at a time)
+void segmentLengthsScalar(const double* x, const double* y, const double* z,
+                          std::size_t n, double* out);
+double totalPathLengthScalar(const double* x, const double* y, const double* z, std::size_t n);
+void segmentLengthsScalar(const float* x, const float* y, const float* z,
+                          std::size_t n, double* out);
+double totalPathLengthScalar(const float* x, const float* y, const float* z, std::size_t n);
+
+// Name of the kernel selected for this CPU ("avx512", "avx2", "neon" or
+// "scalar"; see EAD_CpuDispatch.hxx)
+const char* pathKernelName();
+
+#endif // EAD_PATH_SOA_HXX
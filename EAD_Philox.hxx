@@ -0,0 +1,55 @@
+#ifndef EAD_PHILOX_HXX
+#define EAD_PHILOX_HXX
+
+#include <cstdint>
+
+// Philox4x32-10 Counter-Based Generator
+// =========================================================
+// A keyed bijection of a 128-bit counter (Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3", SC'11). There is no state to
+// advance:
+//
+//   philox4x32(counter, key) -> 4 x 32 random bits
+//
+//   counter = (sample, stream, 0, 0)   key = seed
+//
+// so sample i's numbers are the same whichever thread draws them, in
+// any order, and a parallel run splits with no jump-ahead or seeding
+// per thread. Ten rounds of two 32 x 32 -> 64 multiplies each; the
+// round function is branch-free, so loops over counters vectorize.
+// Output matches the Random123 known-answer tests (counter 0, key 0
+// gives 6627e8d5 e169c58d bc57ac4c 9b00dbd8).
+// =========================================================
+
+struct Philox4x32 {
+    std::uint32_t v[4];
+};
+
+inline Philox4x32 philox4x32(Philox4x32 counter, std::uint32_t key0, std::uint32_t key1) {
+    const std::uint32_t kMultiplier0 = 0xD2511F53u;
+    const std::uint32_t kMultiplier1 = 0xCD9E8D57u;
+    const std::uint32_t kWeyl0 = 0x9E3779B9u;
+    const std::uint32_t kWeyl1 = 0xBB67AE85u;
+    for (int round = 0; round < 10; ++round) {
+        std::uint64_t product0 = std::uint64_t(kMultiplier0) * counter.v[0];
+        std::uint64_t product1 = std::uint64_t(kMultiplier1) * counter.v[2];
+        Philox4x32 next;
+        next.v[0] = std::uint32_t(product1 >> 32) ^ counter.v[1] ^ key0;
+        next.v[1] = std::uint32_t(product1);
+        next.v[2] = std::uint32_t(product0 >> 32) ^ counter.v[3] ^ key1;
+        next.v[3] = std::uint32_t(product0);
+        counter = next;
+        key0 += kWeyl0;
+        key1 += kWeyl1;
+    }
+    return counter;
+}
+
+// Uniform double in (0, 1) from 64 random bits (53 significant bits,
+// never exactly 0 or 1, so log() and 1 / u are safe)
+inline double philoxUniform(std::uint32_t high, std::uint32_t low) {
+    std::uint64_t bits = (std::uint64_t(high) << 32 | low) >> 11;
+    return (double(bits) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+#endif // EAD_PHILOX_HXX
@@ -0,0 +1,154 @@
+#ifndef EAD_PRECISION_HXX
+#define EAD_PRECISION_HXX
+
+#include <cstddef>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_FixedPoint.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+// Reduced-Precision Route Evaluation
+// =========================================================
+// evaluateRoute<T>() is the per-segment model of EAD_SegmentEnergy.hxx
+// written once over the scalar type, for builds that cannot use double:
+//
+//   cruise = energyConsumption(v, 0, a, 0, c)           (once per route)
+//   E_leg  = d * (cruise + b * (z0 + z1) / 2) + climb/descent term
+//
+// Only the inputs (coordinates, coefficients) are rounded to T up
+// front; all per-leg math then runs in T. Totals are summed per
+// ScalarTraits<T>::Accumulator:
+//
+//   double    plain double sum; bit-identical to evaluateSegments()
+//   float     compensated (Kahan) float sum, so the total does not
+//             drift with the number of legs
+//   Fixed16   exact 64-bit integer sum (Fixed16Accumulator)
+//
+// Error bounds against the double reference
+// -------------------------------------------------------------
+// u = 2^-24 (float unit roundoff), q = 2^-16 (Q16.16 step), X = the
+// largest |coordinate| after convertWaypoints(), n = waypoint count,
+// E = energy per meter (a v^2 + b h + c).
+//
+//                 float                      Q16.16
+//   coordinate    X * u                      q / 2
+//   leg length    2 sqrt(3) X u + 3 u d      sqrt(3) q + q / 2
+//                                            (<= 3.4e-5 m)
+//   E per meter   4 u E                      (q / 2)(v^2 + h + 3)
+//                                            + 2 q (a v + b)
+//   leg energy    d * dE + E * dd + 2 u d E  d * dE + E * dd + q
+//   route total   sum of leg errors + 2 u    sum of leg errors
+//                 * total                    (sum is exact)
+//
+// In words: float is good to about 1e-7 relative as long as the
+// coordinates are local (X of a few km keeps the length term at the
+// millimeter level). Q16.16 has a fixed absolute step, so its relative
+// error is set by how far the coefficients are from a multiple of q;
+// for the demo model (a = 0.1, b = 0.05, c = 10, h ~ 100 m) rounding
+// b dominates at 2e-5 .. 5e-5 relative, ~0.2 units on the 7489 unit
+// demo mission. Both are far below the model's own uncertainty.
+// The bounds are worst cases; ead_bench's BM_EvaluateRouteScalar
+// labels report the measured error on its random-walk routes.
+//
+// Range limits (Q16.16): |coordinate| and altitude < 16384 m after
+// convertWaypoints() (so z0 + z1 fits), leg energy < 32768; values
+// beyond saturate rather than wrap.
+// =========================================================
+
+template <typename T>
+struct ScalarTraits;
+
+template <>
+struct ScalarTraits<double> {
+    struct Accumulator {
+        double sum;
+
+        Accumulator() : sum(0.0) {}
+        Accumulator& operator+=(double value) {
+            sum += value;
+            return *this;
+        }
+        double toDouble() const { return sum; }
+    };
+    static constexpr const char* name() { return "double"; }
+};
+
+template <>
+struct ScalarTraits<float> {
+    // Kahan summation: 'compensation' carries the low bits each add
+    // loses. Needs strict IEEE float evaluation (no -ffast-math).
+    struct Accumulator {
+        float sum;
+        float compensation;
+
+        Accumulator() : sum(0.0f), compensation(0.0f) {}
+        Accumulator& operator+=(float value) {
+            float y = value - compensation;
+            float t = sum + y;
+            compensation = (t - sum) - y;
+            sum = t;
+            return *this;
+        }
+        double toDouble() const { return double(sum); }
+    };
+    static constexpr const char* name() { return "float"; }
+};
+
+template <>
+struct ScalarTraits<Fixed16> {
+    using Accumulator = Fixed16Accumulator;
+    static constexpr const char* name() { return "q16.16"; }
+};
+
+// Round a double route to T; 'origin' x / y are subtracted first to
+// keep coordinates small. z is kept absolute: the altitude term needs it.
+template <typename T>
+std::vector<BasicWaypoint<T>> convertWaypoints(const std::vector<Waypoint>& waypoints,
+                                               const Waypoint& origin = Waypoint{0.0, 0.0, 0.0}) {
+    std::vector<BasicWaypoint<T>> out(waypoints.size());
+    for (std::size_t i = 0; i < waypoints.size(); ++i) {
+        out[i].x = T(waypoints[i].x - origin.x);
+        out[i].y = T(waypoints[i].y - origin.y);
+        out[i].z = T(waypoints[i].z);
+    }
+    return out;
+}
+
+template <typename T>
+struct BasicRouteTotals {
+    typename ScalarTraits<T>::Accumulator distance;
+    typename ScalarTraits<T>::Accumulator energy;
+};
+
+template <typename T>
+BasicRouteTotals<T> evaluateRoute(const BasicWaypoint<T>* waypoints, std::size_t n,
+                                  const SegmentEnergyParams& params) {
+    const T zero(0.0);
+    const T half(0.5);
+    const T b = static_cast<T>(params.coeffs.b);
+    const T climb = static_cast<T>(params.climbCoefficient);
+    const T descent = static_cast<T>(params.descentCoefficient);
+    const T cruise = energyConsumption(T(params.velocity), zero, T(params.coeffs.a), zero, T(params.coeffs.c));
+
+    BasicRouteTotals<T> totals;
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        const BasicWaypoint<T>& from = waypoints[i];
+        const BasicWaypoint<T>& to = waypoints[i + 1];
+        T length = distance(from, to);
+        T meanAltitude = half * (from.z + to.z);
+        T dz = to.z - from.z;
+        T verticalEnergy = dz > zero ? climb * dz : -(descent * dz);
+        totals.distance += length;
+        totals.energy += length * (cruise + b * meanAltitude) + verticalEnergy;
+    }
+    return totals;
+}
+
+template <typename T>
+BasicRouteTotals<T> evaluateRoute(const std::vector<BasicWaypoint<T>>& waypoints,
+                                  const SegmentEnergyParams& params) {
+    return evaluateRoute(waypoints.data(), waypoints.size(), params);
+}
+
+#endif // EAD_PRECISION_HXX
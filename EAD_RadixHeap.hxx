@@ -0,0 +1,105 @@
+#ifndef EAD_RADIX_HEAP_HXX
+#define EAD_RADIX_HEAP_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Monotone Radix Heap
+// =========================================================
+// Priority queue for searches whose extracted keys never decrease
+// (Dijkstra, A* with a consistent heuristic). Items live in 65 buckets
+// by the highest bit in which their key differs from the last key
+// popped:
+//
+//   bucket 0        key == last
+//   bucket k        2^(k-1) <= (key XOR last) < 2^k
+//
+// pop() refills bucket 0 by taking the lowest non-empty bucket,
+// finding its minimum and redistributing it; each item moves to a
+// lower bucket at most 64 times, so operations are amortized O(1)
+// with push / pop touching only the ends of small vectors.
+//
+// Keys below the last popped key are clamped up to it (the caller's
+// keys are quantized costs, so that is rounding, not reordering).
+// =========================================================
+
+template <typename Value>
+class RadixHeap {
+public:
+    struct Item {
+        std::uint64_t key;
+        Value value;
+    };
+
+    RadixHeap() : last_(0), size_(0) {}
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    void clear() {
+        for (std::vector<Item>& bucket : buckets_) {
+            bucket.clear();
+        }
+        last_ = 0;
+        size_ = 0;
+    }
+
+    void push(std::uint64_t key, const Value& value) {
+        if (key < last_) {
+            key = last_;
+        }
+        Item item = {key, value};
+        buckets_[bucketOf(key)].push_back(item);
+        ++size_;
+    }
+
+    // Smallest key; only valid when !empty()
+    std::uint64_t minKey() {
+        refill();
+        return last_;
+    }
+
+    // Remove and return an item with the smallest key; only valid when !empty()
+    Item pop() {
+        refill();
+        Item item = buckets_[0].back();
+        buckets_[0].pop_back();
+        --size_;
+        return item;
+    }
+
+private:
+    std::size_t bucketOf(std::uint64_t key) const {
+        return key == last_ ? 0 : 64 - static_cast<std::size_t>(__builtin_clzll(key ^ last_));
+    }
+
+    void refill() {
+        if (!buckets_[0].empty()) {
+            return;
+        }
+        std::size_t i = 1;
+        while (buckets_[i].empty()) {
+            ++i;
+        }
+        std::uint64_t minimum = buckets_[i][0].key;
+        for (const Item& item : buckets_[i]) {
+            minimum = item.key < minimum ? item.key : minimum;
+        }
+        last_ = minimum;
+        // Every item of bucket i lands in a bucket below i
+        std::vector<Item> moving;
+        moving.swap(buckets_[i]);
+        for (const Item& item : moving) {
+            buckets_[bucketOf(item.key)].push_back(item);
+        }
+        moving.clear();
+        moving.swap(buckets_[i]); // Keep the capacity for the next refill
+    }
+
+    std::vector<Item> buckets_[65];
+    std::uint64_t last_;
+    std::size_t size_;
+};
+
+#endif // EAD_RADIX_HEAP_HXX
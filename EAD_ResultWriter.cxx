@@ -0,0 +1,419 @@
+#include "EAD_ResultWriter.hxx"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "EAD_Batch.hxx"
+#include "EAD_Stats.hxx"
+
+namespace {
+
+const char kCsvHeader[] = "kind,id,leg,distance,velocity,energy,message\n";
+const char kBinaryMagic[4] = {'E', 'A', 'D', 'R'};
+const std::uint32_t kBinaryVersion = 1;
+
+enum BinaryRecord : unsigned char { kBinaryMission = 1, kBinarySegment = 2, kBinaryError = 3 };
+
+// Longest to_chars() output for a double in any of the formats used
+const std::size_t kNumberChars = 32;
+
+// Worst-case encoded size of a string field: CSV doubles quotes,
+// JSON writes control characters as \u00XX
+std::size_t fieldBound(const std::string& text) { return 6 * text.size() + 2; }
+
+bool needsCsvQuotes(const std::string& field) {
+    return field.find_first_of(",\"\r\n") != std::string::npos;
+}
+
+} // namespace
+
+bool parseResultFormat(const std::string& name, ResultFormat& format) {
+    if (name == "text") {
+        format = kResultText;
+    } else if (name == "csv") {
+        format = kResultCsv;
+    } else if (name == "jsonl") {
+        format = kResultJsonLines;
+    } else if (name == "binary") {
+        format = kResultBinary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+ResultWriter::ResultWriter()
+    : fd_(-1),
+      ownsFd_(false),
+      open_(false),
+      current_(nullptr),
+      queueHead_(0),
+      queueCount_(0),
+      stopping_(false),
+      queuedBytes_(0) {}
+
+ResultWriter::~ResultWriter() {
+    std::string ignored;
+    close(ignored);
+}
+
+bool ResultWriter::open(const std::string& path, const ResultWriterOptions& options, std::string& error) {
+    if (path == "-") {
+        open(STDOUT_FILENO, options);
+        return true;
+    }
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    open(fd, options);
+    ownsFd_ = true;
+    return true;
+}
+
+void ResultWriter::open(int fd, const ResultWriterOptions& options) {
+    std::string ignored;
+    close(ignored);
+    options_ = options;
+    options_.blockBytes = std::max<std::size_t>(options_.blockBytes, 4096);
+    options_.blocks = std::max<std::size_t>(options_.blocks, 2);
+    fd_ = fd;
+    ownsFd_ = false;
+    open_ = true;
+
+    blocks_.assign(options_.blocks, std::string());
+    free_.clear();
+    queue_.assign(options_.blocks, nullptr);
+    for (std::string& block : blocks_) {
+        block.reserve(options_.blockBytes);
+        free_.push_back(&block);
+    }
+    current_ = free_.back();
+    free_.pop_back();
+    queueHead_ = 0;
+    queueCount_ = 0;
+    stopping_ = false;
+    queuedBytes_ = 0;
+    writeError_.clear();
+    thread_ = std::thread([this] { writerLoop(); });
+
+    if (options_.format == kResultCsv) {
+        current_->append(kCsvHeader, sizeof(kCsvHeader) - 1);
+    } else if (options_.format == kResultBinary) {
+        appendRaw(kBinaryMagic, sizeof(kBinaryMagic));
+        appendU32(kBinaryVersion);
+    }
+}
+
+bool ResultWriter::close(std::string& error) {
+    if (!open_) {
+        return true;
+    }
+    if (!current_->empty()) {
+        submitCurrent();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    thread_.join();
+    open_ = false;
+
+    std::string failure = writeError_;
+    if (ownsFd_ && ::close(fd_) != 0 && failure.empty()) {
+        failure = std::string("close failed: ") + std::strerror(errno);
+    }
+    fd_ = -1;
+    ownsFd_ = false;
+    current_ = nullptr;
+    if (!failure.empty()) {
+        error = failure;
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t ResultWriter::bytesQueued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queuedBytes_;
+}
+
+void ResultWriter::reserve(std::size_t bytes) {
+    if (current_->size() + bytes > options_.blockBytes && !current_->empty()) {
+        submitCurrent();
+    }
+}
+
+void ResultWriter::submitCurrent() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_[(queueHead_ + queueCount_++) % queue_.size()] = current_;
+    queuedBytes_ += current_->size();
+    changed_.notify_all();
+    if (free_.empty()) {
+        EAD_STATS_TIMER("result_writer_stall");
+        changed_.wait(lock, [this] { return !free_.empty(); });
+    }
+    current_ = free_.back();
+    free_.pop_back();
+    current_->clear();
+}
+
+void ResultWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        changed_.wait(lock, [this] { return queueCount_ > 0 || stopping_; });
+        if (queueCount_ == 0) {
+            return; // Stopping with nothing left
+        }
+        std::string* block = queue_[queueHead_];
+        queueHead_ = (queueHead_ + 1) % queue_.size();
+        --queueCount_;
+        bool failed = !writeError_.empty();
+        lock.unlock();
+
+        std::string error;
+        if (!failed) {
+            EAD_STATS_TIMER("result_writer_write");
+            EAD_STATS_COUNT("result_writer_bytes", block->size());
+            const char* p = block->data();
+            std::size_t left = block->size();
+            while (left > 0) {
+                ssize_t written = ::write(fd_, p, left);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    error = std::string("write failed: ") + std::strerror(errno);
+                    break;
+                }
+                p += written;
+                left -= static_cast<std::size_t>(written);
+            }
+        }
+
+        lock.lock();
+        if (!error.empty()) {
+            writeError_ = error;
+        }
+        free_.push_back(block);
+        changed_.notify_all();
+    }
+}
+
+// Formatting helpers
+// -------------------------------------------------------------
+// Every record reserve()s its worst-case size first, so the helpers
+// append into spare capacity and the block never reallocates (unless
+// a single record is larger than a whole block).
+// -------------------------------------------------------------
+
+void ResultWriter::appendNumber(double value) {
+    char buffer[kNumberChars];
+    std::to_chars_result end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 10);
+    current_->append(buffer, end.ptr);
+}
+
+void ResultWriter::appendShortest(double value) {
+    char buffer[kNumberChars];
+    std::to_chars_result end = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    current_->append(buffer, end.ptr);
+}
+
+void ResultWriter::appendJsonNumber(double value) {
+    if (std::isfinite(value)) {
+        appendShortest(value);
+    } else {
+        current_->append("null", 4);
+    }
+}
+
+void ResultWriter::appendUnsigned(std::uint64_t value) {
+    char buffer[kNumberChars];
+    std::to_chars_result end = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    current_->append(buffer, end.ptr);
+}
+
+void ResultWriter::appendCsvField(const std::string& field) {
+    if (!needsCsvQuotes(field)) {
+        current_->append(field);
+        return;
+    }
+    current_->push_back('"');
+    for (char ch : field) {
+        if (ch == '"') {
+            current_->push_back('"');
+        }
+        current_->push_back(ch);
+    }
+    current_->push_back('"');
+}
+
+void ResultWriter::appendJsonString(const std::string& text) {
+    static const char kHex[] = "0123456789abcdef";
+    current_->push_back('"');
+    for (char ch : text) {
+        unsigned char byte = static_cast<unsigned char>(ch);
+        if (ch == '"' || ch == '\\') {
+            current_->push_back('\\');
+            current_->push_back(ch);
+        } else if (byte < 0x20) {
+            char escape[6] = {'\\', 'u', '0', '0', kHex[byte >> 4], kHex[byte & 0xf]};
+            current_->append(escape, sizeof(escape));
+        } else {
+            current_->push_back(ch);
+        }
+    }
+    current_->push_back('"');
+}
+
+void ResultWriter::appendRaw(const void* data, std::size_t size) {
+    current_->append(static_cast<const char*>(data), size);
+}
+
+void ResultWriter::appendU32(std::uint32_t value) {
+    char bytes[4];
+    for (int k = 0; k < 4; ++k) {
+        bytes[k] = static_cast<char>((value >> (8 * k)) & 0xff);
+    }
+    current_->append(bytes, sizeof(bytes));
+}
+
+void ResultWriter::appendF64(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char bytes[8];
+    for (int k = 0; k < 8; ++k) {
+        bytes[k] = static_cast<char>((bits >> (8 * k)) & 0xff);
+    }
+    current_->append(bytes, sizeof(bytes));
+}
+
+void ResultWriter::writeMission(const std::string& id, const MissionResult& result) {
+    reserve(fieldBound(id) + 3 * kNumberChars + 64);
+    switch (options_.format) {
+    case kResultText:
+        current_->append(id);
+        current_->push_back(' ');
+        appendNumber(result.totalDistance);
+        current_->push_back(' ');
+        appendNumber(result.optimalVelocity);
+        current_->push_back(' ');
+        appendNumber(result.totalEnergy);
+        current_->push_back('\n');
+        break;
+    case kResultCsv:
+        current_->append("mission,", 8);
+        appendCsvField(id);
+        current_->append(",,", 2);
+        appendShortest(result.totalDistance);
+        current_->push_back(',');
+        appendShortest(result.optimalVelocity);
+        current_->push_back(',');
+        appendShortest(result.totalEnergy);
+        current_->append(",\n", 2);
+        break;
+    case kResultJsonLines:
+        current_->append("{\"id\":", 6);
+        appendJsonString(id);
+        current_->append(",\"distance\":", 12);
+        appendJsonNumber(result.totalDistance);
+        current_->append(",\"velocity\":", 12);
+        appendJsonNumber(result.optimalVelocity);
+        current_->append(",\"energy\":", 10);
+        appendJsonNumber(result.totalEnergy);
+        current_->append("}\n", 2);
+        break;
+    case kResultBinary:
+        current_->push_back(static_cast<char>(kBinaryMission));
+        appendU32(static_cast<std::uint32_t>(id.size()));
+        current_->append(id);
+        appendF64(result.totalDistance);
+        appendF64(result.optimalVelocity);
+        appendF64(result.totalEnergy);
+        break;
+    }
+}
+
+void ResultWriter::writeSegment(const std::string& id, std::size_t leg, double length, double energy) {
+    reserve(fieldBound(id) + 3 * kNumberChars + 64);
+    switch (options_.format) {
+    case kResultText:
+        current_->append(id);
+        current_->append(" segment ", 9);
+        appendUnsigned(leg);
+        current_->push_back(' ');
+        appendNumber(length);
+        current_->push_back(' ');
+        appendNumber(energy);
+        current_->push_back('\n');
+        break;
+    case kResultCsv:
+        current_->append("segment,", 8);
+        appendCsvField(id);
+        current_->push_back(',');
+        appendUnsigned(leg);
+        current_->push_back(',');
+        appendShortest(length);
+        current_->append(",,", 2);
+        appendShortest(energy);
+        current_->append(",\n", 2);
+        break;
+    case kResultJsonLines:
+        current_->append("{\"id\":", 6);
+        appendJsonString(id);
+        current_->append(",\"leg\":", 7);
+        appendUnsigned(leg);
+        current_->append(",\"distance\":", 12);
+        appendJsonNumber(length);
+        current_->append(",\"energy\":", 10);
+        appendJsonNumber(energy);
+        current_->append("}\n", 2);
+        break;
+    case kResultBinary:
+        current_->push_back(static_cast<char>(kBinarySegment));
+        appendF64(length);
+        appendF64(energy);
+        break;
+    }
+}
+
+void ResultWriter::writeError(const std::string& id, const std::string& message) {
+    reserve(fieldBound(id) + fieldBound(message) + 64);
+    switch (options_.format) {
+    case kResultText:
+        current_->append(id);
+        current_->append(" error ", 7);
+        current_->append(message);
+        current_->push_back('\n');
+        break;
+    case kResultCsv:
+        current_->append("error,", 6);
+        appendCsvField(id);
+        current_->append(",,,,,", 5);
+        appendCsvField(message);
+        current_->push_back('\n');
+        break;
+    case kResultJsonLines:
+        current_->append("{\"id\":", 6);
+        appendJsonString(id);
+        current_->append(",\"error\":", 9);
+        appendJsonString(message);
+        current_->append("}\n", 2);
+        break;
+    case kResultBinary:
+        current_->push_back(static_cast<char>(kBinaryError));
+        appendU32(static_cast<std::uint32_t>(id.size()));
+        current_->append(id);
+        appendU32(static_cast<std::uint32_t>(message.size()));
+        current_->append(message);
+        break;
+    }
+}
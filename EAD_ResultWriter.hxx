@@ -0,0 +1,136 @@
+#ifndef EAD_RESULT_WRITER_HXX
+#define EAD_RESULT_WRITER_HXX
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct MissionResult;
+
+// Structured Result Writer
+// =========================================================
+// Formats batch results into large blocks and hands full blocks to a
+// background thread that write()s them to a file descriptor, so the
+// formatting thread never waits on the disk or the pipe:
+//
+//   caller:  format records --> [ block ] --full--> queue
+//                                  ^                  |
+//                                  |   free blocks    v
+//   writer thread:            <------------------- write(fd)
+//
+// 'blocks' buffers of 'blockBytes' rotate between the two; the caller
+// only stalls when every block is queued (the output device is slower
+// than the computation). Numbers go through std::to_chars into the
+// block, so once the blocks are allocated nothing else is.
+//
+// Formats (every mission record is followed by its segment records
+// when 'segments' is set; segment = leg i from waypoint i to i + 1)
+// -------------------------------------------------------------
+//   text    same lines as runBatch() on an ostream (%.10g):
+//             <id> <distance> <velocity> <energy>
+//             <id> segment <leg> <length> <energy>
+//             <id> error <message>
+//   csv     header "kind,id,leg,distance,velocity,energy,message", then
+//             mission,<id>,,<distance>,<velocity>,<energy>,
+//             segment,<id>,<leg>,<length>,,<energy>,
+//             error,<id>,,,,,<message>
+//           fields quoted (RFC 4180) only when they need it
+//   jsonl   one object per line:
+//             {"id":..,"distance":..,"velocity":..,"energy":..}
+//             {"id":..,"leg":..,"distance":..,"energy":..}
+//             {"id":..,"error":..}
+//           non-finite numbers are written as null
+//   binary  "EADR" + u32 version (1), then tagged records, little
+//           endian, unpadded:
+//             u8 1, u32 n, id[n], f64 distance, f64 velocity, f64 energy
+//             u8 2, f64 length, f64 energy     (leg of the last mission)
+//             u8 3, u32 n, id[n], u32 m, message[m]
+//
+// csv and jsonl print the shortest decimal that reads back to the same
+// double; text keeps 10 significant digits for compatibility.
+// =========================================================
+
+enum ResultFormat { kResultText, kResultCsv, kResultJsonLines, kResultBinary };
+
+// "text", "csv", "jsonl" or "binary"; returns false for anything else
+bool parseResultFormat(const std::string& name, ResultFormat& format);
+
+struct ResultWriterOptions {
+    ResultFormat format;
+    bool segments;          // Per-leg records after each mission (runBatch() computes them)
+    std::size_t blockBytes; // Bytes per write()
+    std::size_t blocks;     // Blocks in rotation
+
+    ResultWriterOptions() : format(kResultText), segments(false), blockBytes(1 << 20), blocks(4) {}
+};
+
+class ResultWriter {
+public:
+    ResultWriter();
+    ~ResultWriter(); // close(), discarding any error
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    // Create / truncate 'path' ("-" = standard output, left open) and
+    // start the writer thread; the format's header is queued at once
+    bool open(const std::string& path, const ResultWriterOptions& options, std::string& error);
+
+    // Same, on a descriptor the caller keeps ownership of
+    void open(int fd, const ResultWriterOptions& options);
+
+    const ResultWriterOptions& options() const { return options_; }
+
+    // Records; cheap, never block unless every block is queued
+    void writeMission(const std::string& id, const MissionResult& result);
+    void writeSegment(const std::string& id, std::size_t leg, double length, double energy);
+    void writeError(const std::string& id, const std::string& message);
+
+    // Flush, stop the thread and close the file; false (and 'error') if
+    // any write() failed. Safe to call twice.
+    bool close(std::string& error);
+
+    // Bytes handed to write() so far (excluding the block being filled)
+    std::uint64_t bytesQueued() const;
+
+private:
+    // Make room for at least 'bytes' in the current block
+    void reserve(std::size_t bytes);
+    void submitCurrent();
+    void writerLoop();
+
+    void appendNumber(double value);
+    void appendShortest(double value);
+    void appendJsonNumber(double value);
+    void appendUnsigned(std::uint64_t value);
+    void appendCsvField(const std::string& field);
+    void appendJsonString(const std::string& text);
+    void appendRaw(const void* data, std::size_t size);
+    void appendU32(std::uint32_t value);
+    void appendF64(double value);
+
+    ResultWriterOptions options_;
+    int fd_;
+    bool ownsFd_;
+    bool open_;
+
+    std::vector<std::string> blocks_;
+    std::string* current_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<std::string*> queue_; // Ring of full blocks, oldest at queueHead_
+    std::size_t queueHead_;
+    std::size_t queueCount_;
+    std::vector<std::string*> free_;
+    bool stopping_;
+    std::uint64_t queuedBytes_;
+    std::string writeError_;
+    std::thread thread_;
+};
+
+#endif // EAD_RESULT_WRITER_HXX
@@ -0,0 +1,88 @@
+#include "EAD_RouteBatch.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+#include "EAD_Stats.hxx"
+#include "EAD_ThreadPool.hxx"
+
+void PackedRouteBatch::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    offsets.assign(1, 0);
+    a.clear();
+    b.clear();
+    c.clear();
+    velocity.clear();
+}
+
+void PackedRouteBatch::append(const double* px, const double* py, const double* pz, std::size_t n,
+                              const EnergyCoefficients& coeffs, double routeVelocity) {
+    x.insert(x.end(), px, px + n);
+    y.insert(y.end(), py, py + n);
+    z.insert(z.end(), pz, pz + n);
+    offsets.push_back(offsets.back() + n);
+    a.push_back(coeffs.a);
+    b.push_back(coeffs.b);
+    c.push_back(coeffs.c);
+    velocity.push_back(routeVelocity);
+}
+
+void PackedRouteBatch::append(const WaypointSoA& path, const EnergyCoefficients& coeffs, double routeVelocity) {
+    append(path.x.data(), path.y.data(), path.z.data(), path.size(), coeffs, routeVelocity);
+}
+
+void scoreRouteBatch(const PackedRouteBatch& batch, const RouteBatchOptions& options,
+                     std::vector<SegmentEnergyTotals>& totals) {
+    EAD_STATS_TIMER("route_batch_cpu");
+    std::size_t routes = batch.routeCount();
+    EAD_STATS_COUNT("route_batch_routes", routes);
+    totals.resize(routes);
+    auto score = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            std::size_t first = batch.offsets[r];
+            SegmentEnergyParams params;
+            params.coeffs.a = batch.a[r];
+            params.coeffs.b = batch.b[r];
+            params.coeffs.c = batch.c[r];
+            params.velocity = batch.velocity[r];
+            params.climbCoefficient = options.climbCoefficient;
+            params.descentCoefficient = options.descentCoefficient;
+            totals[r] = evaluateSegmentTotals(batch.x.data() + first, batch.y.data() + first,
+                                              batch.z.data() + first, batch.offsets[r + 1] - first, params);
+        }
+    };
+    std::size_t grain = std::max<std::size_t>(options.grain, 1);
+    if (routes > grain) {
+        ThreadPool& pool = options.pool ? *options.pool : defaultThreadPool();
+        pool.parallelFor(0, routes, grain, score);
+    } else {
+        score(0, routes);
+    }
+}
+
+namespace {
+
+// Equal values (infinities included) and NaN on both sides agree;
+// NaN on one side is an infinite difference
+double relativeDifference(double expected, double actual) {
+    if (expected == actual || (std::isnan(expected) && std::isnan(actual))) {
+        return 0.0;
+    }
+    double difference = std::fabs(actual - expected) / std::max(std::fabs(expected), 1.0);
+    return difference >= 0.0 ? difference : HUGE_VAL;
+}
+
+} // namespace
+
+double maxRelativeDifference(const std::vector<SegmentEnergyTotals>& expected,
+                             const std::vector<SegmentEnergyTotals>& actual) {
+    double worst = expected.size() == actual.size() ? 0.0 : HUGE_VAL;
+    std::size_t n = std::min(expected.size(), actual.size());
+    for (std::size_t r = 0; r < n; ++r) {
+        worst = std::max(worst, relativeDifference(expected[r].distance, actual[r].distance));
+        worst = std::max(worst, relativeDifference(expected[r].energy, actual[r].energy));
+    }
+    return worst;
+}
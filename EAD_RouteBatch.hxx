@@ -0,0 +1,65 @@
+#ifndef EAD_ROUTE_BATCH_HXX
+#define EAD_ROUTE_BATCH_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_PathSoA.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+class ThreadPool;
+
+// Packed Route Batches
+// =========================================================
+// Many routes in one SoA buffer set, the layout the bulk scorers (CPU
+// below, GPU in EAD_RouteBatchGpu.hxx) take:
+//
+//   x, y, z   [ route 0 waypoints | route 1 waypoints | route 2 ... ]
+//   offsets   [ 0,  n0,  n0 + n1,  ...,  total ]       (routes + 1)
+//   a, b, c,
+//   velocity  [ r0 | r1 | r2 ... ]                     (one per route)
+//
+// Route r is waypoints [offsets[r], offsets[r + 1]); its totals are
+// those of evaluateSegmentTotals() with the route's coefficients and
+// velocity and the batch's climb / descent terms. Legs never cross a
+// route boundary, so one reduction per segment of the flat arrays
+// gives every route's totals.
+// =========================================================
+
+struct PackedRouteBatch {
+    std::vector<double> x, y, z;
+    std::vector<std::uint64_t> offsets;
+    std::vector<double> a, b, c, velocity;
+
+    PackedRouteBatch() : offsets(1, 0) {}
+
+    std::size_t routeCount() const { return offsets.size() - 1; }
+    std::size_t waypointCount() const { return x.size(); }
+
+    void clear();
+    void append(const double* px, const double* py, const double* pz, std::size_t n,
+                const EnergyCoefficients& coeffs, double routeVelocity);
+    void append(const WaypointSoA& path, const EnergyCoefficients& coeffs, double routeVelocity);
+};
+
+struct RouteBatchOptions {
+    double climbCoefficient;   // Per-segment model climb term
+    double descentCoefficient; // Per-segment model descent term
+    ThreadPool* pool;          // nullptr = defaultThreadPool()
+    std::size_t grain;         // Routes per pool task
+
+    RouteBatchOptions() : climbCoefficient(0.5), descentCoefficient(0.0), pool(nullptr), grain(256) {}
+};
+
+// CPU reference: totals[r] for every route, routes spread over the pool
+void scoreRouteBatch(const PackedRouteBatch& batch, const RouteBatchOptions& options,
+                     std::vector<SegmentEnergyTotals>& totals);
+
+// Largest difference between two score sets, relative to each route's
+// totals (absolute below 1); the GPU tolerance check uses this
+double maxRelativeDifference(const std::vector<SegmentEnergyTotals>& expected,
+                             const std::vector<SegmentEnergyTotals>& actual);
+
+#endif // EAD_ROUTE_BATCH_HXX
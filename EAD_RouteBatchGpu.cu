@@ -0,0 +1,324 @@
+#include "EAD_RouteBatchGpu.hxx"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <cuda_runtime.h>
+
+namespace {
+
+const int kWarpSize = 32;
+const int kThreadsPerBlock = 256; // A multiple of kWarpSize: whole warps exit together
+
+bool check(cudaError_t status, const char* what, std::string& error) {
+    if (status == cudaSuccess) {
+        return true;
+    }
+    error = std::string(what) + ": " + cudaGetErrorString(status);
+    return false;
+}
+
+// legEnergy() of EAD_SegmentEnergy.hxx, term for term
+__device__ inline double deviceLegEnergy(double length, double z0, double z1, double cruise, double b,
+                                         double climb, double descent) {
+    double meanAltitude = 0.5 * (z0 + z1);
+    double dz = z1 - z0;
+    double verticalEnergy = dz > 0.0 ? climb * dz : -descent * dz;
+    return length * (cruise + b * meanAltitude) + verticalEnergy;
+}
+
+// One warp per route; route r of the chunk covers waypoints
+// [offsets[r] - base, offsets[r + 1] - base) of the chunk's arrays
+__global__ void scoreRoutesKernel(const double* __restrict__ x, const double* __restrict__ y,
+                                  const double* __restrict__ z, const std::uint64_t* __restrict__ offsets,
+                                  std::uint64_t base, const double* __restrict__ a, const double* __restrict__ b,
+                                  const double* __restrict__ c, const double* __restrict__ velocity,
+                                  double climb, double descent, std::size_t routes,
+                                  double* __restrict__ distanceOut, double* __restrict__ energyOut) {
+    std::size_t thread = std::size_t(blockIdx.x) * blockDim.x + threadIdx.x;
+    std::size_t route = thread / kWarpSize;
+    unsigned lane = threadIdx.x % kWarpSize;
+    if (route >= routes) {
+        return;
+    }
+    std::uint64_t begin = offsets[route] - base;
+    std::uint64_t end = offsets[route + 1] - base;
+    double v = velocity[route];
+    double cruise = a[route] * (v * v) + c[route]; // energyConsumption(v, 0, coeffs)
+    double altitudeCost = b[route];
+
+    double distanceSum = 0.0;
+    double energySum = 0.0;
+    for (std::uint64_t i = begin + lane; i + 1 < end; i += kWarpSize) {
+        double dx = x[i + 1] - x[i];
+        double dy = y[i + 1] - y[i];
+        double dz = z[i + 1] - z[i];
+        double length = sqrt(dx * dx + dy * dy + dz * dz);
+        distanceSum += length;
+        energySum += deviceLegEnergy(length, z[i], z[i + 1], cruise, altitudeCost, climb, descent);
+    }
+    for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+        distanceSum += __shfl_down_sync(0xffffffffu, distanceSum, offset);
+        energySum += __shfl_down_sync(0xffffffffu, energySum, offset);
+    }
+    if (lane == 0) {
+        distanceOut[route] = distanceSum;
+        energyOut[route] = energySum;
+    }
+}
+
+// Pinned host staging and device buffers for one stream
+struct Slot {
+    cudaStream_t stream;
+    std::size_t waypointCapacity;
+    std::size_t routeCapacity;
+
+    // Host (pinned) and device copies of the chunk
+    double* hostCoordinates;  // x | y | z, waypointCapacity each
+    double* hostParams;       // a | b | c | velocity, routeCapacity each
+    std::uint64_t* hostOffsets;
+    double* hostResults;      // distance | energy, routeCapacity each
+    double* deviceCoordinates;
+    double* deviceParams;
+    std::uint64_t* deviceOffsets;
+    double* deviceResults;
+
+    // Chunk in flight
+    bool busy;
+    std::size_t firstRoute;
+    std::size_t routes;
+
+    Slot()
+        : stream(nullptr), waypointCapacity(0), routeCapacity(0), hostCoordinates(nullptr), hostParams(nullptr),
+          hostOffsets(nullptr), hostResults(nullptr), deviceCoordinates(nullptr), deviceParams(nullptr),
+          deviceOffsets(nullptr), deviceResults(nullptr), busy(false), firstRoute(0), routes(0) {}
+};
+
+void releaseBuffers(Slot& slot) {
+    cudaFreeHost(slot.hostCoordinates);
+    cudaFreeHost(slot.hostParams);
+    cudaFreeHost(slot.hostOffsets);
+    cudaFreeHost(slot.hostResults);
+    cudaFree(slot.deviceCoordinates);
+    cudaFree(slot.deviceParams);
+    cudaFree(slot.deviceOffsets);
+    cudaFree(slot.deviceResults);
+    slot.hostCoordinates = slot.hostParams = slot.hostResults = nullptr;
+    slot.deviceCoordinates = slot.deviceParams = slot.deviceResults = nullptr;
+    slot.hostOffsets = slot.deviceOffsets = nullptr;
+    slot.waypointCapacity = slot.routeCapacity = 0;
+}
+
+// Grow (never shrink) to hold the chunk; the slot must be idle
+bool reserve(Slot& slot, std::size_t waypoints, std::size_t routes, std::string& error) {
+    if (waypoints <= slot.waypointCapacity && routes <= slot.routeCapacity) {
+        return true;
+    }
+    // At least 1, so no allocation is ever of zero bytes
+    std::size_t waypointCapacity = std::max({waypoints, slot.waypointCapacity + slot.waypointCapacity / 2,
+                                             std::size_t(1)});
+    std::size_t routeCapacity = std::max({routes, slot.routeCapacity + slot.routeCapacity / 2, std::size_t(1)});
+    releaseBuffers(slot);
+    std::size_t coordinateBytes = 3 * waypointCapacity * sizeof(double);
+    std::size_t paramBytes = 4 * routeCapacity * sizeof(double);
+    std::size_t offsetBytes = (routeCapacity + 1) * sizeof(std::uint64_t);
+    std::size_t resultBytes = 2 * routeCapacity * sizeof(double);
+    if (!check(cudaMallocHost(reinterpret_cast<void**>(&slot.hostCoordinates), coordinateBytes), "cudaMallocHost",
+               error) ||
+        !check(cudaMallocHost(reinterpret_cast<void**>(&slot.hostParams), paramBytes), "cudaMallocHost", error) ||
+        !check(cudaMallocHost(reinterpret_cast<void**>(&slot.hostOffsets), offsetBytes), "cudaMallocHost", error) ||
+        !check(cudaMallocHost(reinterpret_cast<void**>(&slot.hostResults), resultBytes), "cudaMallocHost", error) ||
+        !check(cudaMalloc(reinterpret_cast<void**>(&slot.deviceCoordinates), coordinateBytes), "cudaMalloc", error) ||
+        !check(cudaMalloc(reinterpret_cast<void**>(&slot.deviceParams), paramBytes), "cudaMalloc", error) ||
+        !check(cudaMalloc(reinterpret_cast<void**>(&slot.deviceOffsets), offsetBytes), "cudaMalloc", error) ||
+        !check(cudaMalloc(reinterpret_cast<void**>(&slot.deviceResults), resultBytes), "cudaMalloc", error)) {
+        releaseBuffers(slot);
+        return false;
+    }
+    slot.waypointCapacity = waypointCapacity;
+    slot.routeCapacity = routeCapacity;
+    return true;
+}
+
+// Pack routes [first, first + routes) into the slot's pinned buffers
+// and queue copy in, kernel and copy out on its stream
+bool enqueue(Slot& slot, const PackedRouteBatch& batch, const RouteBatchOptions& options, std::size_t first,
+             std::size_t routes, std::string& error) {
+    std::uint64_t base = batch.offsets[first];
+    std::size_t waypoints = batch.offsets[first + routes] - base;
+    if (!reserve(slot, waypoints, routes, error)) {
+        return false;
+    }
+    std::size_t wc = slot.waypointCapacity;
+    std::size_t rc = slot.routeCapacity;
+    std::size_t coordinateBytes = waypoints * sizeof(double);
+    std::size_t paramBytes = routes * sizeof(double);
+    std::memcpy(slot.hostCoordinates, batch.x.data() + base, coordinateBytes);
+    std::memcpy(slot.hostCoordinates + wc, batch.y.data() + base, coordinateBytes);
+    std::memcpy(slot.hostCoordinates + 2 * wc, batch.z.data() + base, coordinateBytes);
+    std::memcpy(slot.hostParams, batch.a.data() + first, paramBytes);
+    std::memcpy(slot.hostParams + rc, batch.b.data() + first, paramBytes);
+    std::memcpy(slot.hostParams + 2 * rc, batch.c.data() + first, paramBytes);
+    std::memcpy(slot.hostParams + 3 * rc, batch.velocity.data() + first, paramBytes);
+    std::memcpy(slot.hostOffsets, batch.offsets.data() + first, (routes + 1) * sizeof(std::uint64_t));
+
+    cudaStream_t stream = slot.stream;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (!check(cudaMemcpyAsync(slot.deviceCoordinates + axis * wc, slot.hostCoordinates + axis * wc,
+                                   coordinateBytes, cudaMemcpyHostToDevice, stream),
+                   "cudaMemcpyAsync", error)) {
+            return false;
+        }
+    }
+    for (int param = 0; param < 4; ++param) {
+        if (!check(cudaMemcpyAsync(slot.deviceParams + param * rc, slot.hostParams + param * rc, paramBytes,
+                                   cudaMemcpyHostToDevice, stream),
+                   "cudaMemcpyAsync", error)) {
+            return false;
+        }
+    }
+    if (!check(cudaMemcpyAsync(slot.deviceOffsets, slot.hostOffsets, (routes + 1) * sizeof(std::uint64_t),
+                               cudaMemcpyHostToDevice, stream),
+               "cudaMemcpyAsync", error)) {
+        return false;
+    }
+
+    std::size_t threads = routes * kWarpSize;
+    unsigned blocks = static_cast<unsigned>((threads + kThreadsPerBlock - 1) / kThreadsPerBlock);
+    scoreRoutesKernel<<<blocks, kThreadsPerBlock, 0, stream>>>(
+        slot.deviceCoordinates, slot.deviceCoordinates + wc, slot.deviceCoordinates + 2 * wc, slot.deviceOffsets,
+        base, slot.deviceParams, slot.deviceParams + rc, slot.deviceParams + 2 * rc, slot.deviceParams + 3 * rc,
+        options.climbCoefficient, options.descentCoefficient, routes, slot.deviceResults,
+        slot.deviceResults + rc);
+    if (!check(cudaGetLastError(), "scoreRoutesKernel", error)) {
+        return false;
+    }
+
+    for (int half = 0; half < 2; ++half) {
+        if (!check(cudaMemcpyAsync(slot.hostResults + half * rc, slot.deviceResults + half * rc, paramBytes,
+                                   cudaMemcpyDeviceToHost, stream),
+                   "cudaMemcpyAsync", error)) {
+            return false;
+        }
+    }
+    slot.busy = true;
+    slot.firstRoute = first;
+    slot.routes = routes;
+    return true;
+}
+
+// Wait for the slot's chunk and copy its totals out
+bool finish(Slot& slot, std::vector<SegmentEnergyTotals>& totals, std::string& error) {
+    if (!slot.busy) {
+        return true;
+    }
+    slot.busy = false;
+    if (!check(cudaStreamSynchronize(slot.stream), "cudaStreamSynchronize", error)) {
+        return false;
+    }
+    const double* distance = slot.hostResults;
+    const double* energy = slot.hostResults + slot.routeCapacity;
+    for (std::size_t r = 0; r < slot.routes; ++r) {
+        totals[slot.firstRoute + r].distance = distance[r];
+        totals[slot.firstRoute + r].energy = energy[r];
+    }
+    return true;
+}
+
+} // namespace
+
+struct GpuRouteScorer::Impl {
+    GpuBatchOptions options;
+    std::vector<Slot> slots;
+    bool opened;
+
+    Impl() : opened(false) {}
+
+    ~Impl() {
+        for (Slot& slot : slots) {
+            if (slot.stream) {
+                cudaStreamSynchronize(slot.stream);
+                cudaStreamDestroy(slot.stream);
+            }
+            releaseBuffers(slot);
+        }
+    }
+};
+
+GpuRouteScorer::GpuRouteScorer() : impl_(new Impl) {}
+
+GpuRouteScorer::~GpuRouteScorer() {}
+
+bool GpuRouteScorer::open(const GpuBatchOptions& options, std::string& error) {
+    int devices = 0;
+    if (!check(cudaGetDeviceCount(&devices), "cudaGetDeviceCount", error)) {
+        return false;
+    }
+    if (options.device < 0 || options.device >= devices) {
+        error = "no CUDA device " + std::to_string(options.device) + " (" + std::to_string(devices) + " found)";
+        return false;
+    }
+    if (!check(cudaSetDevice(options.device), "cudaSetDevice", error)) {
+        return false;
+    }
+    impl_->options = options;
+    impl_->slots.resize(std::max(options.streams, 1));
+    for (Slot& slot : impl_->slots) {
+        if (!slot.stream &&
+            !check(cudaStreamCreateWithFlags(&slot.stream, cudaStreamNonBlocking), "cudaStreamCreate", error)) {
+            return false;
+        }
+    }
+    impl_->opened = true;
+    return true;
+}
+
+bool GpuRouteScorer::score(const PackedRouteBatch& batch, const RouteBatchOptions& options,
+                           std::vector<SegmentEnergyTotals>& totals, std::string& error) {
+    if (!impl_->opened) {
+        error = "GpuRouteScorer::score() before open()";
+        return false;
+    }
+    if (!check(cudaSetDevice(impl_->options.device), "cudaSetDevice", error)) {
+        return false;
+    }
+    std::size_t routes = batch.routeCount();
+    totals.resize(routes);
+    std::size_t maxRoutes = std::max<std::size_t>(impl_->options.routesPerChunk, 1);
+    std::size_t maxWaypoints = impl_->options.waypointsPerChunk;
+    std::vector<Slot>& slots = impl_->slots;
+
+    std::size_t chunk = 0;
+    bool ok = true;
+    for (std::size_t first = 0; ok && first < routes; ++chunk) {
+        // Extend the chunk while it fits; a single oversized route
+        // still makes a chunk of its own
+        std::size_t last = first + 1;
+        while (last < routes && last - first < maxRoutes &&
+               batch.offsets[last + 1] - batch.offsets[first] <= maxWaypoints) {
+            ++last;
+        }
+        Slot& slot = slots[chunk % slots.size()];
+        ok = finish(slot, totals, error) && enqueue(slot, batch, options, first, last - first, error);
+        first = last;
+    }
+    // Drain in chunk order; after a failure still wait for the streams
+    for (std::size_t k = 0; k < slots.size(); ++k) {
+        Slot& slot = slots[(chunk + k) % slots.size()];
+        std::string drainError;
+        if (!finish(slot, totals, drainError) && ok) {
+            error = drainError;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+std::string GpuRouteScorer::deviceName() const {
+    cudaDeviceProp properties;
+    if (!impl_->opened || cudaGetDeviceProperties(&properties, impl_->options.device) != cudaSuccess) {
+        return "unknown";
+    }
+    return properties.name;
+}
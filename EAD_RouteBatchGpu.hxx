@@ -0,0 +1,86 @@
+#ifndef EAD_ROUTE_BATCH_GPU_HXX
+#define EAD_ROUTE_BATCH_GPU_HXX
+
+#include <cfloat>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "EAD_RouteBatch.hxx"
+
+// CUDA Bulk Route Scorer (optional, EAD_BUILD_CUDA)
+// =========================================================
+// Scores a PackedRouteBatch on the GPU with the math of
+// scoreRouteBatch(). Built only when CMake finds a CUDA compiler; the
+// header has no CUDA types, so plain C++ callers link against
+// ead_gpu without nvcc.
+//
+// Segmented reduction
+// -------------------------------------------------------------
+// One warp per route. The 32 lanes stride over the route's legs
+// (coalesced loads of x, y, z), each keeping a partial distance and
+// energy sum, and a shuffle tree combines the lanes:
+//
+//   legs     0  1  2 ... 31 32 33 ... 63 64 ...
+//   lane     0  1  2 ... 31  0  1 ... 31  0 ...
+//   partials p0 p1 ...  p31  --> __shfl_down_sync tree --> lane 0
+//
+// Streams
+// -------------------------------------------------------------
+// The batch is cut into chunks of at most routesPerChunk routes and
+// waypointsPerChunk waypoints (a longer route gets a chunk of its
+// own). Chunks rotate over 'streams' slots, each with pinned host
+// staging and device buffers; while chunk k runs its kernel, chunk
+// k + 1 is being packed and copied in and chunk k - 1 copied out:
+//
+//   stream 0:  [H2D k ][ kernel k ][D2H k ]         [H2D k+2] ...
+//   stream 1:          [H2D k+1][ kernel k+1 ][D2H k+1]        ...
+//
+// Tolerance
+// -------------------------------------------------------------
+// Leg terms are the same IEEE double operations as the CPU path
+// (sqrt is correctly rounded on the device), but nvcc may fuse
+// multiply-adds and the sum runs as 32 partials plus a tree instead of
+// left to right. Each side is within about (legs + 5) * 2^-53 of the
+// exact total, relative to the sum of |leg energy|, so with positive
+// leg energies the two agree to gpuScoreTolerance(legs) relative
+// (maxRelativeDifference()): about 2e-11 at 1e5 legs.
+// =========================================================
+
+// GPU-side plus CPU-side summation bound for a route of 'legs' legs
+inline double gpuScoreTolerance(std::size_t legs) { return 2.0 * double(legs + 5) * (DBL_EPSILON / 2); }
+
+struct GpuBatchOptions {
+    int device;
+    int streams;
+    std::size_t routesPerChunk;
+    std::size_t waypointsPerChunk;
+
+    GpuBatchOptions() : device(0), streams(3), routesPerChunk(65536), waypointsPerChunk(std::size_t(4) << 20) {}
+};
+
+class GpuRouteScorer {
+public:
+    GpuRouteScorer();
+    ~GpuRouteScorer();
+
+    GpuRouteScorer(const GpuRouteScorer&) = delete;
+    GpuRouteScorer& operator=(const GpuRouteScorer&) = delete;
+
+    // Select the device and create the streams
+    bool open(const GpuBatchOptions& options, std::string& error);
+
+    // totals[r] for every route; buffers are kept and grown across
+    // calls, so scoring a stream of batches allocates only at the start
+    bool score(const PackedRouteBatch& batch, const RouteBatchOptions& options,
+               std::vector<SegmentEnergyTotals>& totals, std::string& error);
+
+    std::string deviceName() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+#endif // EAD_ROUTE_BATCH_GPU_HXX
@@ -0,0 +1,293 @@
+#include "EAD_RouteCache.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+#include "EAD_Stats.hxx"
+
+namespace {
+
+const std::size_t kFirstSnapshot = 256;
+const std::uint64_t kLaneMultiplier = 0x9e3779b97f4a7c15ull;
+
+std::uint64_t bitsOf(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// MurmurHash3 finalizer
+std::uint64_t mix64(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+std::uint64_t combine(std::uint64_t seed, std::uint64_t value) {
+    return mix64(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+}
+
+std::uint64_t paramsHash(const SegmentEnergyParams& params) {
+    std::uint64_t h = 0x243f6a8885a308d3ull;
+    h = combine(h, bitsOf(params.coeffs.a));
+    h = combine(h, bitsOf(params.coeffs.b));
+    h = combine(h, bitsOf(params.coeffs.c));
+    h = combine(h, bitsOf(params.velocity));
+    h = combine(h, bitsOf(params.climbCoefficient));
+    h = combine(h, bitsOf(params.descentCoefficient));
+    return combine(h, static_cast<std::uint64_t>(params.distanceAccuracy));
+}
+
+bool sameParams(const SegmentEnergyParams& p, const SegmentEnergyParams& q) {
+    return bitsOf(p.coeffs.a) == bitsOf(q.coeffs.a) && bitsOf(p.coeffs.b) == bitsOf(q.coeffs.b) &&
+           bitsOf(p.coeffs.c) == bitsOf(q.coeffs.c) && bitsOf(p.velocity) == bitsOf(q.velocity) &&
+           bitsOf(p.climbCoefficient) == bitsOf(q.climbCoefficient) &&
+           bitsOf(p.descentCoefficient) == bitsOf(q.descentCoefficient) &&
+           p.distanceAccuracy == q.distanceAccuracy;
+}
+
+// Prefix lengths a route of n waypoints is keyed at, shortest first:
+// 256, 512, ... below n, then n
+std::vector<std::size_t> snapshotLengths(std::size_t n) {
+    std::vector<std::size_t> lengths;
+    for (std::size_t length = kFirstSnapshot; length < n; length *= 2) {
+        lengths.push_back(length);
+    }
+    lengths.push_back(n);
+    return lengths;
+}
+
+// One pass over the waypoint bits, one key per snapshot length. The
+// three lanes are independent dependency chains, so the multiplies
+// overlap.
+std::vector<std::uint64_t> routeKeys(const double* x, const double* y, const double* z,
+                                     const std::vector<std::size_t>& lengths, std::uint64_t params) {
+    std::vector<std::uint64_t> keys;
+    keys.reserve(lengths.size());
+    std::uint64_t hx = 0x13198a2e03707344ull;
+    std::uint64_t hy = 0xa4093822299f31d0ull;
+    std::uint64_t hz = 0x082efa98ec4e6c89ull;
+    std::size_t i = 0;
+    for (std::size_t length : lengths) {
+        for (; i < length; ++i) {
+            hx = ((hx << 27 | hx >> 37) ^ bitsOf(x[i])) * kLaneMultiplier;
+            hy = ((hy << 27 | hy >> 37) ^ bitsOf(y[i])) * kLaneMultiplier;
+            hz = ((hz << 27 | hz >> 37) ^ bitsOf(z[i])) * kLaneMultiplier;
+        }
+        std::uint64_t h = combine(combine(combine(combine(params, hx), hy), hz), length);
+        keys.push_back(h);
+    }
+    return keys;
+}
+
+bool sameWaypoints(const WaypointSoA& path, const double* x, const double* y, const double* z, std::size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    return std::memcmp(path.x.data(), x, count * sizeof(double)) == 0 &&
+           std::memcmp(path.y.data(), y, count * sizeof(double)) == 0 &&
+           std::memcmp(path.z.data(), z, count * sizeof(double)) == 0;
+}
+
+bool sameWaypoint(const WaypointSoA& path, std::size_t i, const double* x, const double* y, const double* z) {
+    return bitsOf(path.x[i]) == bitsOf(x[i]) && bitsOf(path.y[i]) == bitsOf(y[i]) && bitsOf(path.z[i]) == bitsOf(z[i]);
+}
+
+std::size_t routeBytes(std::size_t n) {
+    return n * (3 + 4) * sizeof(double) + sizeof(CachedRoute);
+}
+
+// Legs first .. n - 2 of 'route', continuing the prefix sums at
+// waypoint 'first'; same loop as evaluateSegments()
+void evaluateLegsFrom(CachedRoute& route, std::size_t first) {
+    const WaypointSoA& path = route.path;
+    SegmentEnergyProfile& profile = route.profile;
+    std::size_t n = path.size();
+    if (n < 2 || first + 1 >= n) {
+        return;
+    }
+    segmentLengths(path.x.data() + first, path.y.data() + first, path.z.data() + first, n - first,
+                   profile.length.data() + first, lengthAccuracy(route.params.distanceAccuracy));
+    const double cruise = cruiseEnergyPerMeter(route.params.velocity, route.params);
+    const double* z = path.z.data();
+    double distanceSum = profile.cumulativeDistance[first];
+    double energySum = profile.cumulativeEnergy[first];
+    for (std::size_t i = first; i + 1 < n; ++i) {
+        double e = legEnergy(profile.length[i], z[i], z[i + 1], cruise, route.params);
+        profile.energy[i] = e;
+        distanceSum += profile.length[i];
+        energySum += e;
+        profile.cumulativeDistance[i + 1] = distanceSum;
+        profile.cumulativeEnergy[i + 1] = energySum;
+    }
+}
+
+} // namespace
+
+RouteCache::RouteCache(const RouteCacheOptions& options)
+    : hits_(0), prefixHits_(0), misses_(0), legsReused_(0), legsEvaluated_(0), evictions_(0) {
+    std::size_t shards = std::max<std::size_t>(options.shards, 1);
+    for (std::size_t i = 0; i < shards; ++i) {
+        shards_.emplace_back(new Shard());
+    }
+    shardBytes_ = options.maxBytes / shards;
+}
+
+std::shared_ptr<const CachedRoute> RouteCache::evaluate(const WaypointSoA& path, const SegmentEnergyParams& params) {
+    return evaluate(path.x.data(), path.y.data(), path.z.data(), path.size(), params);
+}
+
+std::shared_ptr<const CachedRoute> RouteCache::evaluate(const double* x, const double* y, const double* z,
+                                                        std::size_t n, const SegmentEnergyParams& params) {
+    EAD_STATS_TIMER("route_cache");
+    std::vector<std::size_t> lengths = snapshotLengths(n);
+    std::vector<std::uint64_t> keys = routeKeys(x, y, z, lengths, paramsHash(params));
+    Shard& shard = *shards_[mix64(keys.front()) % shards_.size()];
+
+    // Longest verified prefix among the candidates
+    std::shared_ptr<const CachedRoute> base;
+    std::size_t shared = 0;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (std::size_t k = keys.size(); k-- > 0;) {
+            auto found = shard.index.find(keys[k]);
+            if (found == shard.index.end()) {
+                continue;
+            }
+            const CachedRoute& candidate = *found->second->route;
+            std::size_t length = lengths[k];
+            if (candidate.path.size() < length || !sameParams(candidate.params, params) ||
+                !sameWaypoints(candidate.path, x, y, z, length)) {
+                continue;
+            }
+            shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+            base = found->second->route;
+            shared = length;
+            break;
+        }
+    }
+    if (base) {
+        std::size_t limit = std::min(n, base->path.size());
+        while (shared < limit && sameWaypoint(base->path, shared, x, y, z)) {
+            ++shared;
+        }
+        if (shared == n && base->path.size() == n) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            legsReused_.fetch_add(n > 0 ? n - 1 : 0, std::memory_order_relaxed);
+            EAD_STATS_COUNT("route_cache_hits", 1);
+            return base;
+        }
+    }
+
+    std::shared_ptr<CachedRoute> route = std::make_shared<CachedRoute>();
+    route->path.x.assign(x, x + n);
+    route->path.y.assign(y, y + n);
+    route->path.z.assign(z, z + n);
+    route->params = params;
+    SegmentEnergyProfile& profile = route->profile;
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    profile.length.resize(segments);
+    profile.energy.resize(segments);
+    profile.cumulativeDistance.resize(n);
+    profile.cumulativeEnergy.resize(n);
+
+    // 'shared' waypoints in common = shared - 1 legs to copy
+    std::size_t first = 0;
+    if (base && shared > 0) {
+        first = shared - 1;
+        const SegmentEnergyProfile& cached = base->profile;
+        std::copy(cached.length.begin(), cached.length.begin() + first, profile.length.begin());
+        std::copy(cached.energy.begin(), cached.energy.begin() + first, profile.energy.begin());
+        std::copy(cached.cumulativeDistance.begin(), cached.cumulativeDistance.begin() + shared,
+                  profile.cumulativeDistance.begin());
+        std::copy(cached.cumulativeEnergy.begin(), cached.cumulativeEnergy.begin() + shared,
+                  profile.cumulativeEnergy.begin());
+        prefixHits_.fetch_add(1, std::memory_order_relaxed);
+        legsReused_.fetch_add(first, std::memory_order_relaxed);
+        EAD_STATS_COUNT("route_cache_prefix_hits", 1);
+    } else {
+        if (n > 0) {
+            profile.cumulativeDistance[0] = 0.0;
+            profile.cumulativeEnergy[0] = 0.0;
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        EAD_STATS_COUNT("route_cache_misses", 1);
+    }
+    base.reset();
+    evaluateLegsFrom(*route, first);
+    legsEvaluated_.fetch_add(segments - first, std::memory_order_relaxed);
+
+    insert(shard, route, std::move(keys));
+    return route;
+}
+
+void RouteCache::insert(Shard& shard, std::shared_ptr<const CachedRoute> route, std::vector<std::uint64_t> keys) {
+    std::size_t bytes = routeBytes(route->path.size());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (bytes > shardBytes_) {
+        return; // Would evict everything else and still not fit
+    }
+    // Another thread may have inserted the same route meanwhile
+    auto existing = shard.index.find(keys.back());
+    if (existing != shard.index.end()) {
+        const CachedRoute& other = *existing->second->route;
+        if (other.path.size() == route->path.size() && sameParams(other.params, route->params) &&
+            sameWaypoints(other.path, route->path.x.data(), route->path.y.data(), route->path.z.data(),
+                          route->path.size())) {
+            return;
+        }
+    }
+    Entry entry;
+    entry.route = std::move(route);
+    entry.keys = std::move(keys);
+    entry.bytes = bytes;
+    shard.lru.push_front(std::move(entry));
+    std::list<Entry>::iterator it = shard.lru.begin();
+    for (std::uint64_t key : it->keys) {
+        shard.index[key] = it; // Newest route wins a shared key
+    }
+    shard.bytes += bytes;
+
+    while (shard.bytes > shardBytes_) {
+        std::list<Entry>::iterator victim = std::prev(shard.lru.end());
+        for (std::uint64_t key : victim->keys) {
+            auto found = shard.index.find(key);
+            if (found != shard.index.end() && found->second == victim) {
+                shard.index.erase(found);
+            }
+        }
+        shard.bytes -= victim->bytes;
+        shard.lru.erase(victim);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+RouteCacheStats RouteCache::stats() const {
+    RouteCacheStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.prefixHits = prefixHits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.legsReused = legsReused_.load(std::memory_order_relaxed);
+    stats.legsEvaluated = legsEvaluated_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.entries = 0;
+    stats.bytes = 0;
+    for (const std::unique_ptr<Shard>& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.entries += shard->lru.size();
+        stats.bytes += shard->bytes;
+    }
+    return stats;
+}
+
+void RouteCache::clear() {
+    for (const std::unique_ptr<Shard>& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->lru.clear();
+        shard->bytes = 0;
+    }
+}
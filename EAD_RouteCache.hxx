@@ -0,0 +1,123 @@
+#ifndef EAD_ROUTE_CACHE_HXX
+#define EAD_ROUTE_CACHE_HXX
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "EAD_PathSoA.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+// Content-Addressed Route Evaluation Cache
+// =========================================================
+// Memoizes per-segment profiles (leg lengths, energies, prefix sums)
+// by route content and model parameters, so re-scoring a route costs
+// one hash pass instead of a distance() + energy pass, and a route
+// that starts like a cached one only evaluates its new suffix:
+//
+//   cached:  wp0 wp1 ... wp999                      (profile stored)
+//   request: wp0 wp1 ... wp999 wp1000 ... wp1200
+//            |<---- legs copied ---->|<- evaluated ->|
+//
+// Keys
+// -------------------------------------------------------------
+// The waypoint bits are hashed in one pass (three independent lanes
+// for x, y, z) and the running hash is snapshotted at the prefix
+// lengths 256, 512, 1024, ... below n and at n itself; each snapshot
+// combined with the parameters (a, b, c, velocity, climb, descent) is
+// a key. A cached route is indexed under all of its keys, a lookup
+// tries the request's keys longest first, and the first candidate
+// whose waypoints and parameters compare equal wins. The shared prefix
+// is then extended waypoint by waypoint past the snapshot, so the legs
+// reused are the whole common prefix, not just up to the snapshot.
+// Hash collisions therefore cost a comparison, never a wrong result.
+//
+// Shards and eviction
+// -------------------------------------------------------------
+// The shard is picked by the key of the first 256 waypoints (the whole
+// route if shorter), so a route and every route sharing a usable
+// prefix with it live in the same shard: one mutex per lookup, and LRU
+// eviction stays local. Each shard holds maxBytes / shards of profiles
+// (about 56 bytes per waypoint, coordinates included) and evicts least
+// recently used routes beyond that; a route bigger than a whole shard
+// is evaluated but not kept. Evaluation happens outside the shard lock.
+//
+// Results are bit-identical to evaluateSegments() on the full route:
+// copied legs were computed by the same kernels, and the prefix sums
+// continue in the same order.
+// =========================================================
+
+struct CachedRoute {
+    WaypointSoA path;
+    SegmentEnergyParams params;
+    SegmentEnergyProfile profile;
+};
+
+struct RouteCacheOptions {
+    std::size_t shards;   // Independent locks / LRU lists
+    std::size_t maxBytes; // Budget over all shards
+
+    RouteCacheOptions() : shards(16), maxBytes(std::size_t(256) << 20) {}
+};
+
+struct RouteCacheStats {
+    std::uint64_t hits;          // Whole route found
+    std::uint64_t prefixHits;    // Only the suffix was evaluated
+    std::uint64_t misses;
+    std::uint64_t legsReused;
+    std::uint64_t legsEvaluated;
+    std::uint64_t evictions;
+    std::size_t entries;
+    std::size_t bytes;
+};
+
+class RouteCache {
+public:
+    explicit RouteCache(const RouteCacheOptions& options = RouteCacheOptions());
+
+    RouteCache(const RouteCache&) = delete;
+    RouteCache& operator=(const RouteCache&) = delete;
+
+    // Profile of the route under 'params', from the cache or evaluated
+    // (and inserted); stays valid after eviction while held
+    std::shared_ptr<const CachedRoute> evaluate(const double* x, const double* y, const double* z,
+                                                std::size_t n, const SegmentEnergyParams& params);
+    std::shared_ptr<const CachedRoute> evaluate(const WaypointSoA& path, const SegmentEnergyParams& params);
+
+    RouteCacheStats stats() const;
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<const CachedRoute> route;
+        std::vector<std::uint64_t> keys;
+        std::size_t bytes;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru; // Most recently used first
+        std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+        std::size_t bytes;
+
+        Shard() : bytes(0) {}
+    };
+
+    void insert(Shard& shard, std::shared_ptr<const CachedRoute> route, std::vector<std::uint64_t> keys);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::size_t shardBytes_;
+    std::atomic<std::uint64_t> hits_;
+    std::atomic<std::uint64_t> prefixHits_;
+    std::atomic<std::uint64_t> misses_;
+    std::atomic<std::uint64_t> legsReused_;
+    std::atomic<std::uint64_t> legsEvaluated_;
+    std::atomic<std::uint64_t> evictions_;
+};
+
+#endif // EAD_ROUTE_CACHE_HXX
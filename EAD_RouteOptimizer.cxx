@@ -0,0 +1,436 @@
+#include "EAD_RouteOptimizer.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+typedef std::chrono::steady_clock Clock;
+
+RouteCostMatrix::RouteCostMatrix(const std::vector<Waypoint>& waypoints,
+                                 const SegmentEnergyParams& params, ThreadPool& pool)
+    : n_(waypoints.size()),
+      tilesPerRow_((waypoints.size() + kTile - 1) / kTile),
+      cost_(tilesPerRow_ * tilesPerRow_ * kTile * kTile, 0.0f) {
+    const double cruise = cruiseEnergyPerMeter(params.velocity, params);
+    const double vertical = 0.5 * (params.climbCoefficient + params.descentCoefficient);
+    const double b = params.coeffs.b;
+
+    // One task per tile row; each task writes only its own tiles
+    pool.parallelFor(0, tilesPerRow_, 1, [&](size_t rowBegin, size_t rowEnd) {
+        for (size_t ti = rowBegin; ti < rowEnd; ++ti) {
+            for (size_t tj = 0; tj < tilesPerRow_; ++tj) {
+                float* tile = &cost_[(ti * tilesPerRow_ + tj) << (2 * kTileBits)];
+                for (size_t ii = 0; ii < kTile; ++ii) {
+                    size_t i = (ti << kTileBits) + ii;
+                    if (i >= n_) {
+                        break;
+                    }
+                    const Waypoint& from = waypoints[i];
+                    for (size_t jj = 0; jj < kTile; ++jj) {
+                        size_t j = (tj << kTileBits) + jj;
+                        if (j >= n_) {
+                            break;
+                        }
+                        const Waypoint& to = waypoints[j];
+                        double d = distance(from, to);
+                        double e = d * (cruise + b * 0.5 * (from.z + to.z)) + vertical * std::fabs(to.z - from.z);
+                        tile[(ii << kTileBits) + jj] = static_cast<float>(e);
+                    }
+                }
+            }
+        }
+    });
+}
+
+namespace {
+
+// Candidate move found by a scan, applied later if it does not overlap
+struct Move {
+    double delta;
+    size_t first;   // First touched position
+    size_t last;    // Last touched position
+    size_t i, j;    // 2-opt: reverse (i, j]; Or-opt: segment start, insert after j
+    size_t length;  // Or-opt segment length (0 for 2-opt)
+    bool reversed;  // Or-opt: insert the segment reversed
+};
+
+bool byDelta(const Move& lhs, const Move& rhs) { return lhs.delta < rhs.delta; }
+
+class OrderSearch {
+public:
+    OrderSearch(const RouteCostMatrix& cost, std::vector<size_t>& order, bool fixEnd,
+                Clock::time_point deadline, ThreadPool& pool)
+        : cost_(cost), order_(order), fixEnd_(fixEnd), deadline_(deadline), pool_(pool),
+          expired_(false), epsilon_(0.0), neighbourCount_(0) {}
+
+    double tourCost() const {
+        double total = 0.0;
+        for (size_t p = 0; p + 1 < order_.size(); ++p) {
+            total += edge(p, p + 1);
+        }
+        return total;
+    }
+
+    void setEpsilon(double epsilon) { epsilon_ = epsilon; }
+    bool expired() const { return expired_.load(); }
+
+    // K cheapest partners of every waypoint, used by the fast passes
+    void buildNeighbours(size_t k) {
+        const size_t n = order_.size();
+        neighbourCount_ = std::min(k, n - 1);
+        neighbours_.assign(n * neighbourCount_, 0);
+        pool_.parallelFor(0, n, 64, [&](size_t begin, size_t end) {
+            std::vector<size_t> candidates;
+            for (size_t i = begin; i < end; ++i) {
+                candidates.clear();
+                for (size_t j = 0; j < n; ++j) {
+                    if (j != i) {
+                        candidates.push_back(j);
+                    }
+                }
+                std::nth_element(candidates.begin(), candidates.begin() + (neighbourCount_ - 1), candidates.end(),
+                                 [&](size_t lhs, size_t rhs) { return cost_(i, lhs) < cost_(i, rhs); });
+                std::copy(candidates.begin(), candidates.begin() + neighbourCount_,
+                          neighbours_.begin() + i * neighbourCount_);
+            }
+        });
+    }
+
+    // 2-opt: reverse positions i+1 .. j
+    // -------------------------------------------------------------
+    //   ... o[i] -> o[i+1] ... o[j] -> o[j+1] ...
+    //   ... o[i] -> o[j] ... o[i+1] -> o[j+1] ...
+    // -------------------------------------------------------------
+    // The full pass tries every j; the neighbour pass only tries the
+    // j whose new edge (o[i], o[j]) joins o[i] to one of its K
+    // cheapest partners, which is O(n * K) instead of O(n^2).
+    // -------------------------------------------------------------
+    size_t twoOptPass(bool full) {
+        const size_t n = order_.size();
+        const size_t lastJ = fixEnd_ ? n - 2 : n - 1;
+        updatePositions();
+        std::vector<Move> moves = scan(n > 2 ? lastJ : 0, [&](size_t i, std::vector<Move>& out) {
+            Move best;
+            best.delta = -epsilon_;
+            if (full) {
+                for (size_t j = i + 2; j <= lastJ; ++j) {
+                    tryTwoOpt(i, j, best);
+                }
+            } else {
+                const size_t* partners = &neighbours_[order_[i] * neighbourCount_];
+                for (size_t k = 0; k < neighbourCount_; ++k) {
+                    size_t j = position_[partners[k]];
+                    size_t lo = std::min(i, j);
+                    size_t hi = std::max(i, j);
+                    if (hi >= lo + 2 && hi <= lastJ) {
+                        tryTwoOpt(lo, hi, best);
+                    }
+                }
+            }
+            if (best.delta < -epsilon_) {
+                best.first = best.i;
+                best.last = std::min(best.j + 1, n - 1);
+                best.length = 0;
+                best.reversed = false;
+                out.push_back(best);
+            }
+        });
+        return apply(moves);
+    }
+
+    // Or-opt: move segment [s, s + len) to sit between o[q] and o[q+1]
+    // -------------------------------------------------------------
+    //   removal gain = c(prev, s) + c(e, next) - c(prev, next)
+    //   insert cost  = c(q, a) + c(b, q+1) - c(q, q+1)
+    // with (a, b) = (s, e) or (e, s) when inserted reversed.
+    // The neighbour pass only tries slots next to a partner of o[s]
+    // or o[e].
+    // -------------------------------------------------------------
+    size_t orOptPass(bool full) {
+        const size_t n = order_.size();
+        const size_t lastMovable = fixEnd_ ? n - 2 : n - 1;
+        const size_t lastSlot = fixEnd_ ? n - 2 : n - 1;
+        updatePositions();
+        std::vector<Move> moves = scan(n > 2 ? lastMovable : 0, [&](size_t index, std::vector<Move>& out) {
+            size_t s = index + 1;
+            Move best;
+            best.delta = -epsilon_;
+            for (size_t len = 1; len <= 3 && s + len - 1 <= lastMovable; ++len) {
+                size_t e = s + len - 1;
+                double gain = edge(s - 1, s);
+                if (e + 1 < n) {
+                    gain += edge(e, e + 1) - cost_(order_[s - 1], order_[e + 1]);
+                }
+                if (full) {
+                    for (size_t q = 0; q <= lastSlot; ++q) {
+                        tryOrOpt(s, len, q, gain, best);
+                    }
+                } else {
+                    for (int end = 0; end < 2; ++end) {
+                        const size_t* partners = &neighbours_[order_[end ? e : s] * neighbourCount_];
+                        for (size_t k = 0; k < neighbourCount_; ++k) {
+                            size_t q = position_[partners[k]];
+                            tryOrOpt(s, len, q, gain, best);
+                            if (q > 0) {
+                                tryOrOpt(s, len, q - 1, gain, best);
+                            }
+                        }
+                    }
+                }
+            }
+            if (best.delta < -epsilon_) {
+                size_t e = best.i + best.length - 1;
+                if (best.j < best.i) {
+                    best.first = best.j;
+                    best.last = std::min(e + 1, n - 1);
+                } else {
+                    best.first = best.i - 1;
+                    best.last = std::min(best.j + 1, n - 1);
+                }
+                out.push_back(best);
+            }
+        });
+        return apply(moves);
+    }
+
+private:
+    double edge(size_t p, size_t q) const { return cost_(order_[p], order_[q]); }
+
+    void updatePositions() {
+        position_.resize(order_.size());
+        for (size_t p = 0; p < order_.size(); ++p) {
+            position_[order_[p]] = p;
+        }
+    }
+
+    void tryTwoOpt(size_t i, size_t j, Move& best) const {
+        double delta = cost_(order_[i], order_[j]) - edge(i, i + 1);
+        if (j + 1 < order_.size()) {
+            delta += cost_(order_[i + 1], order_[j + 1]) - edge(j, j + 1);
+        }
+        if (delta < best.delta) {
+            best.delta = delta;
+            best.i = i;
+            best.j = j;
+        }
+    }
+
+    void tryOrOpt(size_t s, size_t len, size_t q, double gain, Move& best) const {
+        size_t e = s + len - 1;
+        if (q + 1 >= s && q <= e) {
+            return;  // The segment itself or its current slot
+        }
+        bool qHasNext = q + 1 < order_.size();
+        if (fixEnd_ && !qHasNext) {
+            return;  // Nothing may follow the fixed landing waypoint
+        }
+        for (int rev = 0; rev < (len > 1 ? 2 : 1); ++rev) {
+            size_t head = order_[rev ? e : s];
+            size_t tail = order_[rev ? s : e];
+            double insert = cost_(order_[q], head);
+            if (qHasNext) {
+                insert += cost_(tail, order_[q + 1]) - edge(q, q + 1);
+            }
+            double delta = insert - gain;
+            if (delta < best.delta) {
+                best.delta = delta;
+                best.i = s;
+                best.j = q;
+                best.length = len;
+                best.reversed = rev != 0;
+            }
+        }
+    }
+
+    // Run 'visit' for every start position in [0, count) on the pool.
+    // Rows are handed out in small chunks so the uneven workload is
+    // balanced by stealing; the deadline is checked once per row.
+    template <typename Visit>
+    std::vector<Move> scan(size_t count, Visit visit) {
+        std::vector<Move> moves;
+        std::mutex movesMutex;
+        pool_.parallelFor(0, count, 8, [&](size_t begin, size_t end) {
+            std::vector<Move> local;
+            for (size_t p = begin; p < end; ++p) {
+                if (expired_.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                if (Clock::now() > deadline_) {
+                    expired_.store(true);
+                    break;
+                }
+                visit(p, local);
+            }
+            if (!local.empty()) {
+                std::lock_guard<std::mutex> lock(movesMutex);
+                moves.insert(moves.end(), local.begin(), local.end());
+            }
+        });
+        return moves;
+    }
+
+    // Apply the best moves first, skipping any that overlap an applied one
+    size_t apply(std::vector<Move>& moves) {
+        std::sort(moves.begin(), moves.end(), byDelta);
+        std::vector<char> touched(order_.size(), 0);
+        size_t applied = 0;
+        for (size_t k = 0; k < moves.size(); ++k) {
+            const Move& m = moves[k];
+            bool free = true;
+            for (size_t p = m.first; p <= m.last && free; ++p) {
+                free = touched[p] == 0;
+            }
+            if (!free) {
+                continue;
+            }
+            std::fill(touched.begin() + m.first, touched.begin() + m.last + 1, 1);
+            if (m.length == 0) {
+                std::reverse(order_.begin() + m.i + 1, order_.begin() + m.j + 1);
+            } else if (m.j < m.i) {
+                std::rotate(order_.begin() + m.j + 1, order_.begin() + m.i, order_.begin() + m.i + m.length);
+                if (m.reversed) {
+                    std::reverse(order_.begin() + m.j + 1, order_.begin() + m.j + 1 + m.length);
+                }
+            } else {
+                std::rotate(order_.begin() + m.i, order_.begin() + m.i + m.length, order_.begin() + m.j + 1);
+                if (m.reversed) {
+                    std::reverse(order_.begin() + m.j + 1 - m.length, order_.begin() + m.j + 1);
+                }
+            }
+            ++applied;
+        }
+        return applied;
+    }
+
+    const RouteCostMatrix& cost_;
+    std::vector<size_t>& order_;
+    bool fixEnd_;
+    Clock::time_point deadline_;
+    ThreadPool& pool_;
+    std::atomic<bool> expired_;
+    double epsilon_;
+    size_t neighbourCount_;
+    std::vector<size_t> neighbours_;
+    std::vector<size_t> position_;
+};
+
+// Greedy nearest-neighbour construction from waypoint 0
+std::vector<size_t> nearestNeighbourOrder(const RouteCostMatrix& cost, bool fixEnd) {
+    size_t n = cost.size();
+    std::vector<size_t> order;
+    order.reserve(n);
+    std::vector<char> visited(n, 0);
+    size_t current = 0;
+    visited[0] = 1;
+    order.push_back(0);
+    if (fixEnd) {
+        visited[n - 1] = 1;
+    }
+    size_t remaining = n - (fixEnd ? 2 : 1);
+    for (size_t step = 0; step < remaining; ++step) {
+        size_t next = 0;
+        float bestCost = std::numeric_limits<float>::infinity();
+        for (size_t j = 0; j < n; ++j) {
+            if (!visited[j] && cost(current, j) < bestCost) {
+                bestCost = cost(current, j);
+                next = j;
+            }
+        }
+        visited[next] = 1;
+        order.push_back(next);
+        current = next;
+    }
+    if (fixEnd) {
+        order.push_back(n - 1);
+    }
+    return order;
+}
+
+double exactEnergy(const std::vector<Waypoint>& waypoints, const std::vector<size_t>& order,
+                   const SegmentEnergyParams& params) {
+    return evaluateSegments(toSoA(reorderWaypoints(waypoints, order)), params).totalEnergy();
+}
+
+} // namespace
+
+std::vector<Waypoint> reorderWaypoints(const std::vector<Waypoint>& waypoints,
+                                       const std::vector<std::size_t>& order) {
+    std::vector<Waypoint> result;
+    result.reserve(order.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        result.push_back(waypoints[order[k]]);
+    }
+    return result;
+}
+
+RouteOptimizationResult optimizeRouteOrder(const std::vector<Waypoint>& waypoints,
+                                           const SegmentEnergyParams& params,
+                                           const RouteOptimizerOptions& options) {
+    Clock::time_point deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.timeBudgetSeconds));
+    ThreadPool& pool = options.pool ? *options.pool : defaultThreadPool();
+    size_t n = waypoints.size();
+
+    RouteOptimizationResult result;
+    result.order.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        result.order[k] = k;
+    }
+    result.initialEnergy = exactEnergy(waypoints, result.order, params);
+    result.finalEnergy = result.initialEnergy;
+    result.passes = 0;
+    result.twoOptMoves = 0;
+    result.orOptMoves = 0;
+    result.timedOut = false;
+    if (n < 4) {
+        return result;
+    }
+
+    RouteCostMatrix cost(waypoints, params, pool);
+
+    std::vector<size_t> given = result.order;
+    OrderSearch givenSearch(cost, given, options.fixEnd, deadline, pool);
+    std::vector<size_t> greedy = nearestNeighbourOrder(cost, options.fixEnd);
+    OrderSearch search(cost, greedy, options.fixEnd, deadline, pool);
+    double initialCost = givenSearch.tourCost();
+    double greedyCost = search.tourCost();
+    if (initialCost < greedyCost) {
+        greedy = given;
+        greedyCost = initialCost;
+    }
+
+    // Ignore "improvements" below float rounding noise of the matrix.
+    // Descent regeneration can make the tour cost negative; the
+    // threshold must stay positive or worsening moves would pass
+    search.setEpsilon(std::max(1e-5 * std::fabs(greedyCost) / double(n), 1e-12));
+
+    // Cheap neighbour-list passes first; once they stop finding moves,
+    // full O(n^2) passes finish the job if the budget allows
+    search.buildNeighbours(options.neighbourCount);
+    bool full = false;
+    while (result.passes < options.maxPasses && !search.expired()) {
+        size_t twoOpt = search.twoOptPass(full);
+        size_t orOpt = search.expired() ? 0 : search.orOptPass(full);
+        result.twoOptMoves += twoOpt;
+        result.orOptMoves += orOpt;
+        ++result.passes;
+        if (twoOpt == 0 && orOpt == 0) {
+            if (full) {
+                break;
+            }
+            full = true;
+        }
+    }
+    result.timedOut = search.expired();
+
+    // Only hand back the new order if it really is cheaper on the exact model
+    double finalEnergy = exactEnergy(waypoints, greedy, params);
+    if (finalEnergy < result.initialEnergy) {
+        result.order = greedy;
+        result.finalEnergy = finalEnergy;
+    }
+    return result;
+}
@@ -0,0 +1,96 @@
+#ifndef EAD_ROUTE_OPTIMIZER_HXX
+#define EAD_ROUTE_OPTIMIZER_HXX
+
+#include <cstddef>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_SegmentEnergy.hxx"
+#include "EAD_ThreadPool.hxx"
+
+// Waypoint Order Optimizer (open-path TSP)
+// =========================================================
+// Finds a visiting order that lowers the route energy:
+//
+//   given:     0 -> 1 -> 2 -> 3 -> 4        (far from optimal)
+//   optimized: 0 -> 3 -> 1 -> 4 -> 2        (same waypoints)
+//
+// The first waypoint (take-off) always stays first; the last one can
+// optionally stay last (landing site). Steps:
+//   1. Energy-weighted cost matrix, built once in parallel.
+//   2. Start from the better of the given order and nearest neighbour.
+//   3. Alternate 2-opt (segment reversal) and Or-opt (move 1-3
+//      waypoints elsewhere, optionally reversed) passes until no
+//      improving move is left or the time budget runs out.
+//
+// Passes first only try moves that create an edge to one of the K
+// cheapest partners of a waypoint (neighbour lists taken from the
+// matrix), then fall back to exhaustive scans once those converge.
+// Each pass scans its moves in parallel on the work-stealing pool,
+// keeps the best move per start position, then applies the improving
+// moves whose position ranges do not overlap (their gains add up).
+// =========================================================
+
+// Energy-weighted cost matrix, stored in 16 x 16 tiles
+// -------------------------------------------------------------
+//   cost(i, j) = d_ij * (a * v^2 + b * (z_i + z_j) / 2 + c)
+//              + (climb + descent) / 2 * |z_j - z_i|
+//
+// The climb/descent term is averaged so the matrix is symmetric and
+// 2-opt reversals do not change the cost of the reversed stretch; the
+// exact asymmetric energy is recomputed with evaluateSegments() at the
+// end. Tiles keep a 2-opt / Or-opt scan row and its neighbours in a
+// few KB, and entries are float to halve the footprint (5000 waypoints
+// = 100 MB).
+// -------------------------------------------------------------
+class RouteCostMatrix {
+public:
+    static const std::size_t kTileBits = 4;
+    static const std::size_t kTile = std::size_t(1) << kTileBits;
+
+    RouteCostMatrix(const std::vector<Waypoint>& waypoints, const SegmentEnergyParams& params,
+                    ThreadPool& pool);
+
+    std::size_t size() const { return n_; }
+
+    float operator()(std::size_t i, std::size_t j) const {
+        std::size_t tile = (i >> kTileBits) * tilesPerRow_ + (j >> kTileBits);
+        return cost_[(tile << (2 * kTileBits)) + ((i & (kTile - 1)) << kTileBits) + (j & (kTile - 1))];
+    }
+
+private:
+    std::size_t n_;
+    std::size_t tilesPerRow_;
+    std::vector<float> cost_;
+};
+
+struct RouteOptimizerOptions {
+    double timeBudgetSeconds; // Wall-clock cap for the whole optimization
+    bool fixEnd;              // Keep the last waypoint last
+    std::size_t maxPasses;    // Upper bound on 2-opt + Or-opt rounds
+    std::size_t neighbourCount; // Candidate partners per waypoint in the fast passes
+    ThreadPool* pool;         // nullptr = defaultThreadPool()
+
+    RouteOptimizerOptions()
+        : timeBudgetSeconds(0.5), fixEnd(false), maxPasses(1000), neighbourCount(16), pool(nullptr) {}
+};
+
+struct RouteOptimizationResult {
+    std::vector<std::size_t> order; // order[k] = index into the input waypoints
+    double initialEnergy;           // Exact route energy in the given order
+    double finalEnergy;             // Exact route energy in the optimized order
+    std::size_t passes;
+    std::size_t twoOptMoves;
+    std::size_t orOptMoves;
+    bool timedOut;
+};
+
+RouteOptimizationResult optimizeRouteOrder(const std::vector<Waypoint>& waypoints,
+                                           const SegmentEnergyParams& params,
+                                           const RouteOptimizerOptions& options = RouteOptimizerOptions());
+
+// Waypoints rearranged into the given visiting order
+std::vector<Waypoint> reorderWaypoints(const std::vector<Waypoint>& waypoints,
+                                       const std::vector<std::size_t>& order);
+
+#endif // EAD_ROUTE_OPTIMIZER_HXX
@@ -0,0 +1,256 @@
+#include "EAD_Scheduler.hxx"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+#include "EAD_Stats.hxx"
+#include "EAD_ThreadPool.hxx"
+
+namespace {
+
+const MissionAssignment kUnassigned = {-1, -1, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+typedef std::greater<std::pair<double, int>> ChargerOrder;
+
+} // namespace
+
+RouteEnergyFeatures routeEnergyFeatures(const double* x, const double* y, const double* z, std::size_t n,
+                                        DistanceAccuracy accuracy) {
+    const std::size_t kBlock = 1024;
+    double lengths[kBlock];
+    const DistanceAccuracy lengthMode = lengthAccuracy(accuracy);
+    RouteEnergyFeatures f = {0.0, 0.0, 0.0, 0.0};
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    for (std::size_t begin = 0; begin < segments; begin += kBlock) {
+        std::size_t count = std::min(segments - begin, kBlock);
+        segmentLengths(x + begin, y + begin, z + begin, count + 1, lengths, lengthMode);
+        for (std::size_t k = 0; k < count; ++k) {
+            std::size_t i = begin + k;
+            double dz = z[i + 1] - z[i];
+            f.distance += lengths[k];
+            f.altitudeDistance += lengths[k] * (0.5 * (z[i] + z[i + 1]));
+            f.climb += dz > 0.0 ? dz : 0.0;
+            f.descent += dz < 0.0 ? -dz : 0.0;
+        }
+    }
+    return f;
+}
+
+MissionScheduler::MissionScheduler(const std::vector<ScheduledDrone>& drones, const SchedulerOptions& options)
+    : specs_(drones), options_(options) {
+    std::size_t m = drones.size();
+    cruise_.resize(m);
+    altitudeCost_.resize(m);
+    inverseSpeed_.resize(m);
+    capacity_.resize(m);
+    inverseRate_.resize(m);
+    for (std::size_t d = 0; d < m; ++d) {
+        const ScheduledDrone& spec = drones[d];
+        double velocity = spec.velocity;
+        if (velocity <= 0.0) {
+            velocity = std::get<0>(findOptimalSpeedAndAltitude(spec.coeffs.a, spec.coeffs.b));
+        }
+        cruise_[d] = spec.coeffs.a * velocity * velocity + spec.coeffs.c;
+        altitudeCost_[d] = spec.coeffs.b;
+        inverseSpeed_[d] = 1.0 / velocity;
+        capacity_[d] = spec.capacity;
+        inverseRate_[d] = spec.chargeRate > 0.0 ? 1.0 / spec.chargeRate : HUGE_VAL;
+    }
+    resetState();
+}
+
+void MissionScheduler::submit(ScheduledMission mission) { inbox_.push(std::move(mission)); }
+
+void MissionScheduler::resetState() {
+    std::size_t m = specs_.size();
+    free_.resize(m);
+    charge_.resize(m);
+    for (std::size_t d = 0; d < m; ++d) {
+        free_[d] = specs_[d].availableFrom;
+        charge_[d] = specs_[d].charge;
+    }
+    chargers_.clear();
+    for (std::size_t c = 0; c < options_.chargers; ++c) {
+        chargers_.push_back(std::make_pair(0.0, static_cast<int>(c)));
+    }
+}
+
+std::size_t MissionScheduler::update() {
+    EAD_STATS_TIMER("scheduler_update");
+    std::vector<ScheduledMission> arrived;
+    inbox_.drain(arrived);
+    if (arrived.empty()) {
+        return 0;
+    }
+    EAD_STATS_COUNT("scheduler_missions", arrived.size());
+
+    // Route features in parallel; nothing else reads the routes
+    std::size_t first = missions_.size();
+    missions_.resize(first + arrived.size());
+    assignments_.resize(missions_.size(), kUnassigned);
+    auto evaluate = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            const ScheduledMission& mission = arrived[k];
+            MissionRecord& record = missions_[first + k];
+            record.features = routeEnergyFeatures(mission.route.x.data(), mission.route.y.data(),
+                                                  mission.route.z.data(), mission.route.size(),
+                                                  options_.distanceAccuracy);
+            record.release = mission.release;
+            record.deadline = mission.deadline;
+            record.priority = mission.priority;
+        }
+    };
+    std::size_t grain = std::max<std::size_t>(options_.grain, 1);
+    if (arrived.size() > grain) {
+        ThreadPool& pool = options_.pool ? *options_.pool : defaultThreadPool();
+        pool.parallelFor(0, arrived.size(), grain, evaluate);
+    } else {
+        evaluate(0, arrived.size());
+    }
+
+    std::vector<std::size_t> pending(arrived.size());
+    for (std::size_t k = 0; k < pending.size(); ++k) {
+        pending[k] = first + k;
+    }
+    assignAll(pending);
+    return arrived.size();
+}
+
+void MissionScheduler::replan(double now) {
+    EAD_STATS_TIMER("scheduler_replan");
+    resetState();
+    std::vector<std::size_t> kept;
+    std::vector<std::size_t> pending;
+    for (std::size_t m : order_) {
+        const MissionAssignment& a = assignments_[m];
+        bool started = a.drone >= 0 && (a.charger >= 0 ? a.chargeStart : a.start) < now;
+        if (started) {
+            apply(a);
+            kept.push_back(m);
+        } else {
+            assignments_[m] = kUnassigned;
+            pending.push_back(m);
+        }
+    }
+    // Nothing new may be placed in the past
+    for (double& t : free_) {
+        t = std::max(t, now);
+    }
+    for (std::pair<double, int>& slot : chargers_) {
+        slot.first = std::max(slot.first, now);
+    }
+    std::make_heap(chargers_.begin(), chargers_.end(), ChargerOrder());
+    order_.swap(kept);
+    assignAll(pending);
+}
+
+// Replay a kept assignment onto the drone and charger state
+void MissionScheduler::apply(const MissionAssignment& a) {
+    free_[a.drone] = a.finish;
+    charge_[a.drone] += a.charged - a.energy;
+    if (a.charger >= 0) {
+        for (std::pair<double, int>& slot : chargers_) {
+            if (slot.second == a.charger) {
+                slot.first = std::max(slot.first, a.chargeEnd);
+            }
+        }
+    }
+}
+
+void MissionScheduler::assignAll(std::vector<std::size_t>& pending) {
+    std::sort(pending.begin(), pending.end(), [this](std::size_t i, std::size_t j) {
+        const MissionRecord& a = missions_[i];
+        const MissionRecord& b = missions_[j];
+        if (a.release != b.release) {
+            return a.release < b.release;
+        }
+        if (a.priority != b.priority) {
+            return a.priority > b.priority;
+        }
+        return i < j;
+    });
+    for (std::size_t m : pending) {
+        assign(m);
+        order_.push_back(m);
+    }
+}
+
+// Greedy step: the drone that finishes this mission first
+void MissionScheduler::assign(std::size_t mission) {
+    const MissionRecord& r = missions_[mission];
+    const RouteEnergyFeatures& f = r.features;
+    const double fixedEnergy = options_.climbCoefficient * f.climb + options_.descentCoefficient * f.descent;
+    const double margin = 1.0 + options_.reserve;
+    const double chargerFree = chargers_.empty() ? HUGE_VAL : chargers_.front().first;
+
+    int best = -1;
+    double bestFinish = HUGE_VAL;
+    double bestEnergy = HUGE_VAL;
+    double bestDeficit = 0.0;
+    for (std::size_t d = 0; d < free_.size(); ++d) {
+        double energy = f.distance * cruise_[d] + altitudeCost_[d] * f.altitudeDistance + fixedEnergy;
+        double need = energy * margin;
+        if (!(need <= capacity_[d])) {
+            continue;
+        }
+        double deficit = std::max(need - charge_[d], 0.0);
+        double ready = deficit > 0.0 ? std::max(free_[d], chargerFree) + deficit * inverseRate_[d] : free_[d];
+        double finish = std::max(ready, r.release) + f.distance * inverseSpeed_[d];
+        // No charger, no charge rate or no cruise speed: this drone can
+        // never finish the mission
+        if (!(finish < HUGE_VAL)) {
+            continue;
+        }
+        if (finish < bestFinish || (finish == bestFinish && energy < bestEnergy)) {
+            best = static_cast<int>(d);
+            bestFinish = finish;
+            bestEnergy = energy;
+            bestDeficit = deficit;
+        }
+    }
+
+    MissionAssignment a = kUnassigned;
+    if (best < 0) {
+        assignments_[mission] = a;
+        return;
+    }
+    std::size_t d = static_cast<std::size_t>(best);
+    a.drone = best;
+    a.energy = bestEnergy;
+    a.chargeStart = a.chargeEnd = free_[d];
+    if (bestDeficit > 0.0 && !chargers_.empty()) {
+        std::pop_heap(chargers_.begin(), chargers_.end(), ChargerOrder());
+        std::pair<double, int>& slot = chargers_.back();
+        a.charger = slot.second;
+        a.chargeStart = std::max(free_[d], slot.first);
+        a.chargeEnd = a.chargeStart + bestDeficit * inverseRate_[d];
+        a.charged = bestDeficit;
+        slot.first = a.chargeEnd;
+        std::push_heap(chargers_.begin(), chargers_.end(), ChargerOrder());
+    }
+    a.start = std::max(a.chargeEnd, r.release);
+    a.finish = a.start + f.distance * inverseSpeed_[d];
+    assignments_[mission] = a;
+    apply(a);
+}
+
+ScheduleSummary MissionScheduler::summary() const {
+    ScheduleSummary s = {missions_.size(), 0, 0, 0, 0, 0.0, 0.0, 0.0};
+    for (std::size_t m = 0; m < missions_.size(); ++m) {
+        const MissionAssignment& a = assignments_[m];
+        if (a.drone < 0) {
+            ++s.unassigned;
+            continue;
+        }
+        ++s.assigned;
+        s.late += a.finish > missions_[m].deadline ? 1 : 0;
+        if (a.charger >= 0) {
+            ++s.charges;
+            s.chargingTime += a.chargeEnd - a.chargeStart;
+        }
+        s.makespan = std::max(s.makespan, a.finish);
+        s.energy += a.energy;
+    }
+    return s;
+}
@@ -0,0 +1,206 @@
+#ifndef EAD_SCHEDULER_HXX
+#define EAD_SCHEDULER_HXX
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "EAD_ApproxDistance.hxx"
+#include "EAD_Core.hxx"
+#include "EAD_MpscQueue.hxx"
+#include "EAD_PathSoA.hxx"
+
+class ThreadPool;
+
+// Charging-Aware Mission Scheduler
+// =========================================================
+// Assigns missions (routes flown from and back to the depot) to
+// drones with finite batteries, sharing a fixed number of chargers.
+//
+// Cost oracle
+// -------------------------------------------------------------
+// The per-segment model (EAD_SegmentEnergy.hxx) is linear in the
+// drone's coefficients, so one pass over a route gives four features
+//
+//   D = sum d       H = sum d (z0 + z1) / 2
+//   U = sum dz+     L = sum dz-            (meters climbed / descended)
+//
+// and the energy on any drone is then O(1):
+//
+//   E = D (a v^2 + c) + b H + climb U + descent L
+//
+// which is evaluateSegmentTotals()'s total up to rounding. Features
+// are computed once per mission, in parallel on the pool; the
+// N x M assignment work is a few flops per (mission, drone) pair.
+//
+// Assignment (greedy list scheduling)
+// -------------------------------------------------------------
+// Missions are taken by release time, then priority (higher first),
+// then submission order. For each one, every drone that can carry
+// E (1 + reserve) on a full battery is tried:
+//
+//   deficit  = max(0, E (1 + reserve) - charge)
+//   charging = deficit / chargeRate on the earliest free charger,
+//              from max(drone free, charger free)
+//   start    = max(release, drone free or charging done)
+//   finish   = start + D / v
+//
+//   drone:    [ previous ][ charging ][ wait ][ flight ]
+//   charger:          [ other ]  [charging]
+//
+// and the drone with the earliest finish wins (ties: less energy,
+// then lower index). Charging is just-in-time: only the deficit.
+// Chargers are min-heap ordered by the time they become free;
+// bookings only extend a charger's timeline, never fill a gap.
+// A mission no drone can carry, or finish in finite time (it needs a
+// charge but there is no charger or no charge rate, or the drone has
+// no cruise speed), stays unassigned.
+//
+// Incremental updates
+// -------------------------------------------------------------
+// submit() may be called from any thread; missions wait in a
+// lock-free inbox (EAD_MpscQueue.hxx). update() drains it, evaluates
+// the new missions and appends them to the current plan without
+// touching existing assignments. replan(now) keeps what has started
+// by 'now' (charging or flight) and re-runs the greedy pass for the
+// rest from 'now' on, e.g. after a burst of arrivals.
+// A 10k-mission day on hundreds of drones replans in milliseconds;
+// ead_bench's BM_ScheduleReplan measures it.
+// =========================================================
+
+struct ScheduledDrone {
+    EnergyCoefficients coeffs;
+    double velocity;      // Cruise speed; 0 = findOptimalSpeedAndAltitude(a, b)
+    double capacity;      // Usable battery energy
+    double charge;        // Energy on board at availableFrom
+    double chargeRate;    // Energy per second on a charger
+    double availableFrom; // Seconds after the start of the day
+};
+
+struct ScheduledMission {
+    WaypointSoA route;
+    double release;  // Earliest departure
+    double deadline; // Latest finish; HUGE_VAL = none (late missions are still flown)
+    int priority;    // Higher goes first among missions released together
+
+    ScheduledMission() : release(0.0), deadline(HUGE_VAL), priority(0) {}
+};
+
+// Route features of the cost oracle (see above)
+struct RouteEnergyFeatures {
+    double distance;
+    double altitudeDistance; // H
+    double climb;            // U
+    double descent;          // L
+};
+
+RouteEnergyFeatures routeEnergyFeatures(const double* x, const double* y, const double* z, std::size_t n,
+                                        DistanceAccuracy accuracy = kDistanceExact);
+
+inline double featureEnergy(const RouteEnergyFeatures& f, const EnergyCoefficients& coeffs, double velocity,
+                            double climbCoefficient, double descentCoefficient) {
+    return f.distance * (coeffs.a * velocity * velocity + coeffs.c) + coeffs.b * f.altitudeDistance +
+           climbCoefficient * f.climb + descentCoefficient * f.descent;
+}
+
+struct MissionAssignment {
+    int drone;          // -1 = unassigned
+    int charger;        // -1 = flown without charging
+    double chargeStart; // Charging interval; equal when charger == -1
+    double chargeEnd;
+    double start;       // Flight interval
+    double finish;
+    double energy;      // Energy the drone spends on the route
+    double charged;     // Energy put in before the flight
+};
+
+struct ScheduleSummary {
+    std::size_t missions;
+    std::size_t assigned;
+    std::size_t unassigned;
+    std::size_t late;       // Finished after their deadline
+    std::size_t charges;    // Charging sessions
+    double makespan;        // Latest finish
+    double energy;          // Flown
+    double chargingTime;    // Sum of charging intervals
+};
+
+struct SchedulerOptions {
+    std::size_t chargers;              // Shared charging slots
+    double reserve;                    // Margin kept on top of E, as a fraction of E
+    double climbCoefficient;           // Per-segment model climb term
+    double descentCoefficient;         // Per-segment model descent term
+    DistanceAccuracy distanceAccuracy; // For the route features
+    ThreadPool* pool;                  // nullptr = defaultThreadPool()
+    std::size_t grain;                 // Missions per feature task
+
+    SchedulerOptions()
+        : chargers(4),
+          reserve(0.1),
+          climbCoefficient(0.5),
+          descentCoefficient(0.0),
+          distanceAccuracy(kDistanceExact),
+          pool(nullptr),
+          grain(64) {}
+};
+
+class MissionScheduler {
+public:
+    MissionScheduler(const std::vector<ScheduledDrone>& drones, const SchedulerOptions& options = SchedulerOptions());
+
+    MissionScheduler(const MissionScheduler&) = delete;
+    MissionScheduler& operator=(const MissionScheduler&) = delete;
+
+    // Any thread; takes effect at the next update()
+    void submit(ScheduledMission mission);
+
+    // Drain submitted missions (indices continue in submission order),
+    // evaluate them and append them to the plan; returns how many
+    std::size_t update();
+
+    // Keep assignments that started before 'now', reschedule the rest
+    // from the drone and charger states they leave, no earlier than 'now'
+    void replan(double now);
+
+    // assignment(i) for mission i in submission order
+    std::size_t missionCount() const { return missions_.size(); }
+    const MissionAssignment& assignment(std::size_t i) const { return assignments_[i]; }
+    const RouteEnergyFeatures& features(std::size_t i) const { return missions_[i].features; }
+    ScheduleSummary summary() const;
+
+private:
+    struct MissionRecord {
+        RouteEnergyFeatures features;
+        double release;
+        double deadline;
+        int priority;
+    };
+
+    void resetState();
+    void apply(const MissionAssignment& a);
+    void assign(std::size_t mission);
+    void assignAll(std::vector<std::size_t>& pending);
+
+    std::vector<ScheduledDrone> specs_;
+    SchedulerOptions options_;
+    MpscQueue<ScheduledMission> inbox_;
+
+    // Per-drone state (SoA) and the derived per-meter terms
+    std::vector<double> cruise_;       // a v^2 + c
+    std::vector<double> altitudeCost_; // b
+    std::vector<double> inverseSpeed_;
+    std::vector<double> capacity_;
+    std::vector<double> inverseRate_;  // Seconds per unit charged; HUGE_VAL = cannot charge
+    std::vector<double> free_;         // Time the drone is next idle
+    std::vector<double> charge_;       // Energy on board then
+
+    // Chargers: min-heap by free time, (time, index)
+    std::vector<std::pair<double, int>> chargers_;
+
+    std::vector<MissionRecord> missions_;
+    std::vector<MissionAssignment> assignments_;
+    std::vector<std::size_t> order_; // Missions in the order they were assigned
+};
+
+#endif // EAD_SCHEDULER_HXX
@@ -0,0 +1,83 @@
+#include "EAD_SegmentEnergy.hxx"
+
+#include "EAD_Stats.hxx"
+
+double segmentEnergy(const Waypoint& from, const Waypoint& to, const SegmentEnergyParams& params) {
+    double cruise = cruiseEnergyPerMeter(params.velocity, params);
+    return legEnergy(distance(from, to), from.z, to.z, cruise, params);
+}
+
+void evaluateSegments(const WaypointSoA& path, const SegmentEnergyParams& params,
+                      SegmentEnergyProfile& profile) {
+    EAD_STATS_TIMER("energy_profile");
+    size_t n = path.size();
+    EAD_STATS_COUNT("energy_waypoints", n);
+    size_t segments = n > 1 ? n - 1 : 0;
+
+    profile.length.resize(segments);
+    profile.energy.resize(segments);
+    profile.cumulativeDistance.resize(n);
+    profile.cumulativeEnergy.resize(n);
+    if (n == 0) {
+        return;
+    }
+
+    segmentLengths(path.x.data(), path.y.data(), path.z.data(), n, profile.length.data(),
+                   lengthAccuracy(params.distanceAccuracy));
+
+    const double cruise = cruiseEnergyPerMeter(params.velocity, params);
+    const double* z = path.z.data();
+    double distanceSum = 0.0;
+    double energySum = 0.0;
+    profile.cumulativeDistance[0] = 0.0;
+    profile.cumulativeEnergy[0] = 0.0;
+    for (size_t i = 0; i < segments; ++i) {
+        double e = legEnergy(profile.length[i], z[i], z[i + 1], cruise, params);
+        profile.energy[i] = e;
+        distanceSum += profile.length[i];
+        energySum += e;
+        profile.cumulativeDistance[i + 1] = distanceSum;
+        profile.cumulativeEnergy[i + 1] = energySum;
+    }
+}
+
+SegmentEnergyProfile evaluateSegments(const WaypointSoA& path, const SegmentEnergyParams& params) {
+    SegmentEnergyProfile profile;
+    evaluateSegments(path, params, profile);
+    return profile;
+}
+
+// Block-wise totals: lengths for up to kBlock legs go to a stack
+// buffer through the batched kernel, then the energy loop reads them
+template <typename T>
+static SegmentEnergyTotals evaluateSegmentTotalsImpl(const T* x, const T* y, const T* z, std::size_t n,
+                                                     const SegmentEnergyParams& params) {
+    EAD_STATS_TIMER("energy_totals");
+    EAD_STATS_COUNT("energy_waypoints", n);
+    const size_t kBlock = 1024;
+    double lengths[kBlock];
+    const double cruise = cruiseEnergyPerMeter(params.velocity, params);
+    const DistanceAccuracy accuracy = lengthAccuracy(params.distanceAccuracy);
+    SegmentEnergyTotals totals = {0.0, 0.0};
+    size_t segments = n > 1 ? n - 1 : 0;
+    for (size_t begin = 0; begin < segments; begin += kBlock) {
+        size_t count = segments - begin < kBlock ? segments - begin : kBlock;
+        segmentLengths(x + begin, y + begin, z + begin, count + 1, lengths, accuracy);
+        for (size_t k = 0; k < count; ++k) {
+            size_t i = begin + k;
+            totals.distance += lengths[k];
+            totals.energy += legEnergy(lengths[k], double(z[i]), double(z[i + 1]), cruise, params);
+        }
+    }
+    return totals;
+}
+
+SegmentEnergyTotals evaluateSegmentTotals(const double* x, const double* y, const double* z,
+                                          std::size_t n, const SegmentEnergyParams& params) {
+    return evaluateSegmentTotalsImpl(x, y, z, n, params);
+}
+
+SegmentEnergyTotals evaluateSegmentTotals(const float* x, const float* y, const float* z,
+                                          std::size_t n, const SegmentEnergyParams& params) {
+    return evaluateSegmentTotalsImpl(x, y, z, n, params);
+}
@@ -0,0 +1,119 @@
+#ifndef EAD_SEGMENT_ENERGY_HXX
+#define EAD_SEGMENT_ENERGY_HXX
+
+#include <cstddef>
+#include <vector>
+
+#include "EAD_ApproxDistance.hxx"
+#include "EAD_Core.hxx"
+#include "EAD_PathSoA.hxx"
+
+// Per-Segment Energy Model
+// =========================================================
+// Each leg i runs from wp[i] to wp[i + 1]. Along the leg the altitude
+// is interpolated linearly between the two waypoint z values:
+//
+//   h(s) = z[i] + (z[i+1] - z[i]) * s / d,   0 <= s <= d
+//
+//        z[i+1] .........*
+//                     .
+//                  .        <- h(s)
+//   z[i]  *....
+//         |<------ d ------>|
+//
+// Integrating E(v, h) = a * v^2 + b * h + c over the leg gives
+//
+//   E_leg = d * (a * v^2 + b * (z[i] + z[i+1]) / 2 + c)
+//         + climb   * max(dz, 0)      (energy per meter gained)
+//         + descent * max(-dz, 0)     (energy per meter lost, < 0 = regen)
+//
+// which is exact for a linear profile, so no sampling is needed.
+// =========================================================
+
+struct SegmentEnergyParams {
+    EnergyCoefficients coeffs;
+    double velocity;           // Cruise velocity used on every leg
+    double climbCoefficient;   // Energy per meter of altitude gained
+    double descentCoefficient; // Energy per meter of altitude lost
+    DistanceAccuracy distanceAccuracy = kDistanceExact; // Leg lengths (EAD_ApproxDistance.hxx)
+};
+
+// Speed-dependent part of the per-meter cost: a * v^2 + c
+inline double cruiseEnergyPerMeter(double velocity, const SegmentEnergyParams& params) {
+    return energyConsumption(velocity, 0.0, params.coeffs);
+}
+
+// Energy for one leg given its length, end altitudes and cruise cost
+// -------------------------------------------------------------
+//   E_leg = d * (cruise + b * mean(h)) + climb/descent term
+// Callers hoist 'cruise' out of their loops when v is constant.
+// -------------------------------------------------------------
+inline double legEnergy(double length, double z0, double z1, double cruise,
+                        const SegmentEnergyParams& params) {
+    double meanAltitude = 0.5 * (z0 + z1);
+    double dz = z1 - z0;
+    double verticalEnergy = dz > 0.0 ? params.climbCoefficient * dz : -params.descentCoefficient * dz;
+    return length * (cruise + params.coeffs.b * meanAltitude) + verticalEnergy;
+}
+
+// Energy for a single leg (scalar reference for the batched evaluator)
+double segmentEnergy(const Waypoint& from, const Waypoint& to, const SegmentEnergyParams& params);
+
+// Per-leg lengths and energies plus prefix sums
+// -------------------------------------------------------------
+// For n waypoints:
+//   length[i], energy[i]       0 <= i < n - 1   (leg i -> i + 1)
+//   cumulativeDistance[i],
+//   cumulativeEnergy[i]        0 <= i < n       (from wp 0 to wp i)
+//
+// cumulativeEnergy[0] == 0, so every range query is O(1):
+//   energy from wp i to wp j = cumulativeEnergy[j] - cumulativeEnergy[i]
+// -------------------------------------------------------------
+struct SegmentEnergyProfile {
+    std::vector<double> length;
+    std::vector<double> energy;
+    std::vector<double> cumulativeDistance;
+    std::vector<double> cumulativeEnergy;
+
+    std::size_t waypointCount() const { return cumulativeEnergy.size(); }
+    std::size_t segmentCount() const { return length.size(); }
+
+    double totalDistance() const { return cumulativeDistance.empty() ? 0.0 : cumulativeDistance.back(); }
+    double totalEnergy() const { return cumulativeEnergy.empty() ? 0.0 : cumulativeEnergy.back(); }
+
+    // Energy still needed to fly from waypoint i to the end of the route
+    double energyRemainingFrom(std::size_t i) const { return totalEnergy() - cumulativeEnergy[i]; }
+    double distanceRemainingFrom(std::size_t i) const { return totalDistance() - cumulativeDistance[i]; }
+
+    // Energy / distance from waypoint i to waypoint j (i <= j)
+    double energyBetween(std::size_t i, std::size_t j) const { return cumulativeEnergy[j] - cumulativeEnergy[i]; }
+    double distanceBetween(std::size_t i, std::size_t j) const { return cumulativeDistance[j] - cumulativeDistance[i]; }
+};
+
+// Evaluate every leg of the route in one pass
+// -------------------------------------------------------------
+// Leg lengths come from the batched segmentLengths() kernel in
+// params.distanceAccuracy; the output overload reuses the profile's
+// buffers across calls.
+// -------------------------------------------------------------
+void evaluateSegments(const WaypointSoA& path, const SegmentEnergyParams& params,
+                      SegmentEnergyProfile& profile);
+SegmentEnergyProfile evaluateSegments(const WaypointSoA& path, const SegmentEnergyParams& params);
+
+// Route totals without per-leg storage
+// -------------------------------------------------------------
+// Streams over raw coordinate buffers (e.g. a memory-mapped route)
+// in blocks of legs, so memory use stays constant no matter how
+// many waypoints the route has. Same math as evaluateSegments().
+// -------------------------------------------------------------
+struct SegmentEnergyTotals {
+    double distance;
+    double energy;
+};
+
+SegmentEnergyTotals evaluateSegmentTotals(const double* x, const double* y, const double* z,
+                                          std::size_t n, const SegmentEnergyParams& params);
+SegmentEnergyTotals evaluateSegmentTotals(const float* x, const float* y, const float* z,
+                                          std::size_t n, const SegmentEnergyParams& params);
+
+#endif // EAD_SEGMENT_ENERGY_HXX
@@ -0,0 +1,498 @@
+#include "EAD_Server.hxx"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "EAD_Arena.hxx"
+#include "EAD_Stats.hxx"
+#include "EAD_ThreadPool.hxx"
+
+namespace {
+
+const std::size_t kLatencyWindow = 4096;
+const std::size_t kAdjustEvery = 256;
+const double kMinimumGrowth = 20e-6; // Lets a window that collapsed to ~0 recover
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void appendFrame(std::string& out, const std::string& payload) {
+    std::uint32_t length = static_cast<std::uint32_t>(payload.size());
+    for (int k = 0; k < 4; ++k) {
+        out.push_back(static_cast<char>((length >> (8 * k)) & 0xff));
+    }
+    out += payload;
+}
+
+// Same text as runBatch() writes with precision(10)
+std::string formatResult(const Mission& mission, const MissionResult& result) {
+    char numbers[96];
+    std::snprintf(numbers, sizeof(numbers), " %.10g %.10g %.10g", result.totalDistance, result.optimalVelocity,
+                  result.totalEnergy);
+    return mission.id + numbers;
+}
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+MissionServer::MissionServer(const ServerOptions& options)
+    : options_(options),
+      pool_(nullptr),
+      listenFd_(-1),
+      stopping_(false),
+      nextConnection_(0),
+      latencyCursor_(0),
+      sinceAdjust_(0),
+      inFlight_(0),
+      window_(options.p99TargetSeconds / 8.0) {
+    wakeFds_[0] = wakeFds_[1] = -1;
+    if (options_.threads != 0) {
+        ownPool_.reset(new ThreadPool(options_.threads));
+    }
+    pool_ = ownPool_ ? ownPool_.get() : &defaultThreadPool();
+    if (options_.maxBatch == 0) {
+        options_.maxBatch = 1;
+    }
+    std::memset(&stats_, 0, sizeof(stats_));
+}
+
+MissionServer::~MissionServer() {
+    for (auto& entry : connections_) {
+        ::close(entry.second.fd);
+    }
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+    }
+    if (!unixPath_.empty()) {
+        ::unlink(unixPath_.c_str());
+    }
+    for (int fd : wakeFds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+bool MissionServer::start(std::string& error) {
+    if (::pipe(wakeFds_) != 0 || !setNonBlocking(wakeFds_[0]) || !setNonBlocking(wakeFds_[1])) {
+        error = systemError("cannot create wake pipe");
+        return false;
+    }
+
+    const std::string& address = options_.address;
+    if (address.compare(0, 5, "unix:") == 0) {
+        std::string path = address.substr(5);
+        sockaddr_un local;
+        std::memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(local.sun_path)) {
+            error = "invalid unix socket path '" + path + "'";
+            return false;
+        }
+        std::memcpy(local.sun_path, path.c_str(), path.size());
+        // Replace a stale socket left by an earlier run, but nothing else
+        struct stat info;
+        if (::stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+            ::unlink(path.c_str());
+        }
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd_ < 0 || ::bind(listenFd_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            error = systemError("cannot bind " + address);
+            return false;
+        }
+        unixPath_ = path;
+    } else {
+        std::string host = "127.0.0.1";
+        std::string port = address;
+        std::size_t colon = address.rfind(':');
+        if (colon != std::string::npos) {
+            host = address.substr(0, colon);
+            port = address.substr(colon + 1);
+        }
+        char* end = nullptr;
+        unsigned long number = std::strtoul(port.c_str(), &end, 10);
+        sockaddr_in inet;
+        std::memset(&inet, 0, sizeof(inet));
+        inet.sin_family = AF_INET;
+        inet.sin_port = htons(static_cast<std::uint16_t>(number));
+        if (port.empty() || *end || number > 65535 || ::inet_pton(AF_INET, host.c_str(), &inet.sin_addr) != 1) {
+            error = "invalid address '" + address + "' (expected PORT, HOST:PORT or unix:PATH)";
+            return false;
+        }
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        if (listenFd_ < 0 || ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+            ::bind(listenFd_, reinterpret_cast<sockaddr*>(&inet), sizeof(inet)) != 0) {
+            error = systemError("cannot bind " + address);
+            return false;
+        }
+    }
+    if (::listen(listenFd_, 1024) != 0 || !setNonBlocking(listenFd_)) {
+        error = systemError("cannot listen on " + address);
+        return false;
+    }
+    return true;
+}
+
+void MissionServer::stop() {
+    stopping_.store(true);
+    if (wakeFds_[1] >= 0) {
+        char byte = 0;
+        ssize_t ignored = ::write(wakeFds_[1], &byte, 1);
+        (void)ignored;
+    }
+}
+
+ServerStats MissionServer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ServerStats copy = stats_;
+    copy.windowSeconds = window_;
+    return copy;
+}
+
+std::string MissionServer::statsText() const {
+    ServerStats s = stats();
+    std::size_t inFlight;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight = inFlight_;
+    }
+    char text[512];
+    std::snprintf(text, sizeof(text),
+                  "requests %llu\nbatches %llu\nconnections %llu\nin_flight %zu\n"
+                  "p50_seconds %.9g\np99_seconds %.9g\nwindow_seconds %.9g",
+                  static_cast<unsigned long long>(s.requests), static_cast<unsigned long long>(s.batches),
+                  static_cast<unsigned long long>(s.connections), inFlight, s.p50Seconds, s.p99Seconds,
+                  s.windowSeconds);
+    return text;
+}
+
+void MissionServer::acceptConnections() {
+    for (;;) {
+        int fd = ::accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            return; // EAGAIN, or a connection that went away before accept
+        }
+        if (!setNonBlocking(fd)) {
+            ::close(fd);
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on unix sockets
+        Connection connection = {fd, std::string(), std::string(), 0, 0, false};
+        connections_[nextConnection_++] = connection;
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.connections;
+    }
+}
+
+bool MissionServer::readConnection(Connection& connection, std::uint64_t id) {
+    char buffer[65536];
+    for (;;) {
+        ssize_t got = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (got > 0) {
+            connection.input.append(buffer, static_cast<std::size_t>(got));
+            continue;
+        }
+        if (got == 0) {
+            connection.inputClosed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        return false;
+    }
+
+    // Split off every complete frame
+    std::size_t offset = 0;
+    bool answered = false;
+    double arrival = now();
+    while (connection.input.size() - offset >= 4) {
+        const unsigned char* header = reinterpret_cast<const unsigned char*>(connection.input.data() + offset);
+        std::size_t length = std::size_t(header[0]) | std::size_t(header[1]) << 8 |
+                             std::size_t(header[2]) << 16 | std::size_t(header[3]) << 24;
+        if (length > options_.maxFrameBytes) {
+            return false;
+        }
+        if (connection.input.size() - offset - 4 < length) {
+            break;
+        }
+        Request request = {id, connection.input.substr(offset + 4, length), arrival};
+        offset += 4 + length;
+        if (request.payload == "#stats") {
+            appendFrame(connection.output, statsText());
+            answered = true;
+        } else {
+            pending_.push_back(request);
+            ++connection.inFlight;
+        }
+    }
+    connection.input.erase(0, offset);
+    return !answered || writeConnection(connection);
+}
+
+bool MissionServer::writeConnection(Connection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        ssize_t sent = ::send(connection.fd, connection.output.data() + connection.outputOffset,
+                              connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection.outputOffset += static_cast<std::size_t>(sent);
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        } else {
+            return false;
+        }
+    }
+    connection.output.clear();
+    connection.outputOffset = 0;
+    return true;
+}
+
+// Everything pending, in batches of at most maxBatch
+void MissionServer::dispatch() {
+    for (std::size_t begin = 0; begin < pending_.size(); begin += options_.maxBatch) {
+        std::size_t end = std::min(pending_.size(), begin + options_.maxBatch);
+        std::shared_ptr<std::vector<Request> > batch(new std::vector<Request>());
+        batch->reserve(end - begin);
+        for (std::size_t i = begin; i < end; ++i) {
+            batch->push_back(std::move(pending_[i]));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inFlight_ += batch->size();
+            ++stats_.batches;
+        }
+        pool_->submit([this, batch] { evaluateBatch(*batch); });
+    }
+    pending_.clear();
+}
+
+void MissionServer::evaluateBatch(std::vector<Request>& batch) {
+    EAD_STATS_TIMER("server_batch");
+    EAD_STATS_COUNT("server_requests", batch.size());
+    std::size_t n = batch.size();
+    std::vector<Response> responses(n);
+    std::vector<double> latencies(n);
+
+    pool_->parallelFor(0, n, 8, [&](std::size_t begin, std::size_t end) {
+        ArenaResource& scratch = threadArena();
+        Mission mission;
+        std::string error;
+        for (std::size_t i = begin; i < end; ++i) {
+            responses[i].connection = batch[i].connection;
+            if (parseMissionLine(batch[i].payload, mission, error)) {
+                scratch.reset();
+                MissionResult result = evaluateMission(mission, options_.evaluation, scratch);
+                responses[i].payload = formatResult(mission, result);
+            } else {
+                responses[i].payload = mission.id + " error " + error;
+            }
+            latencies[i] = now() - batch[i].arrival;
+        }
+    });
+
+    // Wake the loop before the lock publishes the decrement: once run()
+    // sees inFlight_ == 0 it may return and the destructor close the
+    // pipe, so nothing here may touch 'this' after the unlock
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Response& response : responses) {
+        outbox_.push_back(std::move(response));
+    }
+    inFlight_ -= n;
+    stats_.requests += n;
+    recordLatencies(latencies);
+    char byte = 1;
+    ssize_t ignored = ::write(wakeFds_[1], &byte, 1); // A full pipe already means "wake up"
+    (void)ignored;
+}
+
+// Caller holds mutex_
+void MissionServer::recordLatencies(const std::vector<double>& latencies) {
+    for (double latency : latencies) {
+        if (latencies_.size() < kLatencyWindow) {
+            latencies_.push_back(latency);
+        } else {
+            latencies_[latencyCursor_] = latency;
+            latencyCursor_ = (latencyCursor_ + 1) % kLatencyWindow;
+        }
+    }
+    sinceAdjust_ += latencies.size();
+    if (sinceAdjust_ < kAdjustEvery || latencies_.empty()) {
+        return;
+    }
+    sinceAdjust_ = 0;
+
+    std::vector<double> sorted(latencies_);
+    std::size_t p50 = sorted.size() / 2;
+    std::size_t p99 = std::min(sorted.size() - 1, sorted.size() * 99 / 100);
+    std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+    stats_.p99Seconds = sorted[p99];
+    std::nth_element(sorted.begin(), sorted.begin() + p50, sorted.begin() + p99);
+    stats_.p50Seconds = sorted[p50];
+
+    double target = options_.p99TargetSeconds;
+    if (stats_.p99Seconds > target) {
+        window_ *= 0.5;
+    } else if (stats_.p99Seconds < 0.5 * target) {
+        window_ = std::min(std::max(window_ * 1.25, kMinimumGrowth), 0.5 * target);
+    }
+}
+
+void MissionServer::collectResponses() {
+    std::vector<Response> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready.swap(outbox_);
+    }
+    std::vector<std::uint64_t> touched;
+    for (const Response& response : ready) {
+        std::map<std::uint64_t, Connection>::iterator it = connections_.find(response.connection);
+        if (it == connections_.end()) {
+            continue; // Peer went away while its request was running
+        }
+        appendFrame(it->second.output, response.payload);
+        --it->second.inFlight;
+        touched.push_back(response.connection);
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (std::uint64_t id : touched) {
+        std::map<std::uint64_t, Connection>::iterator it = connections_.find(id);
+        if (!writeConnection(it->second)) {
+            ::close(it->second.fd);
+            connections_.erase(it);
+        }
+    }
+}
+
+void MissionServer::run() {
+    std::vector<pollfd> fds;
+    std::vector<std::uint64_t> ids;
+    for (;;) {
+        bool stopping = stopping_.load();
+        std::size_t inFlight;
+        double window;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inFlight = inFlight_;
+            window = window_;
+        }
+        if (stopping && pending_.empty() && inFlight == 0) {
+            break;
+        }
+
+        // Wake pipe, listener, then one entry per connection
+        fds.clear();
+        ids.clear();
+        pollfd wake = {wakeFds_[0], POLLIN, 0};
+        pollfd listener = {listenFd_, static_cast<short>(stopping ? 0 : POLLIN), 0};
+        fds.push_back(wake);
+        fds.push_back(listener);
+        bool reading = !stopping && inFlight + pending_.size() < options_.maxInFlight;
+        for (auto& entry : connections_) {
+            const Connection& connection = entry.second;
+            short events = 0;
+            if (reading && !connection.inputClosed) {
+                events |= POLLIN;
+            }
+            if (connection.outputOffset < connection.output.size()) {
+                events |= POLLOUT;
+            }
+            // Nothing to wait for: -1 keeps poll() from reporting a hang-up forever
+            pollfd fd = {events ? connection.fd : -1, events, 0};
+            fds.push_back(fd);
+            ids.push_back(entry.first);
+        }
+
+        // Sleep until I/O, a finished batch, or the oldest request's deadline
+        timespec timeout;
+        timespec* timeoutPointer = nullptr;
+        if (!pending_.empty()) {
+            double wait = std::max(0.0, pending_.front().arrival + window - now());
+            timeout.tv_sec = static_cast<time_t>(wait);
+            timeout.tv_nsec = static_cast<long>((wait - double(timeout.tv_sec)) * 1e9);
+            timeoutPointer = &timeout;
+        }
+        if (::ppoll(fds.data(), fds.size(), timeoutPointer, nullptr) < 0 && errno != EINTR) {
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char drain[256];
+            while (::read(wakeFds_[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+        collectResponses();
+        if (fds[1].revents & POLLIN) {
+            acceptConnections();
+        }
+        for (std::size_t k = 0; k < ids.size(); ++k) {
+            short revents = fds[k + 2].revents;
+            std::map<std::uint64_t, Connection>::iterator it = connections_.find(ids[k]);
+            if (revents == 0 || it == connections_.end()) {
+                continue;
+            }
+            bool alive = true;
+            if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                alive = readConnection(it->second, ids[k]);
+            }
+            if (alive && (revents & POLLOUT)) {
+                alive = writeConnection(it->second);
+            }
+            if (!alive) {
+                ::close(it->second.fd);
+                connections_.erase(it);
+            }
+        }
+
+        if (!pending_.empty() &&
+            (stopping || pending_.size() >= options_.maxBatch || now() >= pending_.front().arrival + window)) {
+            dispatch();
+        }
+
+        // Closed by the peer and fully answered
+        for (std::map<std::uint64_t, Connection>::iterator it = connections_.begin(); it != connections_.end();) {
+            const Connection& connection = it->second;
+            if (connection.inputClosed && connection.inFlight == 0 && connection.output.empty()) {
+                ::close(connection.fd);
+                it = connections_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Last chance for answered-but-unsent responses
+    collectResponses();
+    for (auto& entry : connections_) {
+        writeConnection(entry.second);
+    }
+}
@@ -0,0 +1,159 @@
+#ifndef EAD_SERVER_HXX
+#define EAD_SERVER_HXX
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "EAD_Batch.hxx"
+
+class ThreadPool;
+
+// Mission Evaluation Server
+// =========================================================
+// Long-lived process answering mission requests over TCP or a Unix
+// socket, so callers do not pay a process start per evaluation.
+//
+// Protocol: every message, in both directions, is one frame
+//
+//   +----------------------+---------------------------+
+//   | u32 length (LE)      | payload (length bytes)    |
+//   +----------------------+---------------------------+
+//
+// A request payload is one mission in the batch-mode text format
+// ("<id> <a> <b> <c> <x1> <y1> <z1> ..."); the response payload is the
+// matching batch-mode output line without the newline:
+//
+//   "<id> <total_distance> <optimal_velocity> <total_energy>"
+//   "<id> error <message>"
+//
+// The request "#stats" returns counters and the recent p50 / p99
+// latency as "key value" lines. Clients may pipeline any number of
+// requests on a connection; responses come back as their batch
+// finishes, not necessarily in request order, and carry the mission
+// id so callers can match them. Frames longer than maxFrameBytes close
+// the connection.
+//
+// Micro-batching
+// -------------------------------------------------------------
+//   sockets --> I/O thread --> [ pending ] --(window or maxBatch)--> pool
+//      ^                                                              |
+//      +------------- responses (wake pipe) <-------------------------+
+//
+// One I/O thread polls every socket and collects complete frames.
+// Pending requests go to the thread pool as one batch when the oldest
+// has waited 'window' or maxBatch have queued up; workers parse and
+// evaluate the batch in parallel (per-worker arenas, SIMD kernels) and
+// hand the responses back through a wake pipe. Writes are
+// non-blocking and buffered per connection, so a slow reader never
+// holds up anyone else's responses.
+//
+// The window adapts to the p99 target: every 256 responses the p99 of
+// the last 4096 request latencies (frame received -> response queued)
+// is measured; above the target the window halves, below half the
+// target it grows by 25% (at most target / 2). Longer windows mean
+// bigger batches and better throughput, shorter ones lower latency.
+// =========================================================
+
+struct ServerOptions {
+    std::string address;         // "PORT", "HOST:PORT" (IPv4) or "unix:/path"
+    unsigned threads;            // 0 = defaultThreadPool()
+    std::size_t maxBatch;        // Dispatch at once when this many are pending
+    double p99TargetSeconds;     // Latency target steering the batch window
+    std::size_t maxFrameBytes;   // Larger request frames close the connection
+    std::size_t maxInFlight;     // Stop reading sockets beyond this many
+    BatchOptions evaluation;     // Climb / descent terms
+
+    ServerOptions()
+        : address("7878"), threads(0), maxBatch(256), p99TargetSeconds(0.005),
+          maxFrameBytes(1 << 20), maxInFlight(65536) {}
+};
+
+struct ServerStats {
+    std::uint64_t requests;
+    std::uint64_t batches;
+    std::uint64_t connections;
+    double p50Seconds;   // Over the recent latency window
+    double p99Seconds;
+    double windowSeconds; // Current batching window
+};
+
+class MissionServer {
+public:
+    explicit MissionServer(const ServerOptions& options);
+    ~MissionServer();
+
+    MissionServer(const MissionServer&) = delete;
+    MissionServer& operator=(const MissionServer&) = delete;
+
+    // Bind and listen; returns false and sets 'error' on failure
+    bool start(std::string& error);
+
+    // Serve until stop(); waits for batches in flight before returning
+    void run();
+
+    // Async-signal-safe: may be called from a signal handler
+    void stop();
+
+    ServerStats stats() const;
+
+private:
+    struct Request {
+        std::uint64_t connection;
+        std::string payload;
+        double arrival; // Seconds on the steady clock
+    };
+
+    struct Response {
+        std::uint64_t connection;
+        std::string payload;
+    };
+
+    struct Connection {
+        int fd;
+        std::string input;
+        std::string output;
+        std::size_t outputOffset;
+        std::size_t inFlight; // Requests dispatched but not answered yet
+        bool inputClosed;     // Peer finished sending; close once answered
+    };
+
+    void acceptConnections();
+    bool readConnection(Connection& connection, std::uint64_t id);
+    bool writeConnection(Connection& connection);
+    void dispatch();
+    void evaluateBatch(std::vector<Request>& batch);
+    void collectResponses();
+    std::string statsText() const;
+    void recordLatencies(const std::vector<double>& latencies);
+
+    ServerOptions options_;
+    std::unique_ptr<ThreadPool> ownPool_;
+    ThreadPool* pool_;
+    int listenFd_;
+    int wakeFds_[2];
+    std::string unixPath_;
+    std::atomic<bool> stopping_;
+
+    // I/O thread only
+    std::map<std::uint64_t, Connection> connections_;
+    std::uint64_t nextConnection_;
+    std::vector<Request> pending_;
+
+    // Shared with the workers
+    mutable std::mutex mutex_;
+    std::vector<Response> outbox_;
+    std::vector<double> latencies_;
+    std::size_t latencyCursor_;
+    std::size_t sinceAdjust_;
+    std::size_t inFlight_;
+    double window_;
+    ServerStats stats_;
+};
+
+#endif // EAD_SERVER_HXX
@@ -0,0 +1,423 @@
+#include "EAD_SpatialIndex.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace {
+
+// Cell coordinates are clamped well inside int32 so ring arithmetic
+// (cx +/- ring) cannot overflow
+const double kMaxCell = 1073741824.0; // 2^30
+
+void eraseIndex(std::vector<std::uint32_t>& list, std::uint32_t value) {
+    for (std::size_t k = 0; k < list.size(); ++k) {
+        if (list[k] == value) {
+            list[k] = list.back();
+            list.pop_back();
+            return;
+        }
+    }
+}
+
+} // namespace
+
+std::int32_t RouteSpatialIndex::cellX(double x) const {
+    double c = std::floor((x - originX_) / cellSize_);
+    return static_cast<std::int32_t>(std::max(-kMaxCell, std::min(kMaxCell, c)));
+}
+
+std::int32_t RouteSpatialIndex::cellY(double y) const {
+    double c = std::floor((y - originY_) / cellSize_);
+    return static_cast<std::int32_t>(std::max(-kMaxCell, std::min(kMaxCell, c)));
+}
+
+const RouteSpatialIndex::Cell* RouteSpatialIndex::findCell(std::int32_t cx, std::int32_t cy) const {
+    auto it = cells_.find(cellKey(cx, cy));
+    return it == cells_.end() ? nullptr : &it->second;
+}
+
+void RouteSpatialIndex::resetBounds() {
+    minCellX_ = minCellY_ = std::numeric_limits<std::int32_t>::max();
+    maxCellX_ = maxCellY_ = std::numeric_limits<std::int32_t>::min();
+}
+
+void RouteSpatialIndex::build(const std::vector<Waypoint>& route, double cellSize) {
+    waypoints_ = route;
+    cells_.clear();
+    resetBounds();
+
+    if (cellSize <= 0.0) {
+        double sum = 0.0;
+        for (std::size_t i = 1; i < route.size(); ++i) {
+            double dx = route[i].x - route[i - 1].x;
+            double dy = route[i].y - route[i - 1].y;
+            sum += std::sqrt(dx * dx + dy * dy);
+        }
+        cellSize = route.size() > 1 ? 4.0 * sum / static_cast<double>(route.size() - 1) : 0.0;
+        if (!(cellSize > 0.0)) {
+            cellSize = 1.0;
+        }
+    }
+    cellSize_ = cellSize;
+    originX_ = route.empty() ? 0.0 : route[0].x;
+    originY_ = route.empty() ? 0.0 : route[0].y;
+
+    cells_.reserve(route.size() / 2 + 1);
+    for (std::size_t i = 0; i < route.size(); ++i) {
+        insertWaypoint(i);
+        if (i > 0) {
+            insertSegment(i - 1);
+        }
+    }
+}
+
+template <typename Visit>
+void RouteSpatialIndex::traverseCells(const Waypoint& a, const Waypoint& b, Visit visit) const {
+    // 2D grid traversal (Amanatides & Woo): step into whichever
+    // neighbouring cell the line reaches first
+    std::int32_t cx = cellX(a.x), cy = cellY(a.y);
+    std::int32_t ex = cellX(b.x), ey = cellY(b.y);
+    visit(cx, cy);
+
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    std::int32_t stepX = ex > cx ? 1 : -1;
+    std::int32_t stepY = ey > cy ? 1 : -1;
+    const double inf = std::numeric_limits<double>::infinity();
+    double tMaxX = inf, tDeltaX = inf, tMaxY = inf, tDeltaY = inf;
+    if (dx != 0.0) {
+        double boundary = originX_ + (static_cast<double>(cx) + (stepX > 0 ? 1.0 : 0.0)) * cellSize_;
+        tMaxX = (boundary - a.x) / dx;
+        tDeltaX = cellSize_ / std::fabs(dx);
+    }
+    if (dy != 0.0) {
+        double boundary = originY_ + (static_cast<double>(cy) + (stepY > 0 ? 1.0 : 0.0)) * cellSize_;
+        tMaxY = (boundary - a.y) / dy;
+        tDeltaY = cellSize_ / std::fabs(dy);
+    }
+
+    // Only step along an axis that has not reached the end cell, so
+    // rounding can never overshoot and the walk always terminates
+    while (cx != ex || cy != ey) {
+        if (cx != ex && (cy == ey || tMaxX < tMaxY)) {
+            cx += stepX;
+            tMaxX += tDeltaX;
+        } else {
+            cy += stepY;
+            tMaxY += tDeltaY;
+        }
+        visit(cx, cy);
+    }
+}
+
+void RouteSpatialIndex::insertWaypoint(std::size_t i) {
+    std::int32_t cx = cellX(waypoints_[i].x), cy = cellY(waypoints_[i].y);
+    cells_[cellKey(cx, cy)].waypoints.push_back(static_cast<std::uint32_t>(i));
+    minCellX_ = std::min(minCellX_, cx);
+    maxCellX_ = std::max(maxCellX_, cx);
+    minCellY_ = std::min(minCellY_, cy);
+    maxCellY_ = std::max(maxCellY_, cy);
+}
+
+void RouteSpatialIndex::eraseWaypoint(std::size_t i) {
+    auto it = cells_.find(cellKey(cellX(waypoints_[i].x), cellY(waypoints_[i].y)));
+    if (it == cells_.end()) {
+        return;
+    }
+    eraseIndex(it->second.waypoints, static_cast<std::uint32_t>(i));
+    if (it->second.waypoints.empty() && it->second.segments.empty()) {
+        cells_.erase(it);
+    }
+}
+
+void RouteSpatialIndex::insertSegment(std::size_t s) {
+    traverseCells(waypoints_[s], waypoints_[s + 1], [&](std::int32_t cx, std::int32_t cy) {
+        cells_[cellKey(cx, cy)].segments.push_back(static_cast<std::uint32_t>(s));
+        minCellX_ = std::min(minCellX_, cx);
+        maxCellX_ = std::max(maxCellX_, cx);
+        minCellY_ = std::min(minCellY_, cy);
+        maxCellY_ = std::max(maxCellY_, cy);
+    });
+}
+
+void RouteSpatialIndex::eraseSegment(std::size_t s) {
+    traverseCells(waypoints_[s], waypoints_[s + 1], [&](std::int32_t cx, std::int32_t cy) {
+        auto it = cells_.find(cellKey(cx, cy));
+        if (it == cells_.end()) {
+            return;
+        }
+        eraseIndex(it->second.segments, static_cast<std::uint32_t>(s));
+        if (it->second.waypoints.empty() && it->second.segments.empty()) {
+            cells_.erase(it);
+        }
+    });
+}
+
+void RouteSpatialIndex::moveWaypoint(std::size_t i, const Waypoint& wp) {
+    // The occupied bounds only grow; stale bounds cost a few empty
+    // ring lookups, never a wrong answer
+    std::size_t n = waypoints_.size();
+    if (i > 0) {
+        eraseSegment(i - 1);
+    }
+    if (i + 1 < n) {
+        eraseSegment(i);
+    }
+    eraseWaypoint(i);
+    waypoints_[i] = wp;
+    insertWaypoint(i);
+    if (i > 0) {
+        insertSegment(i - 1);
+    }
+    if (i + 1 < n) {
+        insertSegment(i);
+    }
+}
+
+void RouteSpatialIndex::appendWaypoint(const Waypoint& wp) {
+    if (waypoints_.empty() && cells_.empty()) {
+        originX_ = wp.x;
+        originY_ = wp.y;
+    }
+    waypoints_.push_back(wp);
+    std::size_t i = waypoints_.size() - 1;
+    insertWaypoint(i);
+    if (i > 0) {
+        insertSegment(i - 1);
+    }
+}
+
+template <typename Visit>
+void RouteSpatialIndex::visitRing(std::int32_t cx, std::int32_t cy, std::int32_t ring, Visit visit) const {
+    // Clip the ring to the occupied bounds so far-away queries don't
+    // probe the hash map for cells that cannot exist
+    std::int64_t x0 = std::max<std::int64_t>(std::int64_t(cx) - ring, minCellX_);
+    std::int64_t x1 = std::min<std::int64_t>(std::int64_t(cx) + ring, maxCellX_);
+    std::int64_t y0 = std::max<std::int64_t>(std::int64_t(cy) - ring + 1, minCellY_);
+    std::int64_t y1 = std::min<std::int64_t>(std::int64_t(cy) + ring - 1, maxCellY_);
+
+    if (ring == 0) {
+        if (const Cell* cell = findCell(cx, cy)) {
+            visit(*cell);
+        }
+        return;
+    }
+    const std::int64_t rows[2] = {std::int64_t(cy) - ring, std::int64_t(cy) + ring};
+    for (std::int64_t row : rows) {
+        if (row < minCellY_ || row > maxCellY_) {
+            continue;
+        }
+        for (std::int64_t x = x0; x <= x1; ++x) {
+            if (const Cell* cell = findCell(static_cast<std::int32_t>(x), static_cast<std::int32_t>(row))) {
+                visit(*cell);
+            }
+        }
+    }
+    const std::int64_t columns[2] = {std::int64_t(cx) - ring, std::int64_t(cx) + ring};
+    for (std::int64_t column : columns) {
+        if (column < minCellX_ || column > maxCellX_) {
+            continue;
+        }
+        for (std::int64_t y = y0; y <= y1; ++y) {
+            if (const Cell* cell = findCell(static_cast<std::int32_t>(column), static_cast<std::int32_t>(y))) {
+                visit(*cell);
+            }
+        }
+    }
+}
+
+template <typename Visit>
+void RouteSpatialIndex::visitBox(const Waypoint& p, double radius, Visit visit) const {
+    std::int32_t x0 = std::max(cellX(p.x - radius), minCellX_), x1 = std::min(cellX(p.x + radius), maxCellX_);
+    std::int32_t y0 = std::max(cellY(p.y - radius), minCellY_), y1 = std::min(cellY(p.y + radius), maxCellY_);
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    // Large radius: walking the stored cells beats probing empty ones
+    double boxCells = (double(x1) - x0 + 1.0) * (double(y1) - y0 + 1.0);
+    if (boxCells > static_cast<double>(cells_.size())) {
+        for (const auto& entry : cells_) {
+            visit(entry.second);
+        }
+        return;
+    }
+    for (std::int32_t x = x0; x <= x1; ++x) {
+        for (std::int32_t y = y0; y <= y1; ++y) {
+            if (const Cell* cell = findCell(x, y)) {
+                visit(*cell);
+            }
+        }
+    }
+}
+
+double RouteSpatialIndex::ringClearance(const Waypoint& p, std::int32_t cx, std::int32_t cy,
+                                        std::int32_t ring) const {
+    double lowX = originX_ + (static_cast<double>(cx) - ring) * cellSize_;
+    double highX = originX_ + (static_cast<double>(cx) + ring + 1.0) * cellSize_;
+    double lowY = originY_ + (static_cast<double>(cy) - ring) * cellSize_;
+    double highY = originY_ + (static_cast<double>(cy) + ring + 1.0) * cellSize_;
+    return std::max(0.0, std::min(std::min(p.x - lowX, highX - p.x), std::min(p.y - lowY, highY - p.y)));
+}
+
+std::int32_t RouteSpatialIndex::firstRing(std::int32_t cx, std::int32_t cy) const {
+    std::int64_t ring = 0;
+    ring = std::max<std::int64_t>(ring, std::int64_t(minCellX_) - cx);
+    ring = std::max<std::int64_t>(ring, std::int64_t(cx) - maxCellX_);
+    ring = std::max<std::int64_t>(ring, std::int64_t(minCellY_) - cy);
+    ring = std::max<std::int64_t>(ring, std::int64_t(cy) - maxCellY_);
+    return static_cast<std::int32_t>(ring);
+}
+
+std::int32_t RouteSpatialIndex::lastRing(std::int32_t cx, std::int32_t cy) const {
+    std::int64_t ring = 0;
+    ring = std::max<std::int64_t>(ring, std::int64_t(cx) - minCellX_);
+    ring = std::max<std::int64_t>(ring, std::int64_t(maxCellX_) - cx);
+    ring = std::max<std::int64_t>(ring, std::int64_t(cy) - minCellY_);
+    ring = std::max<std::int64_t>(ring, std::int64_t(maxCellY_) - cy);
+    return static_cast<std::int32_t>(ring);
+}
+
+SegmentHit RouteSpatialIndex::segmentDistance(const Waypoint& p, std::size_t s) const {
+    const Waypoint& a = waypoints_[s];
+    const Waypoint& b = waypoints_[s + 1];
+    double dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+    double length2 = dx * dx + dy * dy + dz * dz;
+    double t = 0.0;
+    if (length2 > 0.0) {
+        t = ((p.x - a.x) * dx + (p.y - a.y) * dy + (p.z - a.z) * dz) / length2;
+        t = std::max(0.0, std::min(1.0, t));
+    }
+    SegmentHit hit;
+    hit.segment = s;
+    hit.t = t;
+    hit.closest.x = a.x + t * dx;
+    hit.closest.y = a.y + t * dy;
+    hit.closest.z = a.z + t * dz;
+    hit.distance = distance(p, hit.closest);
+    return hit;
+}
+
+bool RouteSpatialIndex::nearestWaypoint(const Waypoint& p, WaypointHit& hit) const {
+    if (waypoints_.empty()) {
+        return false;
+    }
+    std::int32_t cx = cellX(p.x), cy = cellY(p.y);
+    hit.index = 0;
+    hit.distance = std::numeric_limits<double>::infinity();
+    for (std::int32_t ring = firstRing(cx, cy), last = lastRing(cx, cy); ring <= last; ++ring) {
+        visitRing(cx, cy, ring, [&](const Cell& cell) {
+            for (std::uint32_t i : cell.waypoints) {
+                double d = distance(p, waypoints_[i]);
+                if (d < hit.distance || (d == hit.distance && i < hit.index)) {
+                    hit.index = i;
+                    hit.distance = d;
+                }
+            }
+        });
+        if (hit.distance < ringClearance(p, cx, cy, ring)) {
+            break;
+        }
+    }
+    return true;
+}
+
+bool RouteSpatialIndex::nearestSegment(const Waypoint& p, SegmentHit& hit) const {
+    if (waypoints_.size() < 2) {
+        return false;
+    }
+    std::int32_t cx = cellX(p.x), cy = cellY(p.y);
+    hit.segment = 0;
+    hit.distance = std::numeric_limits<double>::infinity();
+    for (std::int32_t ring = firstRing(cx, cy), last = lastRing(cx, cy); ring <= last; ++ring) {
+        visitRing(cx, cy, ring, [&](const Cell& cell) {
+            for (std::uint32_t s : cell.segments) {
+                SegmentHit candidate = segmentDistance(p, s);
+                if (candidate.distance < hit.distance ||
+                    (candidate.distance == hit.distance && s < hit.segment)) {
+                    hit = candidate;
+                }
+            }
+        });
+        if (hit.distance < ringClearance(p, cx, cy, ring)) {
+            break;
+        }
+    }
+    return true;
+}
+
+void RouteSpatialIndex::nearestWaypoints(const Waypoint& p, std::size_t k, std::vector<WaypointHit>& out) const {
+    out.clear();
+    if (waypoints_.empty() || k == 0) {
+        return;
+    }
+    // Max-heap of the k best so far; the top is the one to evict
+    typedef std::pair<double, std::uint32_t> Entry;
+    std::priority_queue<Entry> best;
+    std::int32_t cx = cellX(p.x), cy = cellY(p.y);
+    for (std::int32_t ring = firstRing(cx, cy), last = lastRing(cx, cy); ring <= last; ++ring) {
+        visitRing(cx, cy, ring, [&](const Cell& cell) {
+            for (std::uint32_t i : cell.waypoints) {
+                Entry entry(distance(p, waypoints_[i]), i);
+                if (best.size() < k) {
+                    best.push(entry);
+                } else if (entry < best.top()) {
+                    best.pop();
+                    best.push(entry);
+                }
+            }
+        });
+        if (best.size() == k && best.top().first < ringClearance(p, cx, cy, ring)) {
+            break;
+        }
+    }
+    out.resize(best.size());
+    for (std::size_t k2 = out.size(); k2-- > 0;) {
+        out[k2].distance = best.top().first;
+        out[k2].index = best.top().second;
+        best.pop();
+    }
+}
+
+void RouteSpatialIndex::waypointsWithinRadius(const Waypoint& p, double radius,
+                                              std::vector<WaypointHit>& out) const {
+    out.clear();
+    if (waypoints_.empty() || !(radius >= 0.0)) {
+        return;
+    }
+    visitBox(p, radius, [&](const Cell& cell) {
+        for (std::uint32_t i : cell.waypoints) {
+            double d = distance(p, waypoints_[i]);
+            if (d <= radius) {
+                WaypointHit hit = {i, d};
+                out.push_back(hit);
+            }
+        }
+    });
+    std::sort(out.begin(), out.end(),
+              [](const WaypointHit& l, const WaypointHit& r) { return l.index < r.index; });
+}
+
+void RouteSpatialIndex::segmentsWithinRadius(const Waypoint& p, double radius,
+                                             std::vector<SegmentHit>& out) const {
+    out.clear();
+    if (waypoints_.size() < 2 || !(radius >= 0.0)) {
+        return;
+    }
+    // A leg is listed in every cell it crosses, so gather candidates
+    // first and dedupe before measuring
+    std::vector<std::uint32_t> candidates;
+    visitBox(p, radius, [&](const Cell& cell) {
+        candidates.insert(candidates.end(), cell.segments.begin(), cell.segments.end());
+    });
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (std::uint32_t s : candidates) {
+        SegmentHit hit = segmentDistance(p, s);
+        if (hit.distance <= radius) {
+            out.push_back(hit);
+        }
+    }
+}
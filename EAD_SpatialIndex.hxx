@@ -0,0 +1,135 @@
+#ifndef EAD_SPATIAL_INDEX_HXX
+#define EAD_SPATIAL_INDEX_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "EAD_Core.hxx"
+
+// Route Spatial Index (uniform hashed grid)
+// =========================================================
+// The XY plane is cut into square cells; only cells the route touches
+// are stored (hash map keyed by cell coordinates):
+//
+//        +----+----+----+----+
+//        |    | 4  |5 6 |    |      digits = waypoint indices
+//        +----+----+----+----+      each segment i (i -> i + 1) is
+//        |  2 | 3  |    | 7  |      listed in every cell its line
+//        +----+----+----+----+      crosses (grid traversal)
+//        |0 1 |    |    |    |
+//        +----+----+----+----+
+//
+// Queries search rings of cells around the query's cell, nearest
+// first, and stop once the next ring is farther than the best hit.
+// Distances are full 3D (distance() / point-to-segment) so results are
+// exact; the XY grid only prunes, since 3D distance >= XY distance.
+//
+// The default cell size is 4x the mean XY segment length, which puts
+// a handful of waypoints in each occupied cell.
+//
+// Edits: moveWaypoint() and appendWaypoint() touch only the cells of
+// the waypoint and its (up to two) segments. Inserting or removing a
+// waypoint renumbers everything after it, so call build() instead.
+// =========================================================
+
+struct WaypointHit {
+    std::size_t index;
+    double distance;
+};
+
+struct SegmentHit {
+    std::size_t segment; // Leg segment -> segment + 1
+    double distance;
+    double t;            // Position along the leg, 0 = start, 1 = end
+    Waypoint closest;    // Closest point on the leg
+};
+
+class RouteSpatialIndex {
+public:
+    RouteSpatialIndex() : cellSize_(1.0), originX_(0.0), originY_(0.0) { resetBounds(); }
+
+    // Index a route; cellSize <= 0 picks one from the segment lengths
+    void build(const std::vector<Waypoint>& route, double cellSize = 0.0);
+
+    std::size_t size() const { return waypoints_.size(); }
+    double cellSize() const { return cellSize_; }
+    std::size_t cellCount() const { return cells_.size(); }
+    const Waypoint& waypoint(std::size_t i) const { return waypoints_[i]; }
+
+    // Incremental edits
+    void moveWaypoint(std::size_t i, const Waypoint& wp);
+    void appendWaypoint(const Waypoint& wp);
+
+    // Queries return false when the index is empty (or has no segments)
+    bool nearestWaypoint(const Waypoint& p, WaypointHit& hit) const;
+    bool nearestSegment(const Waypoint& p, SegmentHit& hit) const;
+
+    // Up to k waypoints, nearest first
+    void nearestWaypoints(const Waypoint& p, std::size_t k, std::vector<WaypointHit>& out) const;
+
+    // Everything within 'radius' of p, in route order
+    void waypointsWithinRadius(const Waypoint& p, double radius, std::vector<WaypointHit>& out) const;
+    void segmentsWithinRadius(const Waypoint& p, double radius, std::vector<SegmentHit>& out) const;
+
+private:
+    struct Cell {
+        std::vector<std::uint32_t> waypoints;
+        std::vector<std::uint32_t> segments;
+    };
+
+    struct CellKeyHash {
+        std::size_t operator()(std::uint64_t key) const {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return static_cast<std::size_t>(key);
+        }
+    };
+
+    std::int32_t cellX(double x) const;
+    std::int32_t cellY(double y) const;
+    static std::uint64_t cellKey(std::int32_t cx, std::int32_t cy) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+               static_cast<std::uint32_t>(cy);
+    }
+    const Cell* findCell(std::int32_t cx, std::int32_t cy) const;
+
+    void resetBounds();
+    void insertWaypoint(std::size_t i);
+    void eraseWaypoint(std::size_t i);
+    void insertSegment(std::size_t s);
+    void eraseSegment(std::size_t s);
+
+    // Calls visit(cx, cy) for every cell the XY projection of a -> b crosses
+    template <typename Visit>
+    void traverseCells(const Waypoint& a, const Waypoint& b, Visit visit) const;
+
+    // Calls visit(cell) for every stored cell on the square ring at
+    // Chebyshev distance 'ring' from (cx, cy)
+    template <typename Visit>
+    void visitRing(std::int32_t cx, std::int32_t cy, std::int32_t ring, Visit visit) const;
+
+    // Calls visit(cell) for every stored cell within 'radius' of p in XY
+    template <typename Visit>
+    void visitBox(const Waypoint& p, double radius, Visit visit) const;
+
+    // Lower bound on the XY distance from p to any cell outside ring 'ring'
+    double ringClearance(const Waypoint& p, std::int32_t cx, std::int32_t cy, std::int32_t ring) const;
+
+    // Ring at which the search square first reaches the occupied cells,
+    // and the ring past which it covers all of them
+    std::int32_t firstRing(std::int32_t cx, std::int32_t cy) const;
+    std::int32_t lastRing(std::int32_t cx, std::int32_t cy) const;
+
+    SegmentHit segmentDistance(const Waypoint& p, std::size_t s) const;
+
+    std::vector<Waypoint> waypoints_;
+    std::unordered_map<std::uint64_t, Cell, CellKeyHash> cells_;
+    double cellSize_;
+    double originX_, originY_;
+    std::int32_t minCellX_, minCellY_, maxCellX_, maxCellY_;
+};
+
+#endif // EAD_SPATIAL_INDEX_HXX
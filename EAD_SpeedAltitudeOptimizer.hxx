@@ -0,0 +1,255 @@
+#ifndef EAD_SPEED_ALTITUDE_OPTIMIZER_HXX
+#define EAD_SPEED_ALTITUDE_OPTIMIZER_HXX
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "EAD_EnergyModel.hxx"
+#include "EAD_PathSoA.hxx"
+#include "EAD_Stats.hxx"
+
+// Constrained Speed / Altitude Optimizer
+// =========================================================
+// Minimizes, per segment, the energy needed to fly one meter:
+//
+//   f(v, h) = E(v, h) + P0 / v
+//
+//   E(v, h) = the energy model (any type from EAD_EnergyModel.hxx)
+//   P0 / v  = constant power draw (avionics, payload, hover share)
+//             spread over the meters flown: slower = more seconds
+//             per meter. Without it the optimum of a * v^2 is v = 0.
+//
+// subject to box constraints:
+//
+//   vMin <= v <= vMax                     (airframe speed limits)
+//   min(z0, z1) <= h <= max(z0, z1)       (leg altitude band, from
+//                                          the waypoint z values)
+//
+// Solver: projected Newton (Bertsekas). Bounds that are active with
+// the gradient pointing outwards are frozen, a Newton step is taken
+// on the free variables, and a projected Armijo line search keeps the
+// iterate feasible. Derivatives come from central differences, so any
+// smooth model works.
+//
+// Warm start: consecutive legs have similar optima, so each solve
+// starts from the previous leg's answer (projected into the new box)
+// and typically converges in 1-3 iterations instead of ~10 cold.
+// =========================================================
+
+struct SpeedAltitudeBounds {
+    double minVelocity; // Must be > 0 when hoverPower > 0
+    double maxVelocity;
+    double minAltitude;
+    double maxAltitude;
+};
+
+struct SpeedAltitudeSettings {
+    double hoverPower;  // P0: constant power draw, energy per second
+    double tolerance;   // Relative tolerance on the projected gradient / step
+    int maxIterations;
+
+    SpeedAltitudeSettings() : hoverPower(0.0), tolerance(1e-9), maxIterations(50) {}
+};
+
+struct SpeedAltitudeSolution {
+    double velocity;
+    double altitude;
+    double energyPerMeter; // f(v, h) at the solution
+    int iterations;
+    bool converged;
+};
+
+namespace detail {
+
+template <typename Model>
+struct CruiseObjective {
+    const Model& model;
+    double hoverPower;
+
+    // No hover term, no division: v = 0 is a valid point of the bare
+    // model (the default bounds allow it); with one, v <= 0 is never
+    // worth flying
+    double operator()(double v, double h) const {
+        double energy = model.energyPerMeter(v, h);
+        if (hoverPower == 0.0) {
+            return energy;
+        }
+        return v > 0.0 ? energy + hoverPower / v : HUGE_VAL;
+    }
+};
+
+inline double clampTo(double x, double lo, double hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+} // namespace detail
+
+// Solve one box-constrained problem starting from (v0, h0)
+template <typename Model>
+SpeedAltitudeSolution optimizeSpeedAndAltitude(const Model& model, const SpeedAltitudeBounds& bounds,
+                                               const SpeedAltitudeSettings& settings,
+                                               double v0, double h0) {
+    EAD_STATS_TIMER("optimizer");
+    detail::CruiseObjective<Model> f = {model, settings.hoverPower};
+    const double lo[2] = {bounds.minVelocity, bounds.minAltitude};
+    const double hi[2] = {bounds.maxVelocity, bounds.maxAltitude};
+
+    double x[2] = {detail::clampTo(v0, lo[0], hi[0]), detail::clampTo(h0, lo[1], hi[1])};
+    double fx = f(x[0], x[1]);
+
+    SpeedAltitudeSolution solution;
+    solution.iterations = 0;
+    solution.converged = false;
+
+    for (int iteration = 0; iteration < settings.maxIterations; ++iteration) {
+        EAD_STATS_COUNT("optimizer_iterations", 1);
+        // Central differences with steps scaled to each variable
+        double step[2] = {1e-4 * std::max(1.0, std::fabs(x[0])), 1e-4 * std::max(1.0, std::fabs(x[1]))};
+        double fvp = f(x[0] + step[0], x[1]), fvm = f(x[0] - step[0], x[1]);
+        double fhp = f(x[0], x[1] + step[1]), fhm = f(x[0], x[1] - step[1]);
+        double g[2] = {(fvp - fvm) / (2.0 * step[0]), (fhp - fhm) / (2.0 * step[1])};
+        double hvv = (fvp - 2.0 * fx + fvm) / (step[0] * step[0]);
+        double hhh = (fhp - 2.0 * fx + fhm) / (step[1] * step[1]);
+        double hvh = (f(x[0] + step[0], x[1] + step[1]) - f(x[0] + step[0], x[1] - step[1]) -
+                      f(x[0] - step[0], x[1] + step[1]) + f(x[0] - step[0], x[1] - step[1])) /
+                     (4.0 * step[0] * step[1]);
+
+        // Active set: at a bound with the gradient pushing outwards
+        bool active[2];
+        double projectedGradient = 0.0;
+        for (int k = 0; k < 2; ++k) {
+            double width = hi[k] - lo[k];
+            double margin = 1e-12 * std::max(1.0, std::fabs(x[k]));
+            active[k] = width <= margin ||
+                        (x[k] <= lo[k] + margin && g[k] > 0.0) ||
+                        (x[k] >= hi[k] - margin && g[k] < 0.0);
+            if (!active[k]) {
+                projectedGradient = std::max(projectedGradient, std::fabs(g[k]) * std::max(1.0, std::fabs(x[k])));
+            }
+        }
+        if (projectedGradient <= settings.tolerance * std::max(1.0, std::fabs(fx))) {
+            solution.converged = true;
+            break;
+        }
+
+        // Newton direction on the free variables, scaled gradient if the
+        // reduced Hessian is not positive definite
+        double d[2] = {0.0, 0.0};
+        if (!active[0] && !active[1]) {
+            double det = hvv * hhh - hvh * hvh;
+            if (hvv > 0.0 && det > 0.0) {
+                d[0] = -(hhh * g[0] - hvh * g[1]) / det;
+                d[1] = -(hvv * g[1] - hvh * g[0]) / det;
+            } else {
+                d[0] = -g[0] / std::max(std::fabs(hvv), 1e-12);
+                d[1] = -g[1] / std::max(std::fabs(hhh), 1e-12);
+            }
+        } else {
+            double curvature[2] = {hvv, hhh};
+            for (int k = 0; k < 2; ++k) {
+                if (!active[k]) {
+                    d[k] = -g[k] / (curvature[k] > 0.0 ? curvature[k] : std::max(std::fabs(curvature[k]), 1e-12));
+                }
+            }
+        }
+
+        // Projected Armijo backtracking along the projection arc
+        double t = 1.0;
+        bool accepted = false;
+        double next[2] = {x[0], x[1]};
+        double fnext = fx;
+        for (int backtrack = 0; backtrack < 40; ++backtrack) {
+            next[0] = detail::clampTo(x[0] + t * d[0], lo[0], hi[0]);
+            next[1] = detail::clampTo(x[1] + t * d[1], lo[1], hi[1]);
+            fnext = f(next[0], next[1]);
+            double decrease = g[0] * (next[0] - x[0]) + g[1] * (next[1] - x[1]);
+            if (fnext <= fx + 1e-4 * decrease) {
+                accepted = true;
+                break;
+            }
+            t *= 0.5;
+        }
+        solution.iterations = iteration + 1;
+        if (!accepted) {
+            solution.converged = true;  // No descent left at finite-difference precision
+            break;
+        }
+
+        double moved = std::max(std::fabs(next[0] - x[0]) / std::max(1.0, std::fabs(x[0])),
+                                std::fabs(next[1] - x[1]) / std::max(1.0, std::fabs(x[1])));
+        x[0] = next[0];
+        x[1] = next[1];
+        fx = fnext;
+        if (moved <= settings.tolerance) {
+            solution.converged = true;
+            break;
+        }
+    }
+
+    solution.velocity = x[0];
+    solution.altitude = x[1];
+    solution.energyPerMeter = fx;
+    return solution;
+}
+
+// Per-segment plan for a whole route
+// -------------------------------------------------------------
+// Leg i gets the altitude band [min(z_i, z_i+1), max(z_i, z_i+1)]
+// intersected with [minAltitude, maxAltitude], and is solved warm
+// from leg i - 1 (or cold from the box centre when warmStart is off).
+// Because the cruise altitude stays inside the band, the climb and
+// descent totals of the leg are unchanged by the choice of h.
+// -------------------------------------------------------------
+struct SegmentPlan {
+    std::vector<SpeedAltitudeSolution> segments;
+    double totalEnergy;
+    std::size_t totalIterations;
+};
+
+template <typename Model>
+void planSegments(const WaypointSoA& path, const Model& model, const SpeedAltitudeBounds& limits,
+                  const SpeedAltitudeSettings& settings, double climbCoefficient, double descentCoefficient,
+                  bool warmStart, SegmentPlan& plan) {
+    std::size_t n = path.size();
+    std::size_t count = n > 1 ? n - 1 : 0;
+    plan.segments.resize(count);
+    plan.totalEnergy = 0.0;
+    plan.totalIterations = 0;
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<double> lengths(count);
+    segmentLengths(path, lengths.data());
+
+    double v = 0.5 * (limits.minVelocity + limits.maxVelocity);
+    double h = 0.5 * (path.z[0] + path.z[1]);
+    for (std::size_t i = 0; i < count; ++i) {
+        double z0 = path.z[i];
+        double z1 = path.z[i + 1];
+        SpeedAltitudeBounds bounds = limits;
+        bounds.minAltitude = std::max(limits.minAltitude, std::min(z0, z1));
+        bounds.maxAltitude = std::min(limits.maxAltitude, std::max(z0, z1));
+        if (bounds.minAltitude > bounds.maxAltitude) {
+            bounds.minAltitude = bounds.maxAltitude = detail::clampTo(0.5 * (z0 + z1), limits.minAltitude,
+                                                                      limits.maxAltitude);
+        }
+        if (!warmStart) {
+            v = 0.5 * (limits.minVelocity + limits.maxVelocity);
+            h = 0.5 * (bounds.minAltitude + bounds.maxAltitude);
+        }
+
+        SpeedAltitudeSolution solution = optimizeSpeedAndAltitude(model, bounds, settings, v, h);
+        plan.segments[i] = solution;
+        plan.totalIterations += static_cast<std::size_t>(solution.iterations);
+
+        double dz = z1 - z0;
+        double vertical = dz > 0.0 ? climbCoefficient * dz : -descentCoefficient * dz;
+        plan.totalEnergy += lengths[i] * solution.energyPerMeter + vertical;
+
+        v = solution.velocity;
+        h = solution.altitude;
+    }
+}
+
+#endif // EAD_SPEED_ALTITUDE_OPTIMIZER_HXX
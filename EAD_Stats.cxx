@@ -0,0 +1,231 @@
+#include "EAD_Stats.hxx"
+
+#ifdef EAD_ENABLE_STATS
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <pthread.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+thread_local StatsBlock* threadStatsBlock = nullptr;
+
+namespace {
+
+// Leaked on purpose: thread-exit hooks and the exit-time report may
+// run after static destructors
+struct StatsRegistry {
+    std::mutex mutex;
+    const char* names[kMaxStats];
+    StatKind kinds[kMaxStats];
+    std::size_t size;
+    std::vector<StatsBlock*> live;
+    std::uint64_t retiredCount[kMaxStats];
+    std::uint64_t retiredNanoseconds[kMaxStats];
+
+    StatsRegistry() : size(0) {
+        std::memset(retiredCount, 0, sizeof(retiredCount));
+        std::memset(retiredNanoseconds, 0, sizeof(retiredNanoseconds));
+        // Last slot collects every name beyond the table
+        names[kMaxStats - 1] = "overflow";
+        kinds[kMaxStats - 1] = kStatCounter;
+    }
+};
+
+StatsRegistry& registry() {
+    static StatsRegistry* instance = new StatsRegistry();
+    return *instance;
+}
+
+// Owns the thread's block; folds it into the retired totals on exit
+struct StatsBlockOwner {
+    StatsBlock* block;
+
+    StatsBlockOwner() : block(nullptr) {}
+    ~StatsBlockOwner() {
+        if (!block) {
+            return;
+        }
+        StatsRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (std::size_t i = 0; i < kMaxStats; ++i) {
+            r.retiredCount[i] += block->count[i].load(std::memory_order_relaxed);
+            r.retiredNanoseconds[i] += block->nanoseconds[i].load(std::memory_order_relaxed);
+        }
+        for (std::size_t i = 0; i < r.live.size(); ++i) {
+            if (r.live[i] == block) {
+                r.live[i] = r.live.back();
+                r.live.pop_back();
+                break;
+            }
+        }
+        threadStatsBlock = nullptr;
+        delete block;
+    }
+};
+
+thread_local StatsBlockOwner threadStatsOwner;
+
+std::string reportPath;
+StatsFormat reportFormat = kStatsJson;
+std::mutex reportMutex;
+
+void report() {
+    std::lock_guard<std::mutex> lock(reportMutex);
+    if (reportPath == "-") {
+        writeStats(std::cerr, reportFormat);
+        std::cerr.flush();
+        return;
+    }
+    // Write then rename, so a scraper never reads half a report
+    std::string temporary = reportPath + ".tmp";
+    {
+        std::ofstream out(temporary.c_str());
+        if (!out) {
+            return;
+        }
+        writeStats(out, reportFormat);
+    }
+    std::rename(temporary.c_str(), reportPath.c_str());
+}
+
+void reportAtExit() { report(); }
+
+void signalLoop(sigset_t signals) {
+    for (;;) {
+        int received = 0;
+        if (sigwait(&signals, &received) == 0) {
+            report();
+        }
+    }
+}
+
+} // namespace
+
+std::size_t registerStat(const char* name, StatKind kind) {
+    StatsRegistry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (std::size_t i = 0; i < r.size; ++i) {
+        if (std::strcmp(r.names[i], name) == 0) {
+            return i;
+        }
+    }
+    if (r.size == kMaxStats - 1) {
+        return kMaxStats - 1;
+    }
+    r.names[r.size] = name;
+    r.kinds[r.size] = kind;
+    return r.size++;
+}
+
+StatsBlock* attachStatsBlock() {
+    StatsBlock* block = new StatsBlock();
+    for (std::size_t i = 0; i < kMaxStats; ++i) {
+        block->count[i].store(0, std::memory_order_relaxed);
+        block->nanoseconds[i].store(0, std::memory_order_relaxed);
+    }
+    StatsRegistry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(block);
+    }
+    threadStatsOwner.block = block;
+    threadStatsBlock = block;
+    return block;
+}
+
+void writeStats(std::ostream& out, StatsFormat format) {
+    StatsRegistry& r = registry();
+    std::size_t used;
+    const char* names[kMaxStats];
+    StatKind kinds[kMaxStats];
+    std::uint64_t count[kMaxStats];
+    std::uint64_t nanoseconds[kMaxStats];
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        used = r.size;
+        for (std::size_t i = 0; i < kMaxStats; ++i) {
+            names[i] = r.names[i];
+            kinds[i] = r.kinds[i];
+            count[i] = r.retiredCount[i];
+            nanoseconds[i] = r.retiredNanoseconds[i];
+            for (const StatsBlock* block : r.live) {
+                count[i] += block->count[i].load(std::memory_order_relaxed);
+                nanoseconds[i] += block->nanoseconds[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    // The overflow slot is only listed once something landed in it
+    std::vector<std::size_t> shown;
+    for (std::size_t i = 0; i < used; ++i) {
+        shown.push_back(i);
+    }
+    if (count[kMaxStats - 1] != 0) {
+        shown.push_back(kMaxStats - 1);
+    }
+
+    std::ostringstream text;
+    text.precision(9);
+    if (format == kStatsPrometheus) {
+        for (std::size_t i : shown) {
+            if (kinds[i] == kStatTimer) {
+                text << "# TYPE ead_" << names[i] << "_calls_total counter\n"
+                     << "ead_" << names[i] << "_calls_total " << count[i] << "\n"
+                     << "# TYPE ead_" << names[i] << "_seconds_total counter\n"
+                     << "ead_" << names[i] << "_seconds_total " << 1e-9 * double(nanoseconds[i]) << "\n";
+            } else {
+                text << "# TYPE ead_" << names[i] << "_total counter\n"
+                     << "ead_" << names[i] << "_total " << count[i] << "\n";
+            }
+        }
+    } else {
+        const char* separator = "";
+        text << "{\"timers\": {";
+        for (std::size_t i : shown) {
+            if (kinds[i] == kStatTimer) {
+                text << separator << "\"" << names[i] << "\": {\"calls\": " << count[i]
+                     << ", \"seconds\": " << 1e-9 * double(nanoseconds[i]) << "}";
+                separator = ", ";
+            }
+        }
+        separator = "";
+        text << "}, \"counters\": {";
+        for (std::size_t i : shown) {
+            if (kinds[i] == kStatCounter) {
+                text << separator << "\"" << names[i] << "\": " << count[i];
+                separator = ", ";
+            }
+        }
+        text << "}}\n";
+    }
+    out << text.str();
+}
+
+bool installStatsReporter() {
+    const char* path = std::getenv("EAD_STATS");
+    if (!path || !*path) {
+        return false;
+    }
+    const char* format = std::getenv("EAD_STATS_FORMAT");
+    reportPath = path;
+    reportFormat = format && std::strcmp(format, "prometheus") == 0 ? kStatsPrometheus : kStatsJson;
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread(signalLoop, signals).detach();
+
+    std::atexit(reportAtExit);
+    return true;
+}
+
+#endif // EAD_ENABLE_STATS
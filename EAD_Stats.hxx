@@ -0,0 +1,132 @@
+#ifndef EAD_STATS_HXX
+#define EAD_STATS_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+// Hot-Path Timers and Counters
+// =========================================================
+// Built in with -DEAD_ENABLE_STATS=ON; otherwise every macro below
+// expands to nothing and this module compiles to empty stubs.
+//
+//   EAD_STATS_TIMER("path_length");          // scope: calls + seconds
+//   EAD_STATS_COUNT("planner_expansions", n); // counter: += n
+//
+// Each call site registers its name once (function-local static), and
+// samples go to the calling thread's own block of slots:
+//
+//   thread A: [calls|ns][calls|ns][value] ...  --+
+//   thread B: [calls|ns][calls|ns][value] ...  --+--> summed on report
+//   retired : blocks of threads that exited    --+
+//
+// A thread only ever writes its own block (relaxed load + store, no
+// read-modify-write, no shared cache lines), and the reporter reads
+// all blocks with relaxed loads, so instrumented code never contends.
+// Sites that use the same name share one stat.
+//
+// Reporting
+// -------------------------------------------------------------
+// installStatsReporter() reads the environment:
+//
+//   EAD_STATS=<file | ->           where to write ("-" = stderr)
+//   EAD_STATS_FORMAT=json | prometheus   (default json)
+//
+// and then writes a summary at exit and on every SIGUSR1. Call it
+// from main() before any other thread starts: it blocks SIGUSR1 in
+// the calling thread (threads created later inherit the mask) and
+// receives it with sigwait() on a reporter thread, so the summary is
+// never written from inside a signal handler.
+//
+//   json:        {"timers": {"path_length": {"calls": 12, "seconds": 0.0031}, ...},
+//                 "counters": {"planner_expansions": 17211, ...}}
+//   prometheus:  ead_path_length_calls_total 12
+//                ead_path_length_seconds_total 0.0031
+//                ead_planner_expansions_total 17211
+// =========================================================
+
+enum StatsFormat { kStatsJson, kStatsPrometheus };
+
+#ifdef EAD_ENABLE_STATS
+
+#include <atomic>
+#include <chrono>
+
+enum StatKind { kStatTimer, kStatCounter };
+
+static const std::size_t kMaxStats = 64;
+
+struct StatsBlock {
+    std::atomic<std::uint64_t> count[kMaxStats]; // Calls (timers) or value (counters)
+    std::atomic<std::uint64_t> nanoseconds[kMaxStats];
+};
+
+// Id for 'name' (a string literal); registering a name twice returns
+// the same id. Names beyond kMaxStats all map to one overflow slot.
+std::size_t registerStat(const char* name, StatKind kind);
+
+StatsBlock* attachStatsBlock();
+extern thread_local StatsBlock* threadStatsBlock;
+
+inline StatsBlock& localStatsBlock() {
+    StatsBlock* block = threadStatsBlock;
+    return block ? *block : *attachStatsBlock();
+}
+
+inline void bumpStat(std::atomic<std::uint64_t>& slot, std::uint64_t amount) {
+    slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void addToStat(std::size_t id, std::uint64_t amount) {
+    bumpStat(localStatsBlock().count[id], amount);
+}
+
+class ScopedStatTimer {
+public:
+    explicit ScopedStatTimer(std::size_t id) : id_(id), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedStatTimer() {
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start_;
+        StatsBlock& block = localStatsBlock();
+        bumpStat(block.count[id_], 1);
+        bumpStat(block.nanoseconds[id_],
+                 static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedStatTimer(const ScopedStatTimer&) = delete;
+    ScopedStatTimer& operator=(const ScopedStatTimer&) = delete;
+
+private:
+    std::size_t id_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define EAD_STATS_CONCAT_(a, b) a##b
+#define EAD_STATS_CONCAT(a, b) EAD_STATS_CONCAT_(a, b)
+
+#define EAD_STATS_TIMER(name)                                                                        \
+    static const std::size_t EAD_STATS_CONCAT(eadStatId, __LINE__) = registerStat(name, kStatTimer); \
+    ScopedStatTimer EAD_STATS_CONCAT(eadStatTimer, __LINE__)(EAD_STATS_CONCAT(eadStatId, __LINE__))
+
+#define EAD_STATS_COUNT(name, amount)                                       \
+    do {                                                                    \
+        static const std::size_t eadStatId = registerStat(name, kStatCounter); \
+        addToStat(eadStatId, static_cast<std::uint64_t>(amount));          \
+    } while (0)
+
+// Summary of every thread's samples so far
+void writeStats(std::ostream& out, StatsFormat format);
+
+// See "Reporting" above; returns false if EAD_STATS is unset
+bool installStatsReporter();
+
+#else
+
+#define EAD_STATS_TIMER(name) ((void)0)
+#define EAD_STATS_COUNT(name, amount) ((void)0)
+
+inline void writeStats(std::ostream&, StatsFormat) {}
+inline bool installStatsReporter() { return false; }
+
+#endif // EAD_ENABLE_STATS
+
+#endif // EAD_STATS_HXX
@@ -0,0 +1,88 @@
+#include "EAD_Sweep.hxx"
+
+#include <algorithm>
+#include <tuple>
+
+#include "EAD_Stats.hxx"
+
+namespace {
+
+// Block-wise pass like evaluateSegmentTotals(): lengths through the
+// batched kernel, then the sums
+template <typename T>
+RouteAggregates computeRouteAggregatesImpl(const T* x, const T* y, const T* z, std::size_t n,
+                                           const double* legVelocity) {
+    EAD_STATS_TIMER("sweep_aggregates");
+    const std::size_t kBlock = 1024;
+    double lengths[kBlock];
+    RouteAggregates route = {0.0, 0.0, 0.0, 0.0, 0.0, n};
+    std::size_t segments = n > 1 ? n - 1 : 0;
+    for (std::size_t begin = 0; begin < segments; begin += kBlock) {
+        std::size_t count = std::min(kBlock, segments - begin);
+        segmentLengths(x + begin, y + begin, z + begin, count + 1, lengths);
+        for (std::size_t k = 0; k < count; ++k) {
+            std::size_t i = begin + k;
+            double d = lengths[k];
+            double z0 = double(z[i]), z1 = double(z[i + 1]);
+            double dz = z1 - z0;
+            route.distance += d;
+            route.altitudeDistance += d * 0.5 * (z0 + z1);
+            if (dz > 0.0) {
+                route.climb += dz;
+            } else {
+                route.descent -= dz;
+            }
+            if (legVelocity) {
+                route.velocitySquaredDistance += legVelocity[i] * legVelocity[i] * d;
+            }
+        }
+    }
+    return route;
+}
+
+} // namespace
+
+RouteAggregates computeRouteAggregates(const double* x, const double* y, const double* z, std::size_t n) {
+    return computeRouteAggregatesImpl(x, y, z, n, nullptr);
+}
+
+RouteAggregates computeRouteAggregates(const float* x, const float* y, const float* z, std::size_t n) {
+    return computeRouteAggregatesImpl(x, y, z, n, nullptr);
+}
+
+RouteAggregates computeRouteAggregates(const WaypointSoA& path) {
+    return computeRouteAggregatesImpl(path.x.data(), path.y.data(), path.z.data(), path.size(), nullptr);
+}
+
+RouteAggregates computeRouteAggregates(const WaypointSoA& path, const double* legVelocity) {
+    return computeRouteAggregatesImpl(path.x.data(), path.y.data(), path.z.data(), path.size(), legVelocity);
+}
+
+SweepResult scoreCoefficients(const RouteAggregates& route, const EnergyCoefficients& coeffs,
+                              const SweepOptions& options) {
+    SweepResult result;
+    result.coeffs = coeffs;
+    if (options.velocityMode == kSweepProfileVelocity) {
+        result.velocity = 0.0;
+        result.energyPerA = route.velocitySquaredDistance;
+    } else {
+        result.velocity = options.velocityMode == kSweepFixedVelocity
+            ? options.velocity
+            : std::get<0>(findOptimalSpeedAndAltitude(coeffs.a, coeffs.b));
+        result.energyPerA = result.velocity * result.velocity * route.distance;
+    }
+    result.energyPerB = route.altitudeDistance;
+    result.energyPerC = route.distance;
+    result.energy = coeffs.a * result.energyPerA + coeffs.b * result.energyPerB + coeffs.c * result.energyPerC +
+                    options.climbCoefficient * route.climb + options.descentCoefficient * route.descent;
+    return result;
+}
+
+void sweepCoefficients(const RouteAggregates& route, const std::vector<EnergyCoefficients>& sets,
+                       std::vector<SweepResult>& results, const SweepOptions& options) {
+    EAD_STATS_TIMER("sweep");
+    results.resize(sets.size());
+    for (std::size_t k = 0; k < sets.size(); ++k) {
+        results[k] = scoreCoefficients(route, sets[k], options);
+    }
+}
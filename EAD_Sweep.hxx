@@ -0,0 +1,78 @@
+#ifndef EAD_SWEEP_HXX
+#define EAD_SWEEP_HXX
+
+#include <cstddef>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_PathSoA.hxx"
+
+// Coefficient Sweeps over a Fixed Route
+// =========================================================
+// For a fixed route the per-segment model is linear in a, b and c:
+//
+//   E = sum_i d_i * (a * v_i^2 + b * mean(h_i) + c) + vertical
+//     = a * SV + b * SH + c * SD + climb * SU + descent * SW
+//
+//   SD = sum d_i                  SU = sum max(dz_i, 0)
+//   SH = sum d_i * mean(h_i)      SW = sum max(-dz_i, 0)
+//   SV = sum v_i^2 * d_i          (= v^2 * SD at constant velocity)
+//
+// computeRouteAggregates() makes one pass over the route; after that
+// every (a, b, c) costs O(1) instead of a pass over the waypoints.
+//
+// Velocity
+// -------------------------------------------------------------
+//   kSweepOptimalVelocity  v = findOptimalSpeedAndAltitude(a, b) per
+//                          set, as the simulator and batch mode do
+//   kSweepFixedVelocity    one v for every set (e.g. the speed a
+//                          calibration flight was flown at)
+//   kSweepProfileVelocity  per-leg speeds given to the aggregates
+//                          (e.g. from planSegments()); uses SV
+//
+// Sensitivities dE/da = SV, dE/db = SH, dE/dc = SD are reported with
+// the velocity held fixed.
+// =========================================================
+
+struct RouteAggregates {
+    double distance;                // SD
+    double altitudeDistance;        // SH
+    double climb;                   // SU
+    double descent;                 // SW
+    double velocitySquaredDistance; // SV; 0 unless leg velocities were given
+    std::size_t waypoints;
+};
+
+RouteAggregates computeRouteAggregates(const double* x, const double* y, const double* z, std::size_t n);
+RouteAggregates computeRouteAggregates(const float* x, const float* y, const float* z, std::size_t n);
+RouteAggregates computeRouteAggregates(const WaypointSoA& path);
+
+// 'legVelocity' holds path.size() - 1 speeds, one per leg
+RouteAggregates computeRouteAggregates(const WaypointSoA& path, const double* legVelocity);
+
+enum SweepVelocityMode { kSweepOptimalVelocity, kSweepFixedVelocity, kSweepProfileVelocity };
+
+struct SweepOptions {
+    SweepVelocityMode velocityMode;
+    double velocity;           // kSweepFixedVelocity only
+    double climbCoefficient;   // Per-segment model climb term
+    double descentCoefficient; // Per-segment model descent term
+
+    SweepOptions()
+        : velocityMode(kSweepOptimalVelocity), velocity(0.0), climbCoefficient(0.5), descentCoefficient(0.0) {}
+};
+
+struct SweepResult {
+    EnergyCoefficients coeffs;
+    double velocity; // 0 in kSweepProfileVelocity mode
+    double energy;
+    double energyPerA, energyPerB, energyPerC; // dE/da, dE/db, dE/dc
+};
+
+SweepResult scoreCoefficients(const RouteAggregates& route, const EnergyCoefficients& coeffs,
+                              const SweepOptions& options = SweepOptions());
+
+void sweepCoefficients(const RouteAggregates& route, const std::vector<EnergyCoefficients>& sets,
+                       std::vector<SweepResult>& results, const SweepOptions& options = SweepOptions());
+
+#endif // EAD_SWEEP_HXX
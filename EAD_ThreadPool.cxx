@@ -0,0 +1,195 @@
+#include "EAD_ThreadPool.hxx"
+
+#include <exception>
+
+// Which pool (if any) the current thread works for, so submit() and
+// parallelFor() can keep nested work on the local deque
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local unsigned currentWorker = 0;
+
+void ThreadPool::Worker::pushBack(std::function<void()>& task) {
+    if (count == ring.size()) {
+        // Full: unroll into a ring twice the size
+        std::vector<std::function<void()> > grown(2 * ring.size());
+        for (std::size_t k = 0; k < count; ++k) {
+            grown[k] = std::move(ring[(head + k) & (ring.size() - 1)]);
+        }
+        ring.swap(grown);
+        head = 0;
+    }
+    ring[(head + count) & (ring.size() - 1)] = std::move(task);
+    ++count;
+}
+
+void ThreadPool::Worker::popBack(std::function<void()>& task) {
+    --count;
+    std::function<void()>& slot = ring[(head + count) & (ring.size() - 1)];
+    task = std::move(slot);
+    slot = nullptr;
+}
+
+void ThreadPool::Worker::popFront(std::function<void()>& task) {
+    std::function<void()>& slot = ring[head];
+    task = std::move(slot);
+    slot = nullptr;
+    head = (head + 1) & (ring.size() - 1);
+    --count;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : queued_(0), nextWorker_(0), stopping_(false) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers_.push_back(new Worker());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads_.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        threads_[i].join();
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        delete workers_[i];
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned target = currentPool == this
+        ? currentWorker
+        : nextWorker_.fetch_add(1, std::memory_order_relaxed) % threadCount();
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->pushBack(task);
+    }
+    queued_.fetch_add(1);
+    {
+        // Taking the sleep lock orders this wake-up after the worker's
+        // predicate check, so the notification cannot be lost
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wake_.notify_one();
+}
+
+// Own deque from the back (LIFO), everyone else's from the front (FIFO)
+bool ThreadPool::popTask(unsigned preferred, std::function<void()>& task) {
+    unsigned count = threadCount();
+    {
+        Worker& own = *workers_[preferred];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.count > 0) {
+            own.popBack(task);
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    for (unsigned k = 1; k < count; ++k) {
+        Worker& victim = *workers_[(preferred + k) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.count > 0) {
+            victim.popFront(task);
+            queued_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runOneTask() {
+    std::function<void()> task;
+    if (!popTask(currentPool == this ? currentWorker : 0, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    currentPool = this;
+    currentWorker = index;
+    std::function<void()> task;
+    for (;;) {
+        if (popTask(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+                             const std::function<void(std::size_t, std::size_t)>& body) {
+    if (end <= begin) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    size_t chunks = (end - begin + grain - 1) / grain;
+    if (chunks == 1) {
+        body(begin, end);
+        return;
+    }
+
+    // Completion state lives on this stack frame; every chunk decrements
+    // 'remaining' under the mutex, and the caller re-acquires the mutex
+    // before returning, so no chunk can touch it after we leave.
+    struct State {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::atomic<size_t> remaining;
+        std::exception_ptr error;
+    } state;
+    state.remaining = chunks;
+
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        size_t chunkBegin = begin + chunk * grain;
+        size_t chunkEnd = chunkBegin + grain < end ? chunkBegin + grain : end;
+        submit([&state, &body, chunkBegin, chunkEnd] {
+            try {
+                body(chunkBegin, chunkEnd);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.error) {
+                    state.error = std::current_exception();
+                }
+            }
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (--state.remaining == 0) {
+                state.done.notify_all();
+            }
+        });
+    }
+
+    // Help with the queued chunks (or any other pending work) while waiting
+    while (state.remaining.load() > 0 && runOneTask()) {
+    }
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.done.wait(lock, [&state] { return state.remaining.load() == 0; });
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
+
+ThreadPool& defaultThreadPool() {
+    static ThreadPool pool(0);
+    return pool;
+}
@@ -0,0 +1,81 @@
+#ifndef EAD_THREAD_POOL_HXX
+#define EAD_THREAD_POOL_HXX
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-Stealing Thread Pool
+// =========================================================
+// Every worker owns a deque of tasks:
+//
+//   worker 0: [t0 t1 t2 t3]  <- pops its own work from the back
+//   worker 1: [t4]           <- steals from the front of others
+//   worker 2: []             <- when its own deque is empty
+//
+// Tasks submitted from a worker go onto that worker's deque (cache
+// locality for nested work); tasks submitted from outside are spread
+// round-robin. parallelFor() lets the calling thread execute tasks
+// too, so nested parallelFor() calls cannot deadlock.
+//
+// Each deque is a ring buffer that doubles when full and never
+// shrinks, so once it has held its largest backlog, queueing a task
+// does not touch the heap (std::function stores small trivially
+// copyable callables, such as a lambda capturing two pointers, in
+// place).
+// =========================================================
+class ThreadPool {
+public:
+    // threadCount == 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers_.size()); }
+
+    // Queue a task; tasks passed to submit() must not throw
+    void submit(std::function<void()> task);
+
+    // Run body(chunkBegin, chunkEnd) over [begin, end) split into chunks
+    // of 'grain' items and block until all chunks are done. The first
+    // exception thrown by a chunk is rethrown to the caller.
+    void parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+                     const std::function<void(std::size_t, std::size_t)>& body);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::vector<std::function<void()> > ring; // Capacity is a power of two
+        std::size_t head;                         // Front task
+        std::size_t count;
+
+        Worker() : ring(64), head(0), count(0) {}
+
+        void pushBack(std::function<void()>& task);
+        void popBack(std::function<void()>& task);
+        void popFront(std::function<void()>& task);
+    };
+
+    void workerLoop(unsigned index);
+    bool popTask(unsigned preferred, std::function<void()>& task);
+    bool runOneTask();
+
+    std::vector<Worker*> workers_;
+    std::vector<std::thread> threads_;
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<std::size_t> queued_;
+    std::atomic<unsigned> nextWorker_;
+    bool stopping_;
+};
+
+// Process-wide pool shared by the parallel evaluators
+ThreadPool& defaultThreadPool();
+
+#endif // EAD_THREAD_POOL_HXX
@@ -0,0 +1,158 @@
+#include "EAD_WaypointFile.hxx"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "EAD_ParallelReduce.hxx"
+#include "EAD_PathSoA.hxx"
+#include "EAD_Stats.hxx"
+
+namespace {
+
+bool hostIsLittleEndian() {
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// Write one coordinate plane in the requested encoding
+bool writePlane(std::FILE* file, const std::vector<Waypoint>& waypoints, double Waypoint::*member,
+                WaypointEncoding encoding) {
+    const size_t kBlock = 4096;
+    double doubles[kBlock];
+    float floats[kBlock];
+    for (size_t begin = 0; begin < waypoints.size(); begin += kBlock) {
+        size_t count = waypoints.size() - begin < kBlock ? waypoints.size() - begin : kBlock;
+        size_t written;
+        if (encoding == kWaypointFloat32) {
+            for (size_t k = 0; k < count; ++k) {
+                floats[k] = static_cast<float>(waypoints[begin + k].*member);
+            }
+            written = std::fwrite(floats, sizeof(float), count, file);
+        } else {
+            for (size_t k = 0; k < count; ++k) {
+                doubles[k] = waypoints[begin + k].*member;
+            }
+            written = std::fwrite(doubles, sizeof(double), count, file);
+        }
+        if (written != count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool writeWaypointFile(const std::string& path, const std::vector<Waypoint>& waypoints,
+                       WaypointEncoding encoding, std::string& error) {
+    EAD_STATS_TIMER("io_write");
+    if (!hostIsLittleEndian()) {
+        error = "the .eadw format is little-endian only";
+        return false;
+    }
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    WaypointFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "EADW", 4);
+    header.version = kWaypointFileVersion;
+    header.encoding = static_cast<std::uint16_t>(encoding);
+    header.headerSize = sizeof(WaypointFileHeader);
+    header.count = waypoints.size();
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              writePlane(file, waypoints, &Waypoint::x, encoding) &&
+              writePlane(file, waypoints, &Waypoint::y, encoding) &&
+              writePlane(file, waypoints, &Waypoint::z, encoding);
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        error = "write to " + path + " failed";
+    }
+    return ok;
+}
+
+bool MappedRoute::open(const std::string& path, std::string& error) {
+    count_ = 0;
+    planes_ = nullptr;
+    if (!hostIsLittleEndian()) {
+        error = "the .eadw format is little-endian only";
+        return false;
+    }
+    if (!file_.open(path, error)) {
+        return false;
+    }
+
+    WaypointFileHeader header;
+    if (file_.size() < sizeof(header)) {
+        error = path + " is too small for a waypoint file header";
+        return false;
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, "EADW", 4) != 0) {
+        error = path + " is not a waypoint file (bad magic)";
+        return false;
+    }
+    if (header.version != kWaypointFileVersion) {
+        error = path + " has unsupported version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.encoding != kWaypointFloat64 && header.encoding != kWaypointFloat32) {
+        error = path + " has unknown encoding " + std::to_string(header.encoding);
+        return false;
+    }
+
+    size_t elementSize = header.encoding == kWaypointFloat32 ? sizeof(float) : sizeof(double);
+    if (header.headerSize < sizeof(header) || header.headerSize % elementSize != 0) {
+        error = path + " has an invalid header size";
+        return false;
+    }
+    if (header.headerSize > file_.size()) {
+        error = path + " is truncated inside its header";
+        return false;
+    }
+    std::uint64_t available = (file_.size() - header.headerSize) / elementSize / 3;
+    if (header.count > available) {
+        error = path + " is truncated: header says " + std::to_string(header.count) + " waypoints";
+        return false;
+    }
+
+    encoding_ = static_cast<WaypointEncoding>(header.encoding);
+    count_ = static_cast<size_t>(header.count);
+    planes_ = file_.data() + header.headerSize;
+    return true;
+}
+
+Waypoint MappedRoute::operator[](std::size_t i) const {
+    Waypoint wp;
+    if (encoding_ == kWaypointFloat32) {
+        wp.x = xf()[i];
+        wp.y = yf()[i];
+        wp.z = zf()[i];
+    } else {
+        wp.x = x()[i];
+        wp.y = y()[i];
+        wp.z = z()[i];
+    }
+    return wp;
+}
+
+double MappedRoute::totalPathLength() const {
+    if (encoding_ == kWaypointFloat32) {
+        return totalPathLengthParallel(xf(), yf(), zf(), count_);
+    }
+    return totalPathLengthParallel(x(), y(), z(), count_);
+}
+
+SegmentEnergyTotals MappedRoute::evaluate(const SegmentEnergyParams& params) const {
+    if (encoding_ == kWaypointFloat32) {
+        return evaluateSegmentTotalsParallel(xf(), yf(), zf(), count_, params);
+    }
+    return evaluateSegmentTotalsParallel(x(), y(), z(), count_, params);
+}
@@ -0,0 +1,87 @@
+#ifndef EAD_WAYPOINT_FILE_HXX
+#define EAD_WAYPOINT_FILE_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_MappedFile.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+// Binary Waypoint Route Format (.eadw)
+// =========================================================
+// Little-endian, planar (structure-of-arrays) so a mapped file can be
+// handed to the SoA kernels as-is:
+//
+//   offset 0          +---------------------------+
+//                     | header (32 bytes)         |
+//   headerSize        +---------------------------+
+//                     | x[0] x[1] ... x[count-1]  |
+//                     +---------------------------+
+//                     | y[0] y[1] ... y[count-1]  |
+//                     +---------------------------+
+//                     | z[0] z[1] ... z[count-1]  |
+//                     +---------------------------+
+//
+// Coordinates are float64, or float32 to halve the file size (about
+// 7 significant digits, i.e. ~0.1 m resolution at 1000 km).
+// =========================================================
+
+enum WaypointEncoding {
+    kWaypointFloat64 = 0,
+    kWaypointFloat32 = 1
+};
+
+static const std::uint16_t kWaypointFileVersion = 1;
+
+struct WaypointFileHeader {
+    char magic[4];           // "EADW"
+    std::uint16_t version;   // kWaypointFileVersion
+    std::uint16_t encoding;  // WaypointEncoding
+    std::uint32_t headerSize; // Bytes before x[0]; readers must honour it
+    std::uint32_t reserved;
+    std::uint64_t count;     // Number of waypoints
+    std::uint64_t reserved2;
+};
+
+static_assert(sizeof(WaypointFileHeader) == 32, "WaypointFileHeader must stay 32 bytes");
+
+// Write a route in the binary format; returns false and sets 'error' on failure
+bool writeWaypointFile(const std::string& path, const std::vector<Waypoint>& waypoints,
+                       WaypointEncoding encoding, std::string& error);
+
+// A route file mapped read-only; the coordinate pointers alias the mapping
+class MappedRoute {
+public:
+    MappedRoute() : encoding_(kWaypointFloat64), count_(0), planes_(nullptr) {}
+
+    bool open(const std::string& path, std::string& error);
+
+    std::size_t size() const { return count_; }
+    WaypointEncoding encoding() const { return encoding_; }
+
+    // Coordinate planes; only the accessors matching encoding() are valid
+    const double* x() const { return static_cast<const double*>(planes_); }
+    const double* y() const { return x() + count_; }
+    const double* z() const { return y() + count_; }
+    const float* xf() const { return static_cast<const float*>(planes_); }
+    const float* yf() const { return xf() + count_; }
+    const float* zf() const { return yf() + count_; }
+
+    Waypoint operator[](std::size_t i) const;
+
+    // Distance and energy passes run directly on the mapped planes,
+    // chunked over the thread pool for long routes
+    double totalPathLength() const;
+    SegmentEnergyTotals evaluate(const SegmentEnergyParams& params) const;
+
+private:
+    MappedFile file_;
+    WaypointEncoding encoding_;
+    std::size_t count_;
+    const void* planes_;
+};
+
+#endif // EAD_WAYPOINT_FILE_HXX
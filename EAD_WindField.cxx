@@ -0,0 +1,329 @@
+#include "EAD_WindField.hxx"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "EAD_Stats.hxx"
+
+namespace {
+
+const std::size_t kNoCell = static_cast<std::size_t>(-1);
+
+bool hostIsLittleEndian() {
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+bool validGrid(const WindFieldGrid& grid) {
+    return grid.nx > 0 && grid.ny > 0 && grid.nz > 0 && grid.dx > 0.0 && grid.dy > 0.0 && grid.dz > 0.0;
+}
+
+template <typename T>
+WindRouteTotals evaluateRouteInWindImpl(const T* x, const T* y, const T* z, std::size_t n,
+                                        const WindField& field, const WindLegParams& params) {
+    EAD_STATS_TIMER("wind_route");
+    EAD_STATS_COUNT("wind_samples", (n > 1 ? n - 1 : 0) * params.samplesPerLeg);
+    WindRouteTotals totals = {0.0, 0.0, 0.0, std::numeric_limits<double>::infinity(), 0};
+    WindSampler sampler(field);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        Waypoint from = {double(x[i]), double(y[i]), double(z[i])};
+        Waypoint to = {double(x[i + 1]), double(y[i + 1]), double(z[i + 1])};
+        double air = 0.0;
+        double energy = windLegEnergy(sampler, from, to, params, &air, &totals.minimumClearance);
+        totals.distance += distance(from, to);
+        if (std::isinf(energy)) {
+            ++totals.infeasibleLegs;
+        }
+        totals.airDistance += air;
+        totals.energy += energy;
+    }
+    return totals;
+}
+
+} // namespace
+
+bool writeWindFieldFile(const std::string& path, const WindFieldGrid& grid, const std::vector<float>& terrain,
+                        const std::vector<float>& wind, std::string& error) {
+    EAD_STATS_TIMER("io_write");
+    if (!hostIsLittleEndian()) {
+        error = "the .eadf format is little-endian only";
+        return false;
+    }
+    if (!validGrid(grid)) {
+        error = "wind field grid needs at least one node and positive spacing on every axis";
+        return false;
+    }
+    std::size_t columns = grid.nx * grid.ny;
+    if (terrain.size() != columns || wind.size() != columns * grid.nz * 3) {
+        error = "wind field arrays do not match the grid size";
+        return false;
+    }
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    WindFieldHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "EADF", 4);
+    header.version = kWindFieldVersion;
+    header.headerSize = sizeof(WindFieldHeader);
+    header.nx = static_cast<std::uint32_t>(grid.nx);
+    header.ny = static_cast<std::uint32_t>(grid.ny);
+    header.nz = static_cast<std::uint32_t>(grid.nz);
+    header.originX = grid.originX;
+    header.originY = grid.originY;
+    header.originZ = grid.originZ;
+    header.dx = grid.dx;
+    header.dy = grid.dy;
+    header.dz = grid.dz;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(terrain.data(), sizeof(float), terrain.size(), file) == terrain.size() &&
+              std::fwrite(wind.data(), sizeof(float), wind.size(), file) == wind.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        error = "write to " + path + " failed";
+    }
+    return ok;
+}
+
+WindField::WindField() : terrain_(nullptr), wind_(nullptr) {
+    std::memset(&grid_, 0, sizeof(grid_));
+}
+
+bool WindField::open(const std::string& path, std::string& error) {
+    terrain_ = nullptr;
+    wind_ = nullptr;
+    if (!hostIsLittleEndian()) {
+        error = "the .eadf format is little-endian only";
+        return false;
+    }
+    // Lookups along a route jump around the file, so no read-ahead hint
+    if (!file_.open(path, error, false)) {
+        return false;
+    }
+
+    WindFieldHeader header;
+    if (file_.size() < sizeof(header)) {
+        error = path + " is too small for a wind field header";
+        return false;
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, "EADF", 4) != 0) {
+        error = path + " is not a wind field file (bad magic)";
+        return false;
+    }
+    if (header.version != kWindFieldVersion) {
+        error = path + " has unsupported version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.headerSize < sizeof(header) || header.headerSize % sizeof(float) != 0) {
+        error = path + " has an invalid header size";
+        return false;
+    }
+    if (header.headerSize > file_.size()) {
+        error = path + " is truncated inside its header";
+        return false;
+    }
+
+    WindFieldGrid grid = {header.nx, header.ny, header.nz, header.originX, header.originY, header.originZ,
+                          header.dx, header.dy, header.dz};
+    if (!validGrid(grid)) {
+        error = path + " has an empty grid or non-positive spacing";
+        return false;
+    }
+    std::uint64_t columns = std::uint64_t(header.nx) * header.ny;
+    std::uint64_t floats = columns + columns * header.nz * 3;
+    if (floats > (file_.size() - header.headerSize) / sizeof(float)) {
+        error = path + " is truncated: header says " + std::to_string(header.nx) + " x " +
+                std::to_string(header.ny) + " x " + std::to_string(header.nz) + " nodes";
+        return false;
+    }
+
+    grid_ = grid;
+    terrain_ = reinterpret_cast<const float*>(file_.data() + header.headerSize);
+    wind_ = terrain_ + columns;
+    return true;
+}
+
+WindSampler::WindSampler(const WindField& field)
+    : field_(field),
+      inverseDx_(1.0 / field.grid().dx),
+      inverseDy_(1.0 / field.grid().dy),
+      inverseDz_(1.0 / field.grid().dz),
+      windCorners_(),
+      terrainCorners_(),
+      windLoads_(0),
+      terrainLoads_(0) {
+    windCell_[0] = windCell_[1] = windCell_[2] = kNoCell;
+    terrainCell_[0] = terrainCell_[1] = kNoCell;
+}
+
+// Clamped to the grid, so the edge nodes extend outwards; a single-node
+// axis always reports cell 0 at fraction 0
+void WindSampler::locate(double coordinate, double origin, double inverseSpacing, std::size_t n,
+                         std::size_t& cell, double& fraction) const {
+    double t = (coordinate - origin) * inverseSpacing;
+    double last = double(n - 1);
+    t = t > 0.0 ? (t < last ? t : last) : 0.0;
+    cell = static_cast<std::size_t>(t);
+    if (cell + 1 >= n) {
+        cell = n > 1 ? n - 2 : 0;
+    }
+    fraction = n > 1 ? t - double(cell) : 0.0;
+}
+
+WindVector WindSampler::wind(double x, double y, double z) {
+    const WindFieldGrid& grid = field_.grid();
+    std::size_t ix, iy, iz;
+    double fx, fy, fz;
+    locate(x, grid.originX, inverseDx_, grid.nx, ix, fx);
+    locate(y, grid.originY, inverseDy_, grid.ny, iy, fy);
+    locate(z, grid.originZ, inverseDz_, grid.nz, iz, fz);
+
+    if (ix != windCell_[0] || iy != windCell_[1] || iz != windCell_[2]) {
+        // Corner k has offsets (k & 1, (k >> 1) & 1, k >> 2)
+        std::size_t x1 = ix + 1 < grid.nx ? ix + 1 : ix;
+        std::size_t y1 = iy + 1 < grid.ny ? iy + 1 : iy;
+        std::size_t z1 = iz + 1 < grid.nz ? iz + 1 : iz;
+        const float* wind = field_.wind();
+        for (int k = 0; k < 8; ++k) {
+            std::size_t cx = k & 1 ? x1 : ix;
+            std::size_t cy = k & 2 ? y1 : iy;
+            std::size_t cz = k & 4 ? z1 : iz;
+            const float* node = wind + 3 * ((cz * grid.ny + cy) * grid.nx + cx);
+            windCorners_[k][0] = node[0];
+            windCorners_[k][1] = node[1];
+            windCorners_[k][2] = node[2];
+        }
+        windCell_[0] = ix;
+        windCell_[1] = iy;
+        windCell_[2] = iz;
+        ++windLoads_;
+    }
+
+    double weights[8];
+    double gx = 1.0 - fx, gy = 1.0 - fy, gz = 1.0 - fz;
+    weights[0] = gx * gy * gz;
+    weights[1] = fx * gy * gz;
+    weights[2] = gx * fy * gz;
+    weights[3] = fx * fy * gz;
+    weights[4] = gx * gy * fz;
+    weights[5] = fx * gy * fz;
+    weights[6] = gx * fy * fz;
+    weights[7] = fx * fy * fz;
+    WindVector result = {0.0, 0.0, 0.0};
+    for (int k = 0; k < 8; ++k) {
+        result.u += weights[k] * windCorners_[k][0];
+        result.v += weights[k] * windCorners_[k][1];
+        result.w += weights[k] * windCorners_[k][2];
+    }
+    return result;
+}
+
+double WindSampler::terrainHeight(double x, double y) {
+    const WindFieldGrid& grid = field_.grid();
+    std::size_t ix, iy;
+    double fx, fy;
+    locate(x, grid.originX, inverseDx_, grid.nx, ix, fx);
+    locate(y, grid.originY, inverseDy_, grid.ny, iy, fy);
+
+    if (ix != terrainCell_[0] || iy != terrainCell_[1]) {
+        std::size_t x1 = ix + 1 < grid.nx ? ix + 1 : ix;
+        std::size_t y1 = iy + 1 < grid.ny ? iy + 1 : iy;
+        const float* terrain = field_.terrain();
+        terrainCorners_[0] = terrain[iy * grid.nx + ix];
+        terrainCorners_[1] = terrain[iy * grid.nx + x1];
+        terrainCorners_[2] = terrain[y1 * grid.nx + ix];
+        terrainCorners_[3] = terrain[y1 * grid.nx + x1];
+        terrainCell_[0] = ix;
+        terrainCell_[1] = iy;
+        ++terrainLoads_;
+    }
+
+    double bottom = terrainCorners_[0] + fx * (terrainCorners_[1] - terrainCorners_[0]);
+    double top = terrainCorners_[2] + fx * (terrainCorners_[3] - terrainCorners_[2]);
+    return bottom + fy * (top - bottom);
+}
+
+// Midpoint rule over samplesPerLeg equal pieces; exact for the linear
+// altitude term when the air is still and the ground flat
+double windLegEnergy(WindSampler& sampler, const Waypoint& from, const Waypoint& to,
+                     const WindLegParams& params, double* airDistance, double* minimumClearance) {
+    const SegmentEnergyParams& energy = params.energy;
+    double length = distance(from, to);
+    // Vertical term only depends on the end altitudes
+    double vertical = legEnergy(0.0, from.z, to.z, 0.0, energy);
+    if (length == 0.0) {
+        return vertical;
+    }
+
+    std::size_t samples = params.samplesPerLeg > 0 ? params.samplesPerLeg : 1;
+    double v = energy.velocity;
+    double cruise = cruiseEnergyPerMeter(v, energy);
+    double piece = length / double(samples);
+    double inverseLength = 1.0 / length;
+    double tx = (to.x - from.x) * inverseLength;
+    double ty = (to.y - from.y) * inverseLength;
+    double tz = (to.z - from.z) * inverseLength;
+
+    bool feasible = v > 0.0;
+    double air = 0.0;
+    double sum = 0.0;
+    double lowest = minimumClearance ? *minimumClearance : 0.0;
+    for (std::size_t k = 0; k < samples; ++k) {
+        double s = (double(k) + 0.5) / double(samples);
+        double px = from.x + s * (to.x - from.x);
+        double py = from.y + s * (to.y - from.y);
+        double pz = from.z + s * (to.z - from.z);
+
+        WindVector w = sampler.wind(px, py, pz);
+        double along = tx * w.u + ty * w.v + tz * w.w;
+        double discriminant = v * v - (w.u * w.u + w.v * w.v + w.w * w.w) + along * along;
+        double groundSpeed = discriminant >= 0.0 ? along + std::sqrt(discriminant) : 0.0;
+        if (groundSpeed <= 0.0) {
+            feasible = false;
+        }
+        double clearance = pz - sampler.terrainHeight(px, py);
+        lowest = clearance < lowest ? clearance : lowest;
+
+        double airPiece = feasible ? piece * v / groundSpeed : 0.0;
+        air += airPiece;
+        sum += airPiece * (cruise + energy.coeffs.b * clearance);
+    }
+
+    if (minimumClearance) {
+        *minimumClearance = lowest;
+    }
+    if (!feasible) {
+        if (airDistance) {
+            *airDistance = 0.0;
+        }
+        return std::numeric_limits<double>::infinity();
+    }
+    if (airDistance) {
+        *airDistance = air;
+    }
+    return sum + vertical;
+}
+
+WindRouteTotals evaluateRouteInWind(const double* x, const double* y, const double* z, std::size_t n,
+                                    const WindField& field, const WindLegParams& params) {
+    return evaluateRouteInWindImpl(x, y, z, n, field, params);
+}
+
+WindRouteTotals evaluateRouteInWind(const float* x, const float* y, const float* z, std::size_t n,
+                                    const WindField& field, const WindLegParams& params) {
+    return evaluateRouteInWindImpl(x, y, z, n, field, params);
+}
+
+WindRouteTotals evaluateRouteInWind(const WaypointSoA& path, const WindField& field, const WindLegParams& params) {
+    return evaluateRouteInWindImpl(path.x.data(), path.y.data(), path.z.data(), path.size(), field, params);
+}
@@ -0,0 +1,158 @@
+#ifndef EAD_WIND_FIELD_HXX
+#define EAD_WIND_FIELD_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "EAD_Core.hxx"
+#include "EAD_MappedFile.hxx"
+#include "EAD_PathSoA.hxx"
+#include "EAD_SegmentEnergy.hxx"
+
+// Gridded Wind and Terrain Field (.eadf)
+// =========================================================
+// Little-endian file, memory-mapped read-only:
+//
+//   offset 0          +----------------------------------------+
+//                     | header (80 bytes)                      |
+//   headerSize        +----------------------------------------+
+//                     | terrain[ny][nx]      float32, meters   |
+//                     +----------------------------------------+
+//                     | wind[nz][ny][nx][3]  float32 u, v, w   |
+//                     +----------------------------------------+
+//
+// Node (ix, iy, iz) sits at origin + (ix * dx, iy * dy, iz * dz);
+// terrain is the ground elevation under each (ix, iy) column and the
+// wind levels are absolute altitudes like Waypoint::z. Outside the
+// grid the edge values are held (no extrapolation).
+//
+// Wind-aware leg energy
+// -------------------------------------------------------------
+// The drone holds airspeed v and crabs into the wind so its ground
+// track stays on the leg. With unit track t and wind w, the ground
+// speed s solves |s t - w| = v:
+//
+//   s = t.w + sqrt(v^2 - |w|^2 + (t.w)^2)
+//
+// Energy per meter flown through the air is E(v, h_agl) (same model as
+// energyConsumption(), altitude above the terrain), and each ground
+// meter takes v / s meters of air:
+//
+//   leg energy = sum over samples  (L / N) * (v / s) * E(v, z - terrain)
+//              + climb / descent term of legEnergy()
+//
+// In still air over flat ground at z = 0 this equals legEnergy() up
+// to rounding (the midpoint rule is exact for the linear profile).
+// If crosswind or headwind exceed v somewhere, the leg cannot be flown
+// at that airspeed: its energy is +infinity and it is counted in
+// infeasibleLegs.
+// =========================================================
+
+static const std::uint16_t kWindFieldVersion = 1;
+
+struct WindFieldHeader {
+    char magic[4];            // "EADF"
+    std::uint16_t version;    // kWindFieldVersion
+    std::uint16_t reserved;
+    std::uint32_t headerSize; // Bytes before terrain[0]; readers must honour it
+    std::uint32_t nx, ny, nz;
+    double originX, originY, originZ;
+    double dx, dy, dz;
+    std::uint64_t reserved2;
+};
+
+static_assert(sizeof(WindFieldHeader) == 80, "WindFieldHeader must stay 80 bytes");
+
+struct WindVector {
+    double u, v, w; // m/s along x, y, z
+};
+
+// Grid description for writeWindFieldFile(); arrays use the file order
+struct WindFieldGrid {
+    std::size_t nx, ny, nz;
+    double originX, originY, originZ;
+    double dx, dy, dz;
+};
+
+bool writeWindFieldFile(const std::string& path, const WindFieldGrid& grid, const std::vector<float>& terrain,
+                        const std::vector<float>& wind, std::string& error);
+
+// A field file mapped read-only; the arrays alias the mapping
+class WindField {
+public:
+    WindField();
+
+    bool open(const std::string& path, std::string& error);
+
+    const WindFieldGrid& grid() const { return grid_; }
+    const float* terrain() const { return terrain_; }
+    const float* wind() const { return wind_; }
+
+private:
+    MappedFile file_;
+    WindFieldGrid grid_;
+    const float* terrain_;
+    const float* wind_;
+};
+
+// Trilinear wind / bilinear terrain lookups with the enclosing cell's
+// corner values cached: consecutive samples along a leg usually fall
+// in the same cell, and then cost a few multiply-adds and no indexing.
+// One sampler per thread.
+class WindSampler {
+public:
+    explicit WindSampler(const WindField& field);
+
+    WindVector wind(double x, double y, double z);
+    double terrainHeight(double x, double y);
+
+    // Number of times the corner cache had to be reloaded
+    std::size_t windCellLoads() const { return windLoads_; }
+    std::size_t terrainCellLoads() const { return terrainLoads_; }
+
+private:
+    // Cell index and fractional position along one axis
+    void locate(double coordinate, double origin, double inverseSpacing, std::size_t n,
+                std::size_t& cell, double& fraction) const;
+
+    const WindField& field_;
+    double inverseDx_, inverseDy_, inverseDz_;
+
+    std::size_t windCell_[3];
+    float windCorners_[8][3];
+    std::size_t terrainCell_[2];
+    float terrainCorners_[4];
+    std::size_t windLoads_, terrainLoads_;
+};
+
+struct WindLegParams {
+    SegmentEnergyParams energy;  // velocity = airspeed
+    std::size_t samplesPerLeg;
+
+    WindLegParams() : samplesPerLeg(100) { energy = SegmentEnergyParams(); }
+};
+
+struct WindRouteTotals {
+    double distance;            // Ground track length
+    double airDistance;         // Distance flown relative to the air
+    double energy;
+    double minimumClearance;    // Lowest sampled height above terrain
+    std::size_t infeasibleLegs; // Legs where the wind beats the airspeed
+};
+
+// One leg; energy is +infinity if it is infeasible at this airspeed
+double windLegEnergy(WindSampler& sampler, const Waypoint& from, const Waypoint& to,
+                     const WindLegParams& params, double* airDistance = nullptr,
+                     double* minimumClearance = nullptr);
+
+// Whole route on the calling thread with one sampler, so the corner
+// cache carries over from each leg into the next
+WindRouteTotals evaluateRouteInWind(const double* x, const double* y, const double* z, std::size_t n,
+                                    const WindField& field, const WindLegParams& params);
+WindRouteTotals evaluateRouteInWind(const float* x, const float* y, const float* z, std::size_t n,
+                                    const WindField& field, const WindLegParams& params);
+WindRouteTotals evaluateRouteInWind(const WaypointSoA& path, const WindField& field, const WindLegParams& params);
+
+#endif // EAD_WIND_FIELD_HXX